@@ -0,0 +1,40 @@
+#ifndef ASSET_REGISTRY_HPP
+#define ASSET_REGISTRY_HPP
+
+#include <string>
+#include <cstdint>
+#include "core/name_interner.hpp"
+
+using AssetId = int32_t;
+constexpr AssetId INVALID_ASSET = -1;
+
+/**
+ * AssetRegistry
+ * Interns asset names ("BTC", "USDT", ...) into small dense ids so hot paths
+ * can index fixed arrays instead of hashing strings.
+ * Lookups are lock-free; ids are never reused or removed.
+ */
+class AssetRegistry {
+public:
+    static constexpr int MAX_ASSETS = 1024;
+
+    static AssetRegistry& instance();
+
+    // id for name, creating it if needed (INVALID_ASSET if the table is full)
+    AssetId intern(const std::string& name);
+
+    // id for name or INVALID_ASSET, never allocates
+    AssetId find(const std::string& name) const { return names_.find(name); }
+
+    const std::string& name(AssetId id) const { return names_.name(id); }
+
+    // number of ids handed out so far (valid ids are [0, size()))
+    int size() const { return names_.size(); }
+
+private:
+    AssetRegistry() = default;
+
+    NameInterner<MAX_ASSETS> names_;
+};
+
+#endif // ASSET_REGISTRY_HPP
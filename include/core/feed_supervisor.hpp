@@ -0,0 +1,109 @@
+#ifndef FEED_SUPERVISOR_HPP
+#define FEED_SUPERVISOR_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+#include "core/timer_service.hpp"
+
+struct FeedOptions {
+    bool hotStandby{true};                 // second connection per chunk, same streams
+    int64_t pingIntervalNs{5000000000LL};
+    int64_t pongTimeoutNs{15000000000LL};  // no pong for this long => drop
+    int64_t gapNs{5000000000LL};           // no message for this long => drop (0 => off)
+    int64_t backoffBaseNs{250000000LL};    // first reconnect delay (before jitter)
+    int64_t backoffMaxNs{30000000000LL};
+    int64_t stableUpNs{10000000000LL};     // up at least this long => backoff starts over
+};
+
+struct FeedStats {
+    int chunks{0};
+    int links{0};
+    int linksUp{0};
+    uint64_t messages{0};
+    uint64_t reconnects{0};
+    uint64_t gapDrops{0};    // dropped for silence
+    uint64_t pongDrops{0};   // dropped for a missing pong
+};
+
+/**
+ * FeedSupervisor
+ * Owns the combined-stream connections. Each chunk (one URL, up to 50
+ * streams) gets a primary link and, with hotStandby, a duplicate one; both
+ * deliver every message to the sink, which keeps the newest book per symbol
+ * (see BookSlot::write's updateId), so a link that drops leaves no gap.
+ *
+ * Each link is one thread looping connect => run => backoff with a single
+ * client (reset between attempts): no recursion, jittered exponential
+ * backoff that resets once a connection stayed up for stableUpNs. A periodic
+ * check on TimerService pings every open link and closes the ones that went
+ * silent or stopped answering pings; their threads reconnect.
+ */
+class FeedSupervisor {
+public:
+    // payload + its receive time (steady ns); called on the link's thread
+    using MessageSink = std::function<void(const std::string& payload, int64_t recvNs)>;
+
+    explicit FeedSupervisor(MessageSink sink);
+    ~FeedSupervisor();
+
+    // applies to chunks added afterwards (timeouts: to all)
+    void setOptions(const FeedOptions& opts);
+
+    // start the link(s) for one combined-stream URL
+    void addChunk(const std::string& url);
+
+    // drop every connection and join the link threads
+    void stop();
+
+    FeedStats stats() const;
+
+private:
+    struct Link {
+        int chunk{0};
+        int index{0};                       // 0 = primary, 1 = standby
+        std::string url;
+        std::thread thread;
+        std::atomic<bool> up{false};
+        std::atomic<int64_t> lastMsgNs{0};
+        std::atomic<int64_t> lastPongNs{0};
+        int64_t lastPingNs{0};              // supervise() only
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> reconnects{0};
+
+        std::mutex socketMutex;             // the two below, set while connected
+        std::function<void()> closeSocket;
+        std::function<void()> sendPing;
+    };
+
+    void runLink(Link* link);
+    void supervise();
+    // sleep up to ns; false => stopping
+    bool waitFor(int64_t ns);
+    int64_t jitteredBackoff(int64_t backoffNs);
+
+    MessageSink sink_;
+
+    mutable std::mutex linksMutex_;
+    std::vector<std::unique_ptr<Link>> links_; // never shrinks: link threads hold pointers
+    int chunks_{0};
+
+    std::mutex optsMutex_;
+    FeedOptions opts_;
+
+    std::atomic<uint64_t> gapDrops_{0};
+    std::atomic<uint64_t> pongDrops_{0};
+
+    std::atomic<bool> running_{true};
+    std::mutex waitMutex_;
+    std::condition_variable waitCv_;
+    TimerService::TimerId superviseTimer_{0};
+};
+
+#endif // FEED_SUPERVISOR_HPP
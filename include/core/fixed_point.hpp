@@ -0,0 +1,143 @@
+#ifndef FIXED_POINT_HPP
+#define FIXED_POINT_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+/**
+ * Fixed-point helpers for prices/quantities.
+ *
+ * A value is an int64 count of 10^-decimals units, where `decimals` is the
+ * per-symbol scale from exchangeInfo (tickSize / stepSize). Binance never
+ * uses more than 8 decimals, so int64 covers ~9.2e10 at the finest scale.
+ *
+ * Everything here is allocation-free except toString().
+ */
+namespace FixedPoint {
+
+constexpr int MAX_DECIMALS = 8;
+
+constexpr int64_t POW10[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+    100000000LL, 1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL
+};
+
+/**
+ * Parse "12345.678" into units of 10^-decimals (extra digits are truncated).
+ * Accepts an optional leading '-'. Returns false on anything else.
+ * A value too large for int64 at this scale (e.g. a "no limit" maxQty at
+ * 8 decimals) saturates to +/-INT64_MAX.
+ */
+inline bool parse(const char* s, size_t len, int decimals, int64_t& out) {
+    size_t i = 0;
+    bool neg = false;
+    if (i < len && s[i] == '-') { neg = true; i++; }
+
+    int64_t intPart = 0;
+    bool any = false, over = false;
+    for (; i < len && s[i] != '.'; i++) {
+        unsigned d = (unsigned)(s[i] - '0');
+        if (d > 9) return false;
+        if (intPart > (INT64_MAX - (int64_t)d) / 10) over = true;
+        else intPart = intPart * 10 + d;
+        any = true;
+    }
+
+    int64_t frac = 0;
+    int fracDigits = 0;
+    if (i < len && s[i] == '.') {
+        for (i++; i < len; i++) {
+            unsigned d = (unsigned)(s[i] - '0');
+            if (d > 9) return false;
+            any = true;
+            if (fracDigits < decimals) {
+                frac = frac * 10 + d;
+                fracDigits++;
+            }
+        }
+    }
+    if (!any) return false;
+
+    int64_t fracUnits = frac * POW10[decimals - fracDigits]; // < 10^decimals
+    if (intPart > (INT64_MAX - fracUnits) / POW10[decimals]) over = true;
+    int64_t v = over ? INT64_MAX : intPart * POW10[decimals] + fracUnits;
+    out = neg ? -v : v;
+    return true;
+}
+
+inline int64_t parse(const std::string& s, int decimals) {
+    int64_t v = 0;
+    return parse(s.data(), s.size(), decimals, v) ? v : 0;
+}
+
+/**
+ * Format raw with exactly `decimals` fraction digits into buf (>= 32 bytes).
+ * Returns the length written (no terminator needed by callers, but added).
+ */
+inline size_t format(int64_t raw, int decimals, char* buf) {
+    char tmp[32];
+    size_t n = 0;
+    bool neg = raw < 0;
+    uint64_t v = neg ? (uint64_t)(-(raw + 1)) + 1 : (uint64_t)raw;
+
+    // digits in reverse, inserting the point after `decimals` digits
+    int written = 0;
+    do {
+        if (written == decimals && decimals > 0) tmp[n++] = '.';
+        tmp[n++] = (char)('0' + (v % 10));
+        v /= 10;
+        written++;
+    } while (v > 0 || written <= decimals);
+
+    size_t len = 0;
+    if (neg) buf[len++] = '-';
+    while (n > 0) buf[len++] = tmp[--n];
+    buf[len] = '\0';
+    return len;
+}
+
+inline std::string toString(int64_t raw, int decimals) {
+    char buf[32];
+    size_t n = format(raw, decimals, buf);
+    return std::string(buf, n);
+}
+
+inline double toDouble(int64_t raw, int decimals) {
+    return (double)raw / (double)POW10[decimals];
+}
+
+// nearest representable value
+inline int64_t fromDouble(double v, int decimals) {
+    return (int64_t)std::llround(v * (double)POW10[decimals]);
+}
+
+// never rounds up (what we want for order quantities)
+inline int64_t fromDoubleFloor(double v, int decimals) {
+    return (int64_t)std::floor(v * (double)POW10[decimals] + 1e-9);
+}
+
+// exact lot-size rounding: largest multiple of step <= raw (raw >= 0)
+inline int64_t floorToStep(int64_t raw, int64_t step) {
+    if (step <= 1) return raw;
+    return raw - (raw % step);
+}
+
+/**
+ * Number of decimals a tick/step string needs: "0.01000000" => 2,
+ * "1.00000000" => 0. Used to derive per-symbol scale from exchangeInfo.
+ */
+inline int decimalsOf(const std::string& step) {
+    size_t dot = step.find('.');
+    if (dot == std::string::npos) return 0;
+    int last = 0;
+    for (size_t i = dot + 1; i < step.size(); i++) {
+        if (step[i] != '0') last = (int)(i - dot);
+    }
+    return last > MAX_DECIMALS ? MAX_DECIMALS : last;
+}
+
+} // namespace FixedPoint
+
+#endif // FIXED_POINT_HPP
@@ -0,0 +1,181 @@
+#ifndef INDEXED_MAX_HEAP_HPP
+#define INDEXED_MAX_HEAP_HPP
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * IndexedMaxHeap
+ * Binary max-heap over ids [0, capacity) with one entry per id: update()
+ * inserts or re-keys in place (sift up/down, O(log n)), remove() drops an
+ * id. Memory is bounded by the id count, never by the number of updates.
+ *
+ * Mutators are single-writer (callers serialize them with their own lock).
+ * After every mutation that changes the root, the top (id, key) is published
+ * through a seqlock, so peekTop() can be read from any thread without the
+ * writer's lock.
+ */
+class IndexedMaxHeap {
+public:
+    // ids >= n are dropped when shrinking; new ids start absent
+    void resize(int n) {
+        if (n < (int)pos_.size()) {
+            for (int id = n; id < (int)pos_.size(); id++) remove(id);
+        }
+        pos_.resize(n, -1);
+        key_.resize(n, 0.0);
+    }
+
+    int capacity() const { return (int)pos_.size(); }
+    int size() const { return (int)heap_.size(); }
+    bool empty() const { return heap_.empty(); }
+    bool contains(int id) const { return id >= 0 && id < (int)pos_.size() && pos_[id] >= 0; }
+    double key(int id) const { return key_[id]; }
+
+    void clear() {
+        for (int id : heap_) pos_[id] = -1;
+        heap_.clear();
+        publish();
+    }
+
+    // insert or change id's key; ids outside [0, capacity) are ignored
+    void update(int id, double key) {
+        if (id < 0 || id >= (int)pos_.size()) return;
+        int i = pos_[id];
+        if (i < 0) {
+            i = (int)heap_.size();
+            heap_.push_back(id);
+            pos_[id] = i;
+            key_[id] = key;
+            siftUp(i);
+        } else {
+            double old = key_[id];
+            key_[id] = key;
+            if (key > old) siftUp(i);
+            else if (key < old) siftDown(i);
+        }
+        publish();
+    }
+
+    void remove(int id) {
+        if (!contains(id)) return;
+        int i = pos_[id];
+        int last = (int)heap_.size() - 1;
+        if (i != last) {
+            swapAt(i, last);
+            heap_.pop_back();
+            pos_[id] = -1;
+            siftDown(i);
+            siftUp(i);
+        } else {
+            heap_.pop_back();
+            pos_[id] = -1;
+        }
+        publish();
+    }
+
+    // writer-side top (same lock as the mutators)
+    bool top(int& id, double& key) const {
+        if (heap_.empty()) return false;
+        id = heap_[0];
+        key = key_[id];
+        return true;
+    }
+
+    // the k largest ids, best first, without touching the heap: a small
+    // candidate heap of positions (root, then children of each pick) => O(k log k)
+    void topK(int k, std::vector<int>& out) const {
+        out.clear();
+        if (heap_.empty() || k <= 0) return;
+        auto less = [this](int a, int b){ return key_[heap_[a]] < key_[heap_[b]]; };
+        std::vector<int> cand;
+        cand.reserve(2 * (size_t)k + 1);
+        cand.push_back(0);
+        const int n = (int)heap_.size();
+        while (!cand.empty() && (int)out.size() < k) {
+            std::pop_heap(cand.begin(), cand.end(), less);
+            int i = cand.back();
+            cand.pop_back();
+            out.push_back(heap_[i]);
+            for (int c = 2 * i + 1; c <= 2 * i + 2 && c < n; c++) {
+                cand.push_back(c);
+                std::push_heap(cand.begin(), cand.end(), less);
+            }
+        }
+    }
+
+    // lock-free: last published top, false when the heap was empty
+    bool peekTop(int& id, double& key) const {
+        while (true) {
+            uint64_t s1 = seq_.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            id  = topId_.load(std::memory_order_relaxed);
+            key = topKey_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == s1) return id >= 0;
+        }
+    }
+
+private:
+    bool higher(int a, int b) const { return key_[heap_[a]] > key_[heap_[b]]; }
+
+    void swapAt(int a, int b) {
+        std::swap(heap_[a], heap_[b]);
+        pos_[heap_[a]] = a;
+        pos_[heap_[b]] = b;
+    }
+
+    void siftUp(int i) {
+        while (i > 0) {
+            int p = (i - 1) / 2;
+            if (!higher(i, p)) break;
+            swapAt(i, p);
+            i = p;
+        }
+    }
+
+    void siftDown(int i) {
+        const int n = (int)heap_.size();
+        while (true) {
+            int best = i;
+            int l = 2 * i + 1, r = l + 1;
+            if (l < n && higher(l, best)) best = l;
+            if (r < n && higher(r, best)) best = r;
+            if (best == i) break;
+            swapAt(i, best);
+            i = best;
+        }
+    }
+
+    // only bumps the seqlock when the root actually changed
+    void publish() {
+        int id = heap_.empty() ? -1 : heap_[0];
+        double key = heap_.empty() ? 0.0 : key_[id];
+        if (id == topId_.load(std::memory_order_relaxed)
+            && key == topKey_.load(std::memory_order_relaxed)) return;
+        uint64_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        topId_.store(id, std::memory_order_relaxed);
+        topKey_.store(key, std::memory_order_relaxed);
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+private:
+    std::vector<int> heap_;    // heap order, holds ids
+    std::vector<int> pos_;     // id => index in heap_, -1 if absent
+    std::vector<double> key_;  // id => key (valid while present)
+
+    // seqlock-published root: even seq = stable
+    std::atomic<uint64_t> seq_{0};
+    std::atomic<int> topId_{-1};
+    std::atomic<double> topKey_{0.0};
+};
+
+#endif // INDEXED_MAX_HEAP_HPP
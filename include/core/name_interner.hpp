@@ -0,0 +1,89 @@
+#ifndef NAME_INTERNER_HPP
+#define NAME_INTERNER_HPP
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+/**
+ * NameInterner<MAX>
+ * Maps names to dense ids [0, MAX) through an open-addressing table.
+ *
+ * - find() is lock-free (ids are published with release stores)
+ * - intern() only takes a mutex when the name is new
+ * - ids are never reused or removed
+ *
+ * Shared by AssetRegistry ("BTC") and SymbolRegistry ("BTCUSDT").
+ */
+template <int MAX>
+class NameInterner {
+public:
+    NameInterner() {
+        for (auto& b : table_) {
+            b.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // -1 if unknown, never allocates
+    int32_t find(const std::string& name) const {
+        uint32_t pos = hashName(name) & MASK;
+        for (int probes = 0; probes < TABLE_SIZE; probes++) {
+            int32_t v = table_[pos].load(std::memory_order_acquire);
+            if (v == 0) return -1;
+            if (names_[v - 1] == name) return v - 1;
+            pos = (pos + 1) & MASK;
+        }
+        return -1;
+    }
+
+    // id for name, creating it if needed (-1 if full)
+    int32_t intern(const std::string& name) {
+        int32_t id = find(name);
+        if (id >= 0) return id;
+
+        std::lock_guard<std::mutex> lk(insertMutex_);
+        // someone may have inserted it while we waited
+        uint32_t pos = hashName(name) & MASK;
+        while (true) {
+            int32_t v = table_[pos].load(std::memory_order_relaxed);
+            if (v == 0) break;
+            if (names_[v - 1] == name) return v - 1;
+            pos = (pos + 1) & MASK;
+        }
+
+        int next = count_.load(std::memory_order_relaxed);
+        if (next >= MAX) return -1;
+        names_[next] = name;
+        table_[pos].store(next + 1, std::memory_order_release);
+        count_.store(next + 1, std::memory_order_release);
+        return next;
+    }
+
+    const std::string& name(int32_t id) const { return names_[id]; }
+
+    int size() const { return count_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr int TABLE_SIZE = 2 * MAX; // MAX must be a power of two
+    static constexpr uint32_t MASK = TABLE_SIZE - 1;
+
+    // FNV-1a, names are short
+    static uint32_t hashName(const std::string& name) {
+        uint32_t h = 2166136261u;
+        for (unsigned char c : name) {
+            h ^= c;
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // bucket => id+1 (0 = empty)
+    std::atomic<int32_t> table_[TABLE_SIZE];
+    // written once before the id is published in table_
+    std::string names_[MAX];
+    std::atomic<int> count_{0};
+    std::mutex insertMutex_;
+};
+
+#endif // NAME_INTERNER_HPP
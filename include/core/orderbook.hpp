@@ -4,17 +4,33 @@
 #include <string>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <thread>
 #include <atomic>
 #include <chrono>
 #include <vector>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <functional>
 #include <nlohmann/json.hpp>
+#include "core/symbol_registry.hpp"
+#include "core/fixed_point.hpp"
+#include "core/timer_service.hpp"
+#include "core/feed_supervisor.hpp"
 
 class TriangleScanner; // forward declare to avoid circular includes
 
+/**
+ * One depth level. The exact values are the fixed-point raws (scale from the
+ * symbol's tick/step size, see SymbolRegistry); price/quantity are the same
+ * numbers as doubles for the float-based estimators.
+ */
 struct OrderBookLevel {
     double price;
     double quantity;
+    int64_t priceRaw{0}; // units of 10^-priceDecimals
+    int64_t qtyRaw{0};   // units of 10^-qtyDecimals
 };
 
 struct OrderBookData {
@@ -22,6 +38,171 @@ struct OrderBookData {
     std::vector<OrderBookLevel> asks; // sorted ascending
 };
 
+// levels kept per side (the combined stream is depth20)
+constexpr int BOOK_DEPTH = 20;
+
+/**
+ * BookSlot
+ * One symbol's depth in fixed arrays of fixed-point raws behind a seqlock:
+ * even seq = stable, odd = a writer is inside. Writers take the slot with a
+ * CAS on seq (a reconnect overlapping the old stream can't interleave);
+ * readers never block a writer, they copy and retry if seq moved.
+ *
+ * Several slots read consistently: note each slot's even seq, copy them
+ * all, then re-check every seq. If none moved, the copies are one instant
+ * across all the books.
+ *
+ * The receive time of the last write is kept next to it (updatedNs), so a
+ * book's age is one load from any thread, and so is the exchange's update
+ * id, so two connections feeding the same symbol never move it backwards.
+ */
+class alignas(64) BookSlot {
+public:
+    /**
+     * Replace the book (received at recvNs, steady clock); levels beyond
+     * BOOK_DEPTH are dropped. updateId != 0 => only if newer than the
+     * book's (false: a duplicate or older snapshot, nothing written).
+     */
+    bool write(const OrderBookLevel* bids, int nBids,
+               const OrderBookLevel* asks, int nAsks,
+               int priceDecimals, int qtyDecimals, int64_t recvNs,
+               uint64_t updateId = 0) {
+        nBids = std::min(nBids, BOOK_DEPTH);
+        nAsks = std::min(nAsks, BOOK_DEPTH);
+        uint64_t s = lock();
+        if (updateId != 0 && updateId <= updateId_.load(std::memory_order_relaxed)) {
+            // nothing written: back to the even seq we took, readers' copies stay valid
+            seq_.store(s - 1, std::memory_order_release);
+            return false;
+        }
+        priceDecimals_.store(priceDecimals, std::memory_order_relaxed);
+        qtyDecimals_.store(qtyDecimals, std::memory_order_relaxed);
+        for (int i = 0; i < nBids; i++) {
+            bidPx_[i].store(bids[i].priceRaw, std::memory_order_relaxed);
+            bidQty_[i].store(bids[i].qtyRaw, std::memory_order_relaxed);
+        }
+        for (int i = 0; i < nAsks; i++) {
+            askPx_[i].store(asks[i].priceRaw, std::memory_order_relaxed);
+            askQty_[i].store(asks[i].qtyRaw, std::memory_order_relaxed);
+        }
+        nBids_.store(nBids, std::memory_order_relaxed);
+        nAsks_.store(nAsks, std::memory_order_relaxed);
+        updatedNs_.store(recvNs, std::memory_order_relaxed);
+        if (updateId != 0) updateId_.store(updateId, std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_release);
+        return true;
+    }
+
+    // exchange update id of the current book (0 => none / not tracked)
+    uint64_t updateId() const { return updateId_.load(std::memory_order_relaxed); }
+
+    // receive time of the last write (0 => never written)
+    int64_t updatedNs() const { return updatedNs_.load(std::memory_order_relaxed); }
+
+    // even seq to read under (spins past a writer)
+    uint64_t beginRead() const {
+        while (true) {
+            uint64_t s = seq_.load(std::memory_order_acquire);
+            if ((s & 1) == 0) return s;
+            std::this_thread::yield();
+        }
+    }
+
+    // true if nothing was written since beginRead() returned s
+    bool validate(uint64_t s) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq_.load(std::memory_order_relaxed) == s;
+    }
+
+    // completed writes so far (0 => never written)
+    uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+    // copy between beginRead() and validate(); reuses out's capacity
+    void copyTo(OrderBookData& out) const {
+        const int pd = priceDecimals_.load(std::memory_order_relaxed);
+        const int qd = qtyDecimals_.load(std::memory_order_relaxed);
+        const int nb = std::min(nBids_.load(std::memory_order_relaxed), BOOK_DEPTH);
+        const int na = std::min(nAsks_.load(std::memory_order_relaxed), BOOK_DEPTH);
+        out.bids.resize(nb);
+        out.asks.resize(na);
+        for (int i = 0; i < nb; i++) load(out.bids[i], bidPx_[i], bidQty_[i], pd, qd);
+        for (int i = 0; i < na; i++) load(out.asks[i], askPx_[i], askQty_[i], pd, qd);
+    }
+
+    // best bid/ask without copying levels; false if a side is empty
+    bool top(double& bestBid, double& bestAsk) const {
+        while (true) {
+            uint64_t s = beginRead();
+            bool twoSided = nBids_.load(std::memory_order_relaxed) > 0
+                         && nAsks_.load(std::memory_order_relaxed) > 0;
+            int pd = priceDecimals_.load(std::memory_order_relaxed);
+            int64_t bid = bidPx_[0].load(std::memory_order_relaxed);
+            int64_t ask = askPx_[0].load(std::memory_order_relaxed);
+            if (!validate(s)) continue;
+            if (!twoSided) return false;
+            bestBid = FixedPoint::toDouble(bid, pd);
+            bestAsk = FixedPoint::toDouble(ask, pd);
+            return true;
+        }
+    }
+
+private:
+    uint64_t lock() {
+        uint64_t s = seq_.load(std::memory_order_relaxed);
+        while (true) {
+            if ((s & 1) == 0 &&
+                seq_.compare_exchange_weak(s, s + 1,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+                std::atomic_thread_fence(std::memory_order_release);
+                return s + 1;
+            }
+            std::this_thread::yield();
+            s = seq_.load(std::memory_order_relaxed);
+        }
+    }
+
+    static void load(OrderBookLevel& l,
+                     const std::atomic<int64_t>& px,
+                     const std::atomic<int64_t>& qty,
+                     int pd, int qd) {
+        l.priceRaw = px.load(std::memory_order_relaxed);
+        l.qtyRaw   = qty.load(std::memory_order_relaxed);
+        l.price    = FixedPoint::toDouble(l.priceRaw, pd);
+        l.quantity = FixedPoint::toDouble(l.qtyRaw, qd);
+    }
+
+    std::atomic<uint64_t> seq_{0};
+    std::atomic<int> nBids_{0};
+    std::atomic<int> nAsks_{0};
+    std::atomic<int> priceDecimals_{8};
+    std::atomic<int> qtyDecimals_{8};
+    std::atomic<int64_t> updatedNs_{0};
+    std::atomic<uint64_t> updateId_{0};
+    std::atomic<int64_t> bidPx_[BOOK_DEPTH]{};
+    std::atomic<int64_t> bidQty_[BOOK_DEPTH]{};
+    std::atomic<int64_t> askPx_[BOOK_DEPTH]{};
+    std::atomic<int64_t> askQty_[BOOK_DEPTH]{};
+};
+
+/**
+ * Books for a set of symbols as of one instant (every slot's version
+ * validated together), indexed by SymbolId. Buffers are kept between
+ * snapshots, so refreshing one of the same size doesn't allocate.
+ */
+struct BookSnapshot {
+    std::vector<int> slot;            // SymbolId => index in books, -1 if not captured
+    std::vector<OrderBookData> books;
+    size_t count{0};                  // books[0..count) are valid
+
+    // nullptr if the symbol wasn't captured or its book is one-sided/empty
+    const OrderBookData* find(SymbolId id) const {
+        if (id < 0 || id >= (SymbolId)slot.size() || slot[id] < 0) return nullptr;
+        const OrderBookData& ob = books[slot[id]];
+        return (ob.bids.empty() || ob.asks.empty()) ? nullptr : &ob;
+    }
+};
+
 class OrderBookManager {
 public:
     explicit OrderBookManager(TriangleScanner* scanner = nullptr);
@@ -34,18 +215,64 @@ public:
     // Return entire depth snapshot
     OrderBookData getOrderBook(const std::string& symbol);
 
+    // best bid/ask only (no copy of the levels); false if no two-sided book yet
+    bool getTopOfBook(const std::string& symbol, double& bestBid, double& bestAsk);
+
+    /**
+     * out[i] = book of symbols[i], all as of one instant: the copies are
+     * retried while any of the books is being written (no lock is taken,
+     * writers never wait). False if no untorn view was seen within the
+     * retry budget; the books are then unusable for pricing.
+     */
+    bool getOrderBooks(const SymbolId* symbols, size_t count, OrderBookData* out);
+    bool getOrderBooks(const std::vector<std::string>& symbols, std::vector<OrderBookData>& out);
+
+    // same for a set of symbols into a SymbolId-indexed snapshot (duplicates
+    // and unknown ids are skipped)
+    bool snapshotBooks(const std::vector<SymbolId>& symbols, BookSnapshot& out);
+
+    // reads that had to be retried because a writer moved a book (dashboard)
+    uint64_t getTornReads() const { return tornReads_.load(std::memory_order_relaxed); }
+
     // NEW => single combined WebSocket approach
     // We'll gather all symbols from 'start(symbol)' calls, then open one or more connections
+    // (later calls only add connections for symbols started since)
     void startCombinedWebSocket();
 
     /**
-     * NEW: Check if an order book is stale. If the last message was more than
-     *      `maxStaleMs` milliseconds ago, we consider it stale.
+     * Flag started books not updated for maxStaleMs, from a sweep on
+     * TimerService (every maxStaleMs/4). Calling it again changes the bound.
+     */
+    void startStaleSweep(double maxStaleMs);
+
+    // receive time (steady ns) of the symbol's last book, 0 => never; one load
+    int64_t lastUpdateNs(SymbolId id) const {
+        return (id >= 0 && id < SymbolRegistry::MAX_SYMBOLS) ? slots_[id].updatedNs() : 0;
+    }
+
+    /**
+     * Connection policy for the combined streams (hot standby, ping/pong,
+     * silence watchdog, reconnect backoff), see FeedSupervisor. Call before
+     * startCombinedWebSocket; the timeouts also apply to running links.
+     */
+    void setFeedOptions(const FeedOptions& opts) { feeds_->setOptions(opts); }
+
+    FeedStats getFeedStats() const { return feeds_->stats(); }
+
+    // messages dropped because the other link of the chunk already delivered them
+    uint64_t getDuplicateMessages() const { return duplicates_.load(std::memory_order_relaxed); }
+
+    /**
+     * NEW: Check if an order book is stale (see startStaleSweep): one load,
+     *      no clock, no lock.
      * @param symbol The symbol to check (e.g. "BTCUSDT").
-     * @param maxStaleMs The maximum staleness in milliseconds (default 500).
-     * @return true if stale or if we have no record of this symbol, false otherwise.
+     * @return true if stale, never updated, or unknown; false otherwise.
      */
-    bool isStale(const std::string& symbol, double maxStaleMs = 500.0) const; // ADDED
+    bool isStale(const std::string& symbol) const;
+    bool isStale(SymbolId id) const;
+
+    // started books currently stale (dashboard)
+    int getStaleBooks() const { return staleBooks_.load(std::memory_order_relaxed); }
 
 private:
     // Old approach => per-symbol
@@ -55,29 +282,41 @@ private:
     void onFail(const std::string& symbol, int backoff);
     void onClose(const std::string& symbol, int backoff);
 
-    // NEW => combined approach
-    void connectCombinedWebSocket(const std::string& fullUrl);
-    void reconnectCombined(const std::string& url, int backoff);
-    void onCombinedMessage(const std::string& payload);
+    // NEW => combined approach (connections are FeedSupervisor's)
+    void onCombinedMessage(const std::string& payload, int64_t recvNs);
 
 private:
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastMsgTime_;
-    std::unordered_map<std::string, OrderBookData> books_;
-    std::unordered_map<std::string, std::mutex> mutexes_;
+    std::unordered_set<std::string> symbols_;  // start()ed symbols (globalMutex_)
+    std::vector<SymbolId> startedIds_;         // their ids, for the stale sweep (globalMutex_)
 
-    // For single-WS-per-symbol approach
-    std::unordered_map<std::string, std::thread> threads_;
+    // one seqlocked book per SymbolId; never reallocated, so slot pointers stay valid
+    std::unique_ptr<BookSlot[]> slots_;
+    std::atomic<uint64_t> tornReads_{0};
+    static constexpr int MAX_READ_RETRIES = 64;
+
+    // stale sweep: flags per SymbolId, from each slot's updatedNs
+    void sweepStale();
+    std::unique_ptr<std::atomic<bool>[]> stale_;
+    std::atomic<int64_t> maxStaleNs_{500000000};
+    std::atomic<int> staleBooks_{0};
+    TimerService::TimerId staleSweep_{0};
 
     // For combined approach, we might open multiple websockets if we have many symbols
+    std::unordered_set<std::string> streamed_; // symbols already in some combined stream
+    std::mutex streamsMutex_;                  // startCombinedWebSocket can run from the refresh thread
+    std::atomic<uint64_t> duplicates_{0};
 
     /**
-     * NOTE: We make this mutable so that isStale(...) can lock it even though isStale is const.
+     * NOTE: mutable so const readers can lock it.
      */
     mutable std::mutex globalMutex_;
 
     std::atomic<bool> running_;
 
     TriangleScanner* scanner_;
+
+    // last: its link threads call onCombinedMessage, so it's stopped before the rest goes
+    std::unique_ptr<FeedSupervisor> feeds_;
 };
 
 #endif // ORDERBOOK_HPP
@@ -0,0 +1,165 @@
+#ifndef SYMBOL_REGISTRY_HPP
+#define SYMBOL_REGISTRY_HPP
+
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "core/name_interner.hpp"
+#include "core/asset_registry.hpp"
+#include "core/fixed_point.hpp"
+#include <nlohmann/json_fwd.hpp>
+
+using SymbolId = int32_t;
+constexpr SymbolId INVALID_SYMBOL = -1;
+
+/**
+ * Static per-symbol data from exchangeInfo.
+ * Prices are stored in units of 10^-priceDecimals, quantities in 10^-qtyDecimals.
+ */
+struct SymbolInfo {
+    AssetId baseAsset{INVALID_ASSET};
+    AssetId quoteAsset{INVALID_ASSET};
+    int priceDecimals{FixedPoint::MAX_DECIMALS}; // from PRICE_FILTER.tickSize
+    int qtyDecimals{FixedPoint::MAX_DECIMALS};   // from LOT_SIZE.stepSize
+    int64_t tickRaw{1};                          // tickSize in price units
+    int64_t stepRaw{1};                          // stepSize in qty units
+};
+
+/**
+ * Order filters from exchangeInfo, in the symbol's fixed-point units
+ * (qty at qtyDecimals, price at priceDecimals). 0 max = no limit.
+ * Symbols without exchangeInfo get the old defaults (minQty 0.0001,
+ * minNotional 10).
+ */
+struct SymbolFilters {
+    // LOT_SIZE
+    int64_t minQtyRaw{0};
+    int64_t maxQtyRaw{0};
+    // MARKET_LOT_SIZE (falls back to LOT_SIZE when absent/zero)
+    int64_t marketMinQtyRaw{0};
+    int64_t marketMaxQtyRaw{0};
+    int64_t marketStepRaw{0};
+    // PRICE_FILTER
+    int64_t minPriceRaw{0};
+    int64_t maxPriceRaw{0};
+    // NOTIONAL / MIN_NOTIONAL, in quote units
+    double minNotional{10.0};
+    double maxNotional{0.0};
+    bool minNotionalMarket{true}; // applyMinToMarket / applyToMarket
+    bool maxNotionalMarket{false};
+    // config/symbol_filters.json overrides, re-applied on every (re)register
+    double manualMinQty{0.0};
+    double manualMinNotional{0.0};
+};
+
+/**
+ * One published version of a symbol's scale + filters. Never modified once
+ * published, so the two always come from the same exchangeInfo.
+ */
+struct SymbolEntry {
+    SymbolInfo info;
+    SymbolFilters filters;
+};
+
+enum class FilterReject : uint8_t {
+    OK = 0,
+    QTY_BELOW_MIN,
+    QTY_ABOVE_MAX,
+    PRICE_OUT_OF_RANGE,
+    NOTIONAL_BELOW_MIN,
+    NOTIONAL_ABOVE_MAX,
+    COUNT
+};
+
+const char* filterRejectName(FilterReject r);
+
+/**
+ * SymbolRegistry
+ * Interns exchange symbols ("BTCUSDT") into dense ids and keeps their
+ * SymbolInfo in a fixed array indexed by id. Symbols we never got
+ * exchangeInfo for keep the 8-decimal defaults.
+ *
+ * Each id points at an immutable SymbolEntry. Re-registering (the
+ * exchangeInfo refresh thread) publishes a new version with one atomic
+ * store, and only if something changed; readers on any thread see the old
+ * or the new entry whole, never a mix. Replaced versions are kept for the
+ * process lifetime since callers hold plain references into them.
+ */
+class SymbolRegistry {
+public:
+    static constexpr int MAX_SYMBOLS = 4096;
+
+    static SymbolRegistry& instance();
+
+    SymbolId intern(const std::string& symbol);
+    SymbolId find(const std::string& symbol) const { return names_.find(symbol); }
+    const std::string& name(SymbolId id) const { return names_.name(id); }
+    int size() const { return names_.size(); }
+
+    const SymbolInfo& info(SymbolId id) const { return entries_[id].load(std::memory_order_acquire)->info; }
+    const SymbolFilters& filters(SymbolId id) const { return entries_[id].load(std::memory_order_acquire)->filters; }
+
+    // info + filters of one version (default entry for unknown ids)
+    const SymbolEntry& entry(SymbolId id) const {
+        return (id >= 0 && id < MAX_SYMBOLS) ? *entries_[id].load(std::memory_order_acquire)
+                                             : defaultEntry_;
+    }
+
+    // default info for unknown ids, so callers don't need to branch
+    const SymbolInfo& infoOrDefault(SymbolId id) const { return entry(id).info; }
+
+    /**
+     * Register (or publish a new version of) a symbol's scale and filters.
+     * Ids are stable: re-registering keeps the id and any manual overrides.
+     */
+    SymbolId registerSymbol(const std::string& symbol,
+                            const std::string& baseAsset,
+                            const std::string& quoteAsset,
+                            const SymbolInfo& scale,
+                            const SymbolFilters& filters);
+
+    /**
+     * Parse one entry of exchangeInfo "symbols" (LOT_SIZE, MARKET_LOT_SIZE,
+     * PRICE_FILTER, NOTIONAL, MIN_NOTIONAL) without touching the registry.
+     */
+    static bool parseExchangeInfo(const nlohmann::json& symObj,
+                                  std::string& symbol,
+                                  std::string& baseAsset,
+                                  std::string& quoteAsset,
+                                  SymbolInfo& info,
+                                  SymbolFilters& filters);
+
+    // parseExchangeInfo + registerSymbol
+    SymbolId registerFromExchangeInfo(const nlohmann::json& symObj);
+
+    // manual override (config/symbol_filters.json); survives a later exchangeInfo load
+    void overrideMinimums(SymbolId id, double minQty, double minNotional);
+
+    /**
+     * Largest valid order quantity <= qty (floored to the market step if the
+     * symbol has one, else the lot step), in qtyDecimals units.
+     */
+    int64_t roundQty(SymbolId id, double qty, bool market = true) const;
+
+    // validate a rounded quantity at a reference price; never allocates
+    FilterReject check(SymbolId id, int64_t qtyRaw, double price, bool market = true) const;
+
+private:
+    SymbolRegistry();
+
+    static void applyManualMinimums(SymbolEntry& e);
+    // swap in e as id's current entry unless it equals it; writeMutex_ held
+    void publish(SymbolId id, const SymbolEntry& e);
+
+    NameInterner<MAX_SYMBOLS> names_;
+    std::atomic<const SymbolEntry*> entries_[MAX_SYMBOLS];
+    SymbolEntry defaultEntry_;
+
+    std::mutex writeMutex_; // registerSymbol / overrideMinimums
+    std::vector<std::unique_ptr<const SymbolEntry>> versions_; // every published entry
+};
+
+#endif // SYMBOL_REGISTRY_HPP
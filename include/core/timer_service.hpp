@@ -0,0 +1,81 @@
+#ifndef TIMER_SERVICE_HPP
+#define TIMER_SERVICE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "core/timer_wheel.hpp"
+
+/**
+ * TimerService
+ * Process-wide clock for everything time-driven: cooldown expiry, backoff
+ * reinstatement, the stale-book sweep, feed supervision and the triggers of
+ * the periodic jobs (dashboard, rescore, exports; main runs those on a
+ * pool). One TimerWheel at 1ms ticks behind a mutex; a single
+ * thread (run() or start()) advances it and runs due callbacks outside the
+ * lock, so a callback may schedule or cancel timers.
+ *
+ * Callbacks share that thread: keep them short, anything heavy belongs on
+ * a pool. Hot paths don't need the clock at all: they read flags the
+ * timers flip, or coarseNowNs() (the time of the last tick).
+ */
+class TimerService {
+public:
+    using Callback = TimerWheel::Callback;
+    using TimerId  = TimerWheel::TimerId;
+
+    static constexpr int64_t TICK_NS = 1000000; // 1ms
+
+    static TimerService& instance();
+    ~TimerService();
+
+    static int64_t nowNs();
+    // steady time as of the last tick (one relaxed load)
+    int64_t coarseNowNs() const { return coarseNs_.load(std::memory_order_relaxed); }
+
+    TimerId scheduleAt(int64_t deadlineNs, Callback cb);
+    TimerId scheduleAfter(int64_t delayNs, Callback cb);
+    // cb every periodNs (first run one period from now) until cancelled;
+    // a run that overruns skips the periods it missed
+    TimerId schedulePeriodic(int64_t periodNs, Callback cb);
+
+    // false if it already fired (one-shot) or was cancelled
+    bool cancel(TimerId id);
+
+    size_t pending() const;
+
+    // drive the wheel on this thread until stop()
+    void run();
+    // ... or on a thread of its own
+    void start();
+    void stop();
+
+private:
+    TimerService();
+
+    struct Periodic {
+        int64_t periodNs{0};
+        int64_t nextNs{0};
+        TimerId current{0};
+        std::shared_ptr<Callback> cb;
+    };
+    static constexpr TimerId PERIODIC_BIT = TimerId(1) << 63;
+
+    void firePeriodic(TimerId handle);
+    void loop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    TimerWheel wheel_;
+    std::unordered_map<TimerId, Periodic> periodic_;
+    TimerId nextPeriodic_{1};
+
+    std::atomic<int64_t> coarseNs_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+#endif // TIMER_SERVICE_HPP
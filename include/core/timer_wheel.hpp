@@ -0,0 +1,72 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * TimerWheel
+ * Hierarchical timing wheel: LEVELS wheels of SLOTS buckets, level L
+ * covering SLOTS^(L+1) ticks. A timer sits in the lowest level where its
+ * deadline shares every higher digit with the current tick; when the
+ * current tick reaches a bucket of a higher level, that bucket is cascaded
+ * down. schedule()/cancel() are O(1) (intrusive lists over a node pool),
+ * advance() is O(ticks passed + timers due).
+ *
+ * Not thread-safe: the owner serializes calls. advance() hands the due
+ * callbacks back instead of running them, so they can run after the
+ * owner's lock is dropped (and schedule new timers).
+ */
+class TimerWheel {
+public:
+    using Callback = std::function<void()>;
+    using TimerId  = uint64_t; // 0 => none
+
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int SLOTS     = 1 << SLOT_BITS;
+    static constexpr int LEVELS    = 4;   // 2^32 ticks (49 days at 1ms)
+
+    // tick 0 = nowNs; deadlines are rounded up to whole ticks
+    TimerWheel(int64_t tickNs, int64_t nowNs);
+
+    // fire at deadlineNs (a past deadline fires on the next advance)
+    TimerId schedule(int64_t deadlineNs, Callback cb);
+
+    // false if id already fired or was cancelled
+    bool cancel(TimerId id);
+
+    // move the callbacks of every timer due by nowNs into `due`, in deadline order
+    size_t advance(int64_t nowNs, std::vector<Callback>& due);
+
+    // drop every pending timer
+    void clear();
+
+    size_t size() const { return active_; }
+    int64_t tickNs() const { return tickNs_; }
+
+private:
+    struct Node {
+        int64_t tick{0};
+        Callback cb;
+        int prev{-1}, next{-1};
+        uint32_t gen{0};
+        int level{-1}, slot{-1}; // level < 0 => free
+    };
+
+    void place(int idx);
+    void unlink(int idx);
+    void release(int idx);
+    void cascade(int level);
+
+    int heads_[LEVELS][SLOTS];
+    std::vector<Node> nodes_;
+    std::vector<int> free_;
+    int64_t tickNs_;
+    int64_t originNs_;
+    int64_t curTick_{0};
+    size_t active_{0};
+};
+
+#endif // TIMER_WHEEL_HPP
@@ -9,4 +9,30 @@ struct Triangle {
     std::vector<std::string> path;
 };
 
+/**
+ * BFS-built paths tag every symbol with a direction:
+ *   "BTCUSDT_FWD" => sell base (BTC) for quote (USDT)
+ *   "BTCUSDT_INV" => spend quote (USDT) to buy base (BTC)
+ * File-based paths carry no tag => UNSPECIFIED.
+ */
+enum class LegDirection { UNSPECIFIED, FORWARD, INVERSE };
+
+/**
+ * Split a path entry into the raw exchange symbol and its direction tag.
+ */
+inline LegDirection splitLegSymbol(const std::string& leg, std::string& rawSymbol) {
+    if (leg.size() >= 4) {
+        if (leg.compare(leg.size()-4, 4, "_FWD") == 0) {
+            rawSymbol = leg.substr(0, leg.size()-4);
+            return LegDirection::FORWARD;
+        }
+        if (leg.compare(leg.size()-4, 4, "_INV") == 0) {
+            rawSymbol = leg.substr(0, leg.size()-4);
+            return LegDirection::INVERSE;
+        }
+    }
+    rawSymbol = leg;
+    return LegDirection::UNSPECIFIED;
+}
+
 #endif // TRIANGLE_HPP
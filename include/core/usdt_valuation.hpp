@@ -0,0 +1,43 @@
+#ifndef USDT_VALUATION_HPP
+#define USDT_VALUATION_HPP
+
+#include <atomic>
+#include "core/asset_registry.hpp"
+#include "core/symbol_registry.hpp"
+
+/**
+ * UsdtValuation
+ * USDT per unit of every asset, kept current from top-of-book updates:
+ *   XUSDT => price[X] = best bid (what selling X returns)
+ *   USDTX => price[X] = 1 / best ask
+ *   XY    => cross rates for assets without a USDT market: X via Y at the
+ *            bid, Y via X at 1/ask; price[X] = cross[X] * price[Y]
+ * Fixed arrays indexed by AssetId with relaxed atomics: reads and updates
+ * are lock-free and never allocate, so every simulation can value a
+ * portfolio. A price of 0 means "no market seen yet".
+ */
+class UsdtValuation {
+public:
+    static UsdtValuation& instance();
+
+    // book update for a registered symbol (base/quote from SymbolRegistry)
+    void onTopOfBook(SymbolId symbol, double bestBid, double bestAsk);
+
+    // USDT per unit, 0 if unknown
+    double price(AssetId asset) const;
+
+    AssetId usdt() const { return usdt_; }
+
+private:
+    UsdtValuation();
+
+    // take `partner` as asset's bridge if it has none yet, or a better one
+    void adoptCross(AssetId asset, AssetId partner, double rate);
+
+    AssetId usdt_;
+    std::atomic<double> direct_[AssetRegistry::MAX_ASSETS];  // from a USDT market
+    std::atomic<double> cross_[AssetRegistry::MAX_ASSETS];   // units of via_ per unit
+    std::atomic<AssetId> via_[AssetRegistry::MAX_ASSETS];    // bridge asset, INVALID_ASSET if none
+};
+
+#endif // USDT_VALUATION_HPP
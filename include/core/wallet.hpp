@@ -2,42 +2,114 @@
 #define WALLET_HPP
 
 #include <string>
-#include <unordered_map>
 #include <mutex>
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "core/asset_registry.hpp"
+#include "core/fixed_point.hpp"
 
 /**
  * For multi-leg atomic trades, we define:
  */
 struct WalletChange {
     std::string asset;
+    AssetId assetId{INVALID_ASSET};
     double deltaBalance; // +/- adjustments to total
     double deltaLocked;  // +/- adjustments to locked portion
+    int64_t deltaBalanceRaw{0}; // same deltas in wallet units, undone exactly
+    int64_t deltaLockedRaw{0};
+    uint64_t journalSeq{0};     // journal seq taken with the slot write (0 => no journal)
+};
+
+class WalletJournal;
+
+// raw (fixed-point) balance of one asset, for snapshots/recovery
+struct WalletBalance {
+    std::string asset;
+    int64_t totalRaw;
+    int64_t lockedRaw;
 };
 
 struct WalletTransaction {
     bool active;
     std::vector<WalletChange> changes;
+    std::vector<AssetId> held;  // assets whose exchange updates wait for commit/rollback
+};
+
+/**
+ * One asset's balances, padded to its own cache line so scanner threads
+ * reading different assets never share a line with a writer.
+ *
+ * seq is a per-slot seqlock: even = stable, odd = a writer is inside.
+ * Readers retry until they see the same even seq before and after.
+ * Amounts are fixed-point in Wallet::DECIMALS units so repeated fills
+ * and rollbacks never accumulate float drift.
+ *
+ * While a transaction holds the asset, exchange-reported updates
+ * (setBalances/adjustBalance) are parked in the pending fields and applied
+ * when the last hold is released. The pending fields are only touched
+ * under the slot lock.
+ */
+struct alignas(64) WalletSlot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<int64_t> total{0};
+    std::atomic<int64_t> locked{0};
+    std::atomic<bool> used{false}; // show in printAll/saveToFile
+
+    int holds{0};               // open transactions on this asset
+    bool pendingSet{false};     // an absolute position arrived
+    int64_t pendingTotal{0};
+    int64_t pendingLocked{0};
+    int64_t pendingDelta{0};    // deltas on top of it (or of the slot)
 };
 
+/**
+ * Wallet
+ * Balances live in a fixed array of slots indexed by AssetId, so reads are
+ * lock-free and writers only contend per asset. The string API is kept; the
+ * AssetId overloads skip the name lookup for hot paths.
+ */
 class Wallet {
 public:
+    // balances are held in 10^-8 units (Binance's finest asset precision)
+    static constexpr int DECIMALS = FixedPoint::MAX_DECIMALS;
+
     Wallet();
 
     void setBalance(const std::string& asset, double amount);
 
+    // Exchange-reported position for one asset: total = free + locked.
+    // Deferred until commit/rollback while a transaction holds the asset.
+    void setBalances(const std::string& asset, double free, double locked);
+
+    // Add (or subtract) from total, e.g. deposit/withdrawal events
+    // (deferred like setBalances)
+    void adjustBalance(const std::string& asset, double delta);
+
     // free = total - locked
     double getFreeBalance(const std::string& asset) const;
+    double getFreeBalance(AssetId id) const;
 
     // total
     double getTotalBalance(const std::string& asset) const;
+    double getTotalBalance(AssetId id) const;
 
     WalletTransaction beginTransaction();
+    // ... holding `ids` from the start: the exchange may report the fills
+    // before the trade path books them, so its updates for these assets
+    // wait until the transaction ends (applyChange holds what it touches)
+    WalletTransaction beginTransaction(const AssetId* ids, size_t count);
 
     bool applyChange(WalletTransaction& tx,
                      const std::string& asset,
                      double deltaBalance,
                      double deltaLocked);
+    bool applyChange(WalletTransaction& tx,
+                     AssetId id,
+                     double deltaBalance,
+                     double deltaLocked);
 
     bool commitTransaction(WalletTransaction& tx);
     void rollbackTransaction(WalletTransaction& tx);
@@ -54,11 +126,40 @@ public:
      */
     bool loadFromFile(const std::string& filename);       // ADDED
 
+    /**
+     * Journal committed transactions and balance sets from now on.
+     * Attach before trading threads start; nullptr detaches.
+     */
+    void setJournal(WalletJournal* journal) { journal_ = journal; }
+
+    // every used asset with its raw balances
+    std::vector<WalletBalance> balancesRaw() const;
+
+    // overwrite one asset from recovered state (not journaled)
+    void restoreRaw(const std::string& asset, int64_t totalRaw, int64_t lockedRaw);
+
 private:
-    std::unordered_map<std::string,double> balances_;
-    std::unordered_map<std::string,double> locked_;
+    // consistent (total, locked) pair for one slot, no locks taken
+    void readSlot(AssetId id, int64_t& total, int64_t& locked) const;
+
+    // per-slot writer lock (seq odd while held)
+    uint64_t lockSlot(WalletSlot& slot) const;
+    void unlockSlot(WalletSlot& slot, uint64_t seq) const;
+
+    WalletSlot* slotFor(const std::string& asset);
+
+    // slot lock held: count tx in on the asset (once per tx)
+    void holdLocked(WalletTransaction& tx, AssetId id);
+    // drop tx's holds; the last one applies the parked exchange updates
+    void releaseHolds(WalletTransaction& tx);
+
+private:
+    std::unique_ptr<WalletSlot[]> slots_;
+
+    WalletJournal* journal_{nullptr};
 
-    mutable std::mutex walletMutex_;
+    // serializes file I/O only, never taken on the trading path
+    mutable std::mutex ioMutex_;
 };
 
 #endif // WALLET_HPP
@@ -0,0 +1,140 @@
+#ifndef WALLET_JOURNAL_HPP
+#define WALLET_JOURNAL_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include "core/wallet.hpp"
+
+/**
+ * WalletJournal
+ * Write-ahead log for the Wallet, replacing the full wallet.json rewrite
+ * after every trade.
+ *
+ * - <base>.wal  : append-only binary records (committed transactions as raw
+ *                 deltas, absolute SETs from exchange sync)
+ * - <base>.snap : compacted balances + the last seq they include
+ *
+ * Every slot write takes its seq under the slot's lock: a SET when it is
+ * recorded, a transaction change when applyChange writes it (the record
+ * itself is queued at commit). A delta older than its asset's last SET is
+ * already part of that SET's absolute value and is skipped on replay.
+ *
+ * The trade thread only queues ids and integers; a background thread encodes,
+ * writes and fdatasyncs in batches (group commit), and every N records writes
+ * a new snapshot (tmp + rename) and truncates the log.
+ * Startup recovery = snapshot, then every intact log record after its seq.
+ */
+class WalletJournal {
+public:
+    explicit WalletJournal(const std::string& basePath);
+    ~WalletJournal();
+
+    /**
+     * Rebuild balances from snapshot + log into `wallet` (call before start()).
+     * @return true if anything was on disk.
+     */
+    bool recover(Wallet& wallet);
+
+    // snapshot the wallet's current state, start the writer, attach to wallet
+    bool start(Wallet* wallet);
+
+    // detach, flush everything, write a final snapshot
+    void stop();
+
+    // called by Wallet (any thread)
+    // seq for one transaction change; take it under the asset's slot lock
+    uint64_t reserveSeq();
+    void appendTransaction(const WalletTransaction& tx);
+    void appendSet(AssetId id, int64_t totalRaw, int64_t lockedRaw);
+
+    /**
+     * Block until everything appended so far is on disk.
+     * @return false if the log can't be written right now (records stay
+     *         queued and are retried every group-commit interval).
+     */
+    bool flush();
+
+    void setGroupCommitInterval(std::chrono::milliseconds ms) { groupCommit_ = ms; }
+    void setSnapshotEvery(uint64_t records) { snapshotEvery_ = (records > 0 ? records : 1); }
+
+    uint64_t recordsWritten() const { return recordsWritten_.load(); }
+    uint64_t syncs() const { return syncs_.load(); }
+    uint64_t snapshots() const { return snapshots_.load(); }
+    uint64_t writeErrors() const { return writeErrors_.load(); }
+
+private:
+    // REC_TX: deltas without their own seq (logs from before REC_DELTA)
+    enum RecordType : uint8_t { REC_TX = 1, REC_SET = 2, REC_DELTA = 3 };
+
+    struct Entry {
+        AssetId asset;
+        int64_t a; // DELTA: delta total, SET: total
+        int64_t b; // DELTA: delta locked, SET: locked
+        uint64_t seq{0}; // DELTA: seq the change was written under
+    };
+
+    struct PendingRecord {
+        RecordType type;
+        uint64_t seq;
+        std::vector<Entry> entries;
+    };
+
+    struct Balance {
+        int64_t total{0};
+        int64_t locked{0};
+        uint64_t setSeq{0}; // last SET applied; older deltas are inside it
+        bool used{false};
+    };
+
+    static void applyEntry(Balance& b, RecordType type, uint64_t recSeq, const Entry& e);
+
+    void runWriter();
+    bool writeBatch(std::vector<PendingRecord>& batch);
+    bool writeSnapshot(uint64_t lastSeq);
+    bool openLog(bool truncate);
+    void closeLog();
+
+private:
+    std::string walPath_;
+    std::string snapPath_;
+    int walFd_{-1};
+
+    Wallet* wallet_{nullptr};
+
+    // appenders -> writer
+    std::mutex appendMutex_;
+    std::condition_variable appendCv_;
+    std::vector<PendingRecord> pending_;
+    uint64_t nextSeq_{1};
+    uint64_t lastQueuedSeq_{0}; // newest record seq (reserved seqs may never get one)
+    bool flushRequested_{false};
+
+    // writer -> flush()
+    std::mutex durableMutex_;
+    std::condition_variable durableCv_;
+    uint64_t durableSeq_{0};
+    bool writeFailed_{false}; // the last batch didn't make it to disk
+
+    // balances as of durableSeq_, owned by the writer thread (snapshot source)
+    std::vector<Balance> shadow_;
+    uint64_t sinceSnapshot_{0};
+
+    std::chrono::milliseconds groupCommit_{5};
+    uint64_t snapshotEvery_{1000};
+
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> recordsWritten_{0};
+    std::atomic<uint64_t> syncs_{0};
+    std::atomic<uint64_t> snapshots_{0};
+    std::atomic<uint64_t> writeErrors_{0};
+
+    std::thread writerThread_;
+};
+
+#endif // WALLET_JOURNAL_HPP
@@ -0,0 +1,85 @@
+#ifndef CYCLE_DETECTOR_HPP
+#define CYCLE_DETECTOR_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include "core/triangle.hpp"
+#include "engine/triangle_topology.hpp"
+#include "engine/edge_rate_table.hpp"
+
+/**
+ * A profitable N-leg route found by the detector (same path format as the
+ * BFS triangles: "SYM_FWD"/"SYM_INV" legs, base = starting asset).
+ */
+struct DetectedCycle {
+    Triangle route;
+    double profitPct{0.0}; // top-of-book, after fees
+};
+
+/**
+ * CycleDetector
+ * The market as a graph: asset -> asset per tradable direction, weight
+ * -log(rate * (1 - fee)) (the negated EdgeRateTable log rate, so fees are
+ * the same ones the triangles use). A route is profitable iff its weights
+ * sum below 0.
+ *
+ * onBookUpdate() refreshes the two edges of one symbol and only searches
+ * cycles through those edges: a hop-bounded Bellman-Ford (SPFA frontier, one
+ * distance row per hop count) from the edge's head back to its tail. Cycles
+ * are kept when they have minLegs..maxLegs legs and are simple; the default
+ * 4..5 covers what the triangle scanner can't see.
+ *
+ * Base selection and the quote whitelist follow TopologyOptions, so a found
+ * cycle starts at the same preferred asset a triangle would.
+ */
+class CycleDetector {
+public:
+    CycleDetector(int minLegs = 4, int maxLegs = 5, double minProfitPct = 0.0);
+
+    void build(const std::vector<TopologySymbol>& symbols, const TopologyOptions& options);
+
+    // new log rates (EdgeRateTable, UNPRICED allowed) for rawSymbol's two
+    // directions => profitable cycles through it (best first)
+    std::vector<DetectedCycle> onBookUpdate(const std::string& rawSymbol,
+                                            double fwdLogRate, double invLogRate);
+
+    int assetCount() const { return (int)assets_.size(); }
+    int edgeCount() const { return (int)edges_.size(); }
+
+private:
+    struct Edge {
+        int from;
+        int to;
+    };
+
+    void searchThrough(int edgeId, std::vector<DetectedCycle>& out,
+                       std::unordered_map<std::string, int>& seen);
+
+private:
+    int minLegs_;
+    int maxLegs_;
+    double maxWeight_;    // accept cycles whose weight is below this
+
+    std::mutex mutex_;    // one search at a time (scratch rows are shared)
+
+    std::vector<std::string> assets_;
+    std::vector<int> baseKey_;               // start preference, INT_MAX => never a base
+    std::vector<Edge> edges_;
+    std::vector<std::string> legNames_;      // per edge, "SYM_FWD"/"SYM_INV"
+    std::vector<double> weight_;             // per edge, +inf until priced
+    std::vector<int> offsets_;               // CSR: out-edges of asset a
+    std::vector<int> outEdges_;              //      are outEdges_[offsets_[a]..offsets_[a+1])
+    std::unordered_map<std::string, std::array<int, 2>> bySymbol_; // raw => {fwd, inv} edge (-1 if none)
+
+    // search scratch: row k = best k-hop distance / last edge
+    std::vector<double> dist_;
+    std::vector<int> pred_;
+    std::vector<int> frontier_, nextFrontier_;
+    std::vector<uint8_t> queued_;
+};
+
+#endif // CYCLE_DETECTOR_HPP
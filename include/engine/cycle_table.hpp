@@ -0,0 +1,65 @@
+#ifndef CYCLE_TABLE_HPP
+#define CYCLE_TABLE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "core/triangle.hpp"
+#include "engine/route_guard_table.hpp"
+
+/**
+ * CycleTable
+ * The 4/5-leg routes CycleDetector found, kept apart from the triangle
+ * topology: they come and go with the market, so they never join topo_ (or
+ * its cache). A fixed number of slots, the least recently seen route is
+ * evicted for a new one. While resident, a route's id is CYCLE_ID_BASE +
+ * its slot, and its cooldown/backoff live in guards() at the slot.
+ *
+ * A slot that is cooling down or parked is never evicted, so the timers
+ * that end those always find the route they were set for. (A route is only
+ * evicted after `capacity` newer ones were seen, so an attempt still on its
+ * way to the cooldown claim doesn't lose its slot in practice.)
+ */
+class CycleTable {
+public:
+    static constexpr int CYCLE_ID_BASE = 1 << 30; // above any topology id
+
+    static bool isCycleId(int id) { return id >= CYCLE_ID_BASE; }
+    static int slotOf(int id) { return id - CYCLE_ID_BASE; }
+
+    explicit CycleTable(int capacity = 1024);
+
+    /**
+     * Route id for the cycle named `key` (makeTriangleKey), inserting it
+     * over the least recently seen idle slot if it isn't resident.
+     * -1 => every slot is cooling down or parked.
+     */
+    int acquire(const std::string& key, const Triangle& route);
+
+    RouteGuardTable& guards() { return guards_; }
+
+    int capacity() const { return (int)slots_.size(); }
+    int size() const;
+    uint64_t evictions() const { return evictions_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::string key;
+        Triangle route;
+        uint64_t lastSeen{0};
+        bool used{false};
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Slot> slots_;
+    std::unordered_map<std::string, int> index_; // key => slot
+    uint64_t tick_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    RouteGuardTable guards_; // indexed by slot
+};
+
+#endif // CYCLE_TABLE_HPP
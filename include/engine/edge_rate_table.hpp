@@ -0,0 +1,85 @@
+#ifndef EDGE_RATE_TABLE_HPP
+#define EDGE_RATE_TABLE_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <unordered_map>
+
+/**
+ * Taker fee per symbol: the configured default, per-symbol overrides, and
+ * the BNB discount (fee * bnbDiscountFactor) when paying fees in BNB.
+ */
+struct FeeSchedule {
+    double defaultFee{0.001};
+    std::unordered_map<std::string, double> perSymbol;
+    bool bnbDiscount{false};
+    double bnbDiscountFactor{0.75};
+
+    double feeFor(const std::string& symbol) const {
+        auto it = perSymbol.find(symbol);
+        double fee = (it != perSymbol.end()) ? it->second : defaultFee;
+        return bnbDiscount ? fee * bnbDiscountFactor : fee;
+    }
+};
+
+/**
+ * EdgeRateTable
+ * One slot per symbol holding the log of what one unit of input returns on
+ * each direction, fee included:
+ *   FWD (sell base at bid):  log(bid) + log(1 - fee)
+ *   INV (buy base at ask):  -log(ask) + log(1 - fee)
+ * Edge id = slot * 2 + (INV ? 1 : 0). A route's log return is the sum of
+ * its edges, so every triangle on a symbol shares the one update.
+ *
+ * update() is lock-free (relaxed atomics, each edge is self-contained).
+ * addSymbol()/reset() change the slot set and must not race with readers;
+ * the scanner only calls them under its exclusive topology lock.
+ */
+class EdgeRateTable {
+public:
+    static constexpr double UNPRICED = -1e300; // log rate of an edge without a book
+
+    void setFees(const FeeSchedule& fees) { fees_ = fees; }
+    const FeeSchedule& fees() const { return fees_; }
+
+    void reset();
+    int addSymbol(const std::string& rawSymbol); // existing or new slot
+    int slotOf(const std::string& rawSymbol) const;
+
+    // "SYM_FWD" / "SYM_INV" / untagged (= FWD) => edge id, -1 if unknown
+    int edgeFor(const std::string& leg) const;
+
+    // false if both edges kept their value (same top of book) => nothing to propagate
+    bool update(int slot, double bestBid, double bestAsk);
+
+    double logRate(int edge) const {
+        const Slot& s = slots_[edge >> 1];
+        return ((edge & 1) ? s.inv : s.fwd).load(std::memory_order_relaxed);
+    }
+
+    // sum of log rates; UNPRICED-dominated (<= -1e299) if any edge has no book
+    double routeLogRate(const int* edges, size_t count) const {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; i++) sum += logRate(edges[i]);
+        return sum;
+    }
+
+    static bool priced(double logSum) { return logSum > -1e299; }
+
+    size_t size() const { return slots_.size(); }
+
+private:
+    struct Slot {
+        std::atomic<double> fwd{UNPRICED};
+        std::atomic<double> inv{UNPRICED};
+        double logFee{0.0}; // log(1 - fee), fixed at addSymbol()
+    };
+
+    FeeSchedule fees_;
+    std::deque<Slot> slots_; // deque: slots never move when one is added
+    std::unordered_map<std::string, int> bySymbol_;
+};
+
+#endif // EDGE_RATE_TABLE_HPP
@@ -0,0 +1,68 @@
+#ifndef INVENTORY_REBALANCER_HPP
+#define INVENTORY_REBALANCER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+/**
+ * One leg sized up-front for parallel dispatch
+ */
+struct LegPlan {
+    std::string symbol;        // raw exchange symbol, e.g. "ETHBTC"
+    std::string baseAsset;
+    std::string quoteAsset;
+    bool isSell{false};
+    double bestPx{0.0};
+    double inputAmt{0.0};      // spent: base if SELL, quote if BUY
+    double qtyBase{0.0};       // order quantity (base units)
+    double expectedOut{0.0};   // received after fees at bestPx
+
+    const std::string& input() const  { return isSell ? baseAsset : quoteAsset; }
+    const std::string& output() const { return isSell ? quoteAsset : baseAsset; }
+};
+
+/**
+ * A market order that moves one intermediate asset of a route back to its
+ * pre-trade level, placed on the symbol of route leg `leg`.
+ */
+struct RebalanceOrder {
+    size_t leg{0};
+    std::string symbol;
+    bool isSell{false};
+    double qtyBase{0.0};
+};
+
+/**
+ * InventoryRebalancer
+ * Legs fired in parallel are each sized off inventory, so their fills don't
+ * chain exactly: every asset between two legs ends up a little above or
+ * below where it started (step rounding, price moves between sizing and
+ * fill). The target is the pre-trade level of every intermediate asset;
+ * the route's start asset (leg 1's input) keeps the profit and absorbs
+ * what the correction costs.
+ *
+ * plan() walks the route from leg 1 and settles each intermediate asset on
+ * the next leg's symbol: a surplus is traded forward (the leg's own
+ * direction), a shortfall bought back (the opposite one). Whatever a
+ * correction moves lands on the next asset, which is settled in turn, so
+ * the last order ends in the start asset. Amounts are estimated at each
+ * leg's planned best price and fee.
+ */
+class InventoryRebalancer {
+public:
+    // rounds qtyBase in place for a leg's symbol and runs the exchange
+    // filters; false => too small to trade (that asset keeps its drift)
+    using QtyCheck = std::function<bool(const LegPlan& leg, double& qtyBase)>;
+
+    // drift: per asset, what it gained (+) or lost (-) over the route;
+    // out gets the orders in the order they must be placed
+    static void plan(const std::vector<LegPlan>& plans,
+                     const std::map<std::string, double>& drift,
+                     double feePercent,
+                     const QtyCheck& check,
+                     std::vector<RebalanceOrder>& out);
+};
+
+#endif // INVENTORY_REBALANCER_HPP
@@ -0,0 +1,122 @@
+#ifndef OPPORTUNITY_TRACKER_HPP
+#define OPPORTUNITY_TRACKER_HPP
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include "core/symbol_registry.hpp"
+#include "engine/trade_sizer.hpp"
+
+/**
+ * Lifecycle stages of one opportunity, in the order they're reached.
+ * LEG_1 + i is stamped when leg i+1 filled.
+ */
+enum class OppStage : int {
+    DETECT = 0,   // scanner saw the route above threshold
+    ESTIMATE,     // depth estimate came back profitable
+    COOLDOWN,     // passed the cooldown check
+    REFETCH,      // simulator re-read the books right before trading
+    RECHECK,      // re-estimate on the fresh books still profitable
+    LEG_1,
+    COUNT = LEG_1 + (int)MAX_ROUTE_LEGS
+};
+
+// how an opportunity ended
+enum class OppOutcome : int {
+    TRADED = 0,
+    UNPROFITABLE,    // depth estimate negative
+    BELOW_MIN,       // profitable, but under the USDT floor
+    COOLDOWN,        // same route tried too recently
+    TORN_BOOKS,      // no consistent view of the legs' books
+    EMPTY_BOOK,      // a leg's fresh book was empty
+    RECHECK_FAIL,    // fresh books no longer profitable / fillable
+    LEG_FAIL,        // a leg failed (earlier legs reversed)
+    BAD_ROUTE,
+    ABANDONED,       // a new opportunity began before this one finished
+    COUNT
+};
+
+const char* oppStageName(OppStage s);
+const char* oppOutcomeName(OppOutcome o);
+
+// the simulator's failReason strings => outcome
+OppOutcome oppOutcomeFromFailReason(const std::string& failReason);
+
+/**
+ * Aggregate over finished opportunities: how each ended, and per stage how
+ * many reached it and the time from detection to it (ns).
+ */
+struct OppStats {
+    uint64_t opportunities{0};
+    uint64_t outcomes[(int)OppOutcome::COUNT]{};
+    uint64_t reached[(int)OppStage::COUNT]{};
+    uint64_t latencySumNs[(int)OppStage::COUNT]{};
+    uint64_t latencyMaxNs[(int)OppStage::COUNT]{};
+
+    // share of opportunities that traded, 0..1
+    double conversion() const {
+        return opportunities ? (double)outcomes[(int)OppOutcome::TRADED] / opportunities : 0.0;
+    }
+    double meanLatencyMs(OppStage s) const {
+        return reached[(int)s] ? latencySumNs[(int)s] / 1e6 / reached[(int)s] : 0.0;
+    }
+    void add(const OppStats& o);
+};
+
+/**
+ * OpportunityTracker
+ * Every detection that goes on to a depth estimate gets an id; the stages
+ * it reaches are timestamped and, when it ends, it's folded into per-route
+ * (topology id) and per-trigger-symbol tables.
+ *
+ * The open opportunity is per thread: the scanner thread that detected it
+ * runs the estimate, cooldown and trade synchronously, so the simulator just
+ * calls stamp() with no id threaded through. begin/stamp never lock; finish
+ * takes the table mutex once.
+ */
+class OpportunityTracker {
+public:
+    static OpportunityTracker& instance();
+
+    // new opportunity on this thread; returns its id
+    uint64_t begin(int routeId, SymbolId trigger);
+    // stage reached by this thread's open opportunity (no-op if none)
+    void stamp(OppStage stage);
+    void stampLeg(size_t legIndex);
+    // close this thread's open opportunity
+    void finish(OppOutcome outcome);
+
+    // query (false if nothing finished for that key yet)
+    bool routeStats(int routeId, OppStats& out) const;
+    bool symbolStats(SymbolId symbol, OppStats& out) const;
+    OppStats totals() const;
+
+    // dashboard lines: totals, conversion, failures by outcome, mean ms per stage
+    void printSummary(std::ostream& os) const;
+
+    // total, per-route and per-symbol rows: outcome counts + mean ms per stage (overwrites `path`)
+    bool exportCSV(const std::string& path) const;
+
+private:
+    OpportunityTracker() = default;
+
+    struct Open {
+        uint64_t id{0};
+        int routeId{-1};
+        SymbolId trigger{INVALID_SYMBOL};
+        int64_t stampNs[(int)OppStage::COUNT]{}; // 0 => not reached
+    };
+    static Open& current();
+
+    std::atomic<uint64_t> nextId_{1};
+
+    mutable std::mutex mutex_;
+    OppStats totals_;
+    std::unordered_map<int, OppStats> byRoute_;
+    std::unordered_map<SymbolId, OppStats> bySymbol_;
+};
+
+#endif // OPPORTUNITY_TRACKER_HPP
@@ -0,0 +1,194 @@
+#ifndef ROUTE_GUARD_TABLE_HPP
+#define ROUTE_GUARD_TABLE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * RouteGuardTable
+ * Cooldown and failure backoff per route, indexed by topology id. Entries
+ * live in fixed-size chunks that are allocated once and never move, so a
+ * growing topology (reserve) never invalidates a reader; every field is an
+ * atomic, so the scan/execute threads never take a lock:
+ *  - cooldown: a flag claimed with one exchange per attempt; the owner
+ *    clears it (endCooldown) from a timer, so no clock is read here
+ *  - backoff: a penalty level per route. Each failure past the first
+ *    freeFails raises it and blocks the route for base * 2^(level-freeFails-1)
+ *    (capped); a success halves it, and every decay period without a
+ *    failure takes one level off. Quiet time starts when the backoff ends:
+ *    time spent blocked (parked) isn't time the route proved itself.
+ *  - parked: set while the route is out of the scan set (the owner takes it
+ *    out on a backoff and puts it back when the backoff ends); isParked() is
+ *    one load, no clock.
+ * Backoff times are steady_clock nanoseconds (nowNs()).
+ */
+class RouteGuardTable {
+public:
+    static constexpr int MAX_LEVEL = 16;              // penalty level cap
+    static constexpr int CHUNK = 4096;                // entries per chunk
+    static constexpr int MAX_CHUNKS = 1024;           // => up to 4M route ids
+
+    struct BackoffPolicy {
+        int freeFails{2};               // failures absorbed before any backoff
+        int64_t baseNs{30000000000LL};  // first backoff
+        int64_t maxNs{1800000000000LL}; // backoff cap
+        int64_t decayNs{60000000000LL}; // one level forgiven per quiet period
+    };
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    ~RouteGuardTable() {
+        for (auto& c : chunks_) delete[] c.load(std::memory_order_relaxed);
+    }
+
+    // make ids [0, n) addressable
+    void reserve(int n) {
+        std::lock_guard<std::mutex> lk(growMutex_);
+        int need = std::min((n + CHUNK - 1) / CHUNK, MAX_CHUNKS);
+        for (int c = 0; c < need; c++) {
+            if (!chunks_[c].load(std::memory_order_relaxed)) {
+                chunks_[c].store(new Entry[CHUNK], std::memory_order_release);
+            }
+        }
+    }
+
+    // forget one route's history (its id now names another route)
+    void reset(int id) {
+        Entry* e = entry(id);
+        if (e) e->reset();
+    }
+
+    // forget every route's history (ids were reassigned by a rebuild)
+    void clear() {
+        std::lock_guard<std::mutex> lk(growMutex_);
+        for (auto& c : chunks_) {
+            Entry* e = c.load(std::memory_order_relaxed);
+            for (int i = 0; e && i < CHUNK; i++) e[i].reset();
+        }
+    }
+
+    /**
+     * true => caller may attempt the route now, and it's on cooldown until
+     * endCooldown(id); false => still cooling down from an earlier attempt.
+     * Unknown ids are never on cooldown.
+     */
+    bool tryBeginAttempt(int id) {
+        Entry* e = entry(id);
+        return !e || !e->coolingDown.exchange(true, std::memory_order_acq_rel);
+    }
+
+    void endCooldown(int id) {
+        Entry* e = entry(id);
+        if (e) e->coolingDown.store(false, std::memory_order_release);
+    }
+
+    bool isCoolingDown(int id) const {
+        const Entry* e = entry(id);
+        return e && e->coolingDown.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Failure at `now` => raises the route's level (after decay) and returns
+     * how long it's blocked for (0 => still within freeFails).
+     * Attempts on one route are serialized by the cooldown, so updates to
+     * one entry don't race in practice; a lost update only costs one level.
+     */
+    int64_t recordFailure(int id, int64_t now, const BackoffPolicy& p) {
+        Entry* e = entry(id);
+        if (!e) return 0;
+        int level = decayedLevel(*e, now, p);
+        level = std::min(level + 1, MAX_LEVEL);
+        e->level.store(level, std::memory_order_relaxed);
+        e->lastFailNs.store(now, std::memory_order_relaxed);
+        if (level <= p.freeFails) return 0;
+
+        int shift = std::min(level - p.freeFails - 1, 40);
+        int64_t backoff = (p.baseNs > (p.maxNs >> shift)) ? p.maxNs : (p.baseNs << shift);
+        backoff = std::min(backoff, p.maxNs);
+        int64_t until = now + backoff;
+        int64_t cur = e->blockedUntilNs.load(std::memory_order_relaxed);
+        while (cur < until &&
+               !e->blockedUntilNs.compare_exchange_weak(cur, until, std::memory_order_relaxed)) {}
+        return backoff;
+    }
+
+    // a trade went through => half the penalty is forgiven at once
+    void recordSuccess(int id, int64_t now, const BackoffPolicy& p) {
+        Entry* e = entry(id);
+        if (!e) return;
+        e->level.store(decayedLevel(*e, now, p) / 2, std::memory_order_relaxed);
+    }
+
+    int level(int id) const {
+        const Entry* e = entry(id);
+        return e ? e->level.load(std::memory_order_relaxed) : 0;
+    }
+
+    int64_t blockedUntil(int id) const {
+        const Entry* e = entry(id);
+        return e ? e->blockedUntilNs.load(std::memory_order_relaxed) : 0;
+    }
+
+    // true => this call parked it (false: already parked / unknown id)
+    bool park(int id) {
+        Entry* e = entry(id);
+        return e && !e->parked.exchange(true, std::memory_order_acq_rel);
+    }
+
+    // true => this call unparked it
+    bool unpark(int id) {
+        Entry* e = entry(id);
+        return e && e->parked.exchange(false, std::memory_order_acq_rel);
+    }
+
+    bool isParked(int id) const {
+        const Entry* e = entry(id);
+        return e && e->parked.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry {
+        std::atomic<bool> coolingDown{false};
+        std::atomic<int64_t> blockedUntilNs{0};
+        std::atomic<int64_t> lastFailNs{0};
+        std::atomic<int> level{0};
+        std::atomic<bool> parked{false};
+
+        void reset() {
+            coolingDown.store(false, std::memory_order_relaxed);
+            blockedUntilNs.store(0, std::memory_order_relaxed);
+            lastFailNs.store(0, std::memory_order_relaxed);
+            level.store(0, std::memory_order_relaxed);
+            parked.store(false, std::memory_order_relaxed);
+        }
+    };
+
+    // level after the quiet time since the last failure's backoff ended
+    static int decayedLevel(const Entry& e, int64_t now, const BackoffPolicy& p) {
+        int level = e.level.load(std::memory_order_relaxed);
+        int64_t last = std::max(e.lastFailNs.load(std::memory_order_relaxed),
+                                e.blockedUntilNs.load(std::memory_order_relaxed));
+        if (level > 0 && last != 0 && p.decayNs > 0 && now > last) {
+            int64_t steps = (now - last) / p.decayNs;
+            level = (steps >= level) ? 0 : level - (int)steps;
+        }
+        return level;
+    }
+
+    Entry* entry(int id) const {
+        if (id < 0 || id >= CHUNK * MAX_CHUNKS) return nullptr;
+        Entry* c = chunks_[id / CHUNK].load(std::memory_order_acquire);
+        return c ? &c[id % CHUNK] : nullptr;
+    }
+
+    std::atomic<Entry*> chunks_[MAX_CHUNKS]{};
+    std::mutex growMutex_;
+};
+
+#endif // ROUTE_GUARD_TABLE_HPP
@@ -7,22 +7,22 @@
 #include <mutex>
 #include <vector>
 #include <unordered_map>
+#include <atomic>
+#include <memory>
 
 #include "core/triangle.hpp"
 #include "core/orderbook.hpp"
 #include "core/wallet.hpp"
+#include "core/symbol_registry.hpp"
+#include "core/asset_registry.hpp"
+#include "core/thread_pool.hpp"
 #include "exchange/i_exchange_executor.hpp"
+#include "engine/trade_sizer.hpp"
+#include "engine/inventory_rebalancer.hpp"
 
 /**
- * Represents the minNotional / minQty filters for a given symbol.
- */
-struct SymbolFilter {
-    double minNotional; // e.g. 10.0
-    double minQty;      // e.g. 0.0001
-};
-
-/**
- * parseSymbol => extracts base vs quote from a symbol string
+ * parseSymbol => extracts base vs quote from a symbol string (known-quote
+ * suffix). Only a fallback for symbols without exchangeInfo.
  */
 std::pair<std::string,std::string> parseSymbol(const std::string& pair);
 
@@ -41,6 +41,36 @@ struct ReversibleLeg {
     double filledQtyBase { 0.0 };   // how much base was filled
 };
 
+/**
+ * One path entry resolved against the registries: what the leg trades and
+ * which way (SELL spends base for quote, BUY spends quote for base).
+ */
+struct RouteLeg {
+    SymbolId symbol{INVALID_SYMBOL};
+    AssetId base{INVALID_ASSET};
+    AssetId quote{INVALID_ASSET};
+    bool isSell{false};
+
+    AssetId input() const  { return isSell ? base : quote; }
+    AssetId output() const { return isSell ? quote : base; }
+};
+
+/**
+ * The distinct assets of a route (sorted by id = lock order) with their
+ * USDT prices captured once, so before/after values use the same prices.
+ */
+struct RouteAssets {
+    size_t count{0};
+    AssetId id[MAX_ROUTE_LEGS + 1];
+    double usdtPx[MAX_ROUTE_LEGS + 1];
+
+    double value(const Wallet& wallet) const {
+        double v = 0.0;
+        for (size_t k = 0; k < count; k++) v += wallet.getFreeBalance(id[k]) * usdtPx[k];
+        return v;
+    }
+};
+
 /**
  * Depth-aware simulator with optional live trades.
  * Includes concurrency methods for multi-triangle simulation.
@@ -62,6 +92,10 @@ public:
 
     void setLiveMode(bool live) { liveMode_ = live; }
 
+    // live only: fire all legs concurrently when inventory covers each leg
+    // (on the simulator's leg pool, started the first time this is switched on)
+    void setParallelLegs(bool on);
+
     /**
      * The main "atomic" trading function. If it detects negative or insufficient profit,
      * it skips. If any leg fails, it rolls back the entire local wallet transaction.
@@ -77,6 +111,13 @@ public:
                                       const OrderBookData& ob3,
                                       std::string* failReason = nullptr); // NEW overload
 
+    /**
+     * Same for a route of any length (path.size() legs, books[i] for path[i]).
+     */
+    bool simulateCycleDepthWithWallet(const Triangle& tri,
+                                      const std::vector<OrderBookData>& books,
+                                      std::string* failReason = nullptr);
+
     /**
      * Old signature for backward compatibility. Internally calls the new one without failReason.
      */
@@ -86,14 +127,20 @@ public:
                                       const OrderBookData& ob3);
 
     /**
-     * Offline profitability check. Loops through partial fills on each OB,
-     * returns final net profit in USDT or -1 if fail.
+     * Offline profitability check. Sizes the trade with TradeSizer (joint walk
+     * of the legs' depth ladders), replays it on a scratch portfolio of the
+     * route's assets and returns the net profit in USDT (UsdtValuation) at
+     * the optimal size, or -1 if no size is profitable.
      */
     double estimateTriangleProfitUSDT(const Triangle& tri,
                                       const OrderBookData& ob1,
                                       const OrderBookData& ob2,
                                       const OrderBookData& ob3);
 
+    // N-leg version (books[i] for path[i])
+    double estimateCycleProfitUSDT(const Triangle& tri,
+                                   const std::vector<OrderBookData>& books);
+
     /**
      * Legacy leftover, not used now
      */
@@ -103,14 +150,44 @@ public:
                          double bid2, double ask2,
                          double bid3, double ask3);
 
+    /**
+     * Ask the executor to pre-build/pre-sign the orders for each leg of `tri`,
+     * so a later execution only patches quantity + timestamp. Live mode only.
+     */
+    void prestageTriangle(const Triangle& tri);
+
     void printWallet() const;
 
     int getTotalTrades() const;
     double getCumulativeProfit() const;
 
-    // concurrency to estimate many triangles
+    // how many orders each exchange filter rejected (dashboard)
+    uint64_t getFilterRejects(FilterReject r) const {
+        return filterRejects_[(int)r].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Batch depth check: out[k] = { ids[k], estimated USDT profit of
+     * routes[ids[k]] } for k < count, every route priced from the same
+     * `books` snapshot. The candidates are split into chunks of chunkSize
+     * and evaluated on `pool` (bounded workers, never a thread per route);
+     * out must hold count entries and is the only thing written.
+     * -999 => route doesn't resolve or misses a book, -1 => unprofitable.
+     * Blocks until done, so don't call it from one of pool's own tasks.
+     */
+    void simulateBatch(const std::vector<Triangle>& routes,
+                       const int* ids,
+                       size_t count,
+                       const BookSnapshot& books,
+                       ThreadPool& pool,
+                       SimCandidate* out,
+                       size_t chunkSize = 256);
+
+    // concurrency to estimate many triangles (executor books, simulateBatch
+    // on the caller's long-lived pool)
     std::vector<SimCandidate> simulateMultipleTrianglesConcurrently(
-        const std::vector<Triangle>& triangles);
+        const std::vector<Triangle>& triangles,
+        ThreadPool& pool);
 
     // optionally run real trades in sequence for the best N
     void executeTopCandidatesSequentially(const std::vector<Triangle>& triangles,
@@ -127,14 +204,52 @@ public:
 private:
     // internal leg logic, either local or real
     bool doLeg(WalletTransaction& tx,
-        const std::string& pairName,
+        const RouteLeg& leg,
         const OrderBookData& ob,
-        ReversibleLeg* reversalOut = nullptr);
+        ReversibleLeg* reversalOut = nullptr,
+        double sizedQtyBase = 0.0); // > 0 => optimizer's quantity, else fraction of balance
 
     bool doLegLive(WalletTransaction& tx,
-                   const std::string& pairName,
+                   const RouteLeg& leg,
                    double desiredQtyBase,
-                   bool isSell);
+                   double refPrice);
+
+    bool applyLiveFill(WalletTransaction& tx,
+                       const std::string& pairName,
+                       const std::string& baseAsset,
+                       const std::string& quoteAsset,
+                       bool isSell,
+                       double desiredQtyBase,
+                       const OrderResult& res,
+                       double latencyMs);
+
+    // parallel dispatch for independent legs
+    bool planIndependentLegs(const RouteLeg* legs,
+                             size_t legCount,
+                             const std::vector<OrderBookData>& books,
+                             std::vector<LegPlan>& plans,
+                             const SizedRoute* sized = nullptr);
+    bool executeLegsParallel(WalletTransaction& tx,
+                             const std::vector<LegPlan>& plans,
+                             std::string* failReason);
+    // after a parallel run: trade intermediate assets back to their pre-trade levels
+    void rebalanceInventory(WalletTransaction& tx,
+                            const std::vector<LegPlan>& plans,
+                            const std::map<std::string, double>& drift);
+
+    // optimal size for a route (leg 1 capped at maxFractionPerTrade_ of free balance);
+    // books[i] is leg i's book
+    bool sizeRoute(const RouteLeg* legs,
+                   size_t legCount,
+                   const OrderBookData* const* books,
+                   SizedRoute& sized);
+    double estimateSizedProfitUSDT(const RouteLeg* legs,
+                                   size_t legCount,
+                                   const OrderBookData* const* books,
+                                   SizedRoute& sized);
+
+    // one batch candidate: resolve, look its books up in the snapshot, estimate
+    double estimateSnapshotProfitUSDT(const Triangle& tri, const BookSnapshot& books);
 
     void logTrade(const std::string& path,
                   double startVal,
@@ -148,11 +263,27 @@ private:
                 double slipPct,
                 double latencyMs);
 
-    std::vector<std::string> getAssetsForPair(const std::string& pairName) const;
+    // path entry => symbol/assets/side; untagged legs spend `from`
+    bool resolveLeg(const std::string& leg, AssetId from, RouteLeg& out) const;
+    // whole path into legs[MAX_ROUTE_LEGS]; false unless it chains back to the start
+    bool resolveRoute(const Triangle& tri, RouteLeg* legs) const;
+    void collectRouteAssets(const RouteLeg* legs, size_t legCount, RouteAssets& out) const;
     void loadSymbolFilters(const std::string& path);
-    bool passesExchangeFilters(const std::string& symbol,
-                               double quantityBase,
-                               double priceEstimate);
+    // countReject => a reject shows in filterRejects_ (order paths only)
+    bool passesExchangeFilters(SymbolId id,
+                               int64_t qtyRaw,
+                               double priceEstimate,
+                               bool countReject = true);
+
+    // floor quantityBase to the symbol's step (in place) and run the filters
+    bool roundAndCheckQty(const std::string& symbol,
+                          double& quantityBase,
+                          double priceEstimate,
+                          bool countReject = true);
+    bool roundAndCheckQty(SymbolId id,
+                          double& quantityBase,
+                          double priceEstimate,
+                          bool countReject = true);
 
 private:
     std::string logFileName_;
@@ -164,18 +295,21 @@ private:
     Wallet* wallet_;
     IExchangeExecutor* executor_;
     bool liveMode_{false};
+    bool parallelLegs_{false};
+    // one worker per leg of the longest route; lives as long as the simulator
+    // so a parallel trade never waits on thread creation
+    std::unique_ptr<ThreadPool> legPool_;
 
     double minProfitUSDT_;
 
-    static std::map<std::string, std::mutex> assetLocks_;
+    static std::mutex assetLocks_[AssetRegistry::MAX_ASSETS]; // by AssetId
 
     int totalTrades_{0};
     double cumulativeProfit_{0.0};
 
     void reverseRealLeg(const ReversibleLeg& leg);
 
-    // symbol -> filter
-    std::unordered_map<std::string, SymbolFilter> symbolFilters_;
+    std::atomic<uint64_t> filterRejects_[(int)FilterReject::COUNT] {};
 };
 
 #endif // SIMULATOR_HPP
@@ -0,0 +1,63 @@
+#ifndef TRADE_SIZER_HPP
+#define TRADE_SIZER_HPP
+
+#include <cstddef>
+#include "core/orderbook.hpp"
+
+// longest route the sizer/simulator handle (triangles + detected 4/5-leg cycles)
+constexpr size_t MAX_ROUTE_LEGS = 8;
+
+/**
+ * One leg as the sizer sees it: the book side we'd hit, the taker fee
+ * (same model as the simulator: sells receive cost*(1-fee), buys pay
+ * cost*(1+fee)) and how far from best price we're willing to walk.
+ */
+struct SizerLeg {
+    const OrderBookData* book{nullptr};
+    bool isSell{false};
+    double fee{0.0};
+    double maxSlip{1.0}; // levels priced further than this (fraction) from best are ignored
+};
+
+/**
+ * Optimal route size: amounts are in each leg's input/output asset, input
+ * and output of the whole route are in leg 1's input asset. Fixed-size so
+ * sizing a candidate never allocates.
+ */
+struct SizedRoute {
+    bool ok{false};                          // some size is profitable
+    size_t legs{0};
+    double input{0.0};                       // profit-maximizing amount fed to leg 1
+    double output{0.0};                      // what the route returns for it
+    double profit{0.0};                      // output - input
+    double legInput[MAX_ROUTE_LEGS]{};       // per leg: spent (base if SELL, quote if BUY)
+    double legOutput[MAX_ROUTE_LEGS]{};      // per leg: received after fees
+    double legQtyBase[MAX_ROUTE_LEGS]{};     // per leg: order quantity in base units
+};
+
+/**
+ * TradeSizer
+ * Each leg is a piecewise-linear, concave map input -> output: one segment
+ * per depth level (capacity in input units, rate = output per input, fee
+ * included), rates falling as the book is walked. Composing the legs keeps
+ * that shape, so the route's profit output(x) - x is concave and peaks where
+ * the composed marginal rate drops to 1.
+ *
+ * optimize() merges the ladders pairwise (two-pointer walk over segment
+ * breakpoints, O(levels) per leg) and stops each merge as soon as the
+ * remaining legs' best rates can't lift a segment above 1, so the cost is
+ * bounded by the profitable depth, not the book size. Scratch buffers are
+ * thread_local and keep their capacity: after warm-up no call allocates,
+ * and it is safe from the simulator's worker threads.
+ */
+class TradeSizer {
+public:
+    // maxInput caps leg 1's input (e.g. tradable balance), <= 0 => depth only;
+    // count <= MAX_ROUTE_LEGS
+    static bool optimize(const SizerLeg* legs, size_t count, double maxInput, SizedRoute& out);
+
+    // route output for a given leg-1 input; fills the per-leg amounts of `out` if given
+    static double walk(const SizerLeg* legs, size_t count, double input, SizedRoute* out = nullptr);
+};
+
+#endif // TRADE_SIZER_HPP
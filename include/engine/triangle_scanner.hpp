@@ -7,25 +7,23 @@
 #include <future>
 #include <mutex>
 #include <map>
-#include <queue>
 #include <chrono>
+#include <memory>
+#include <shared_mutex>
+#include <atomic>
 #include "core/thread_pool.hpp"
+#include "core/indexed_max_heap.hpp"
 #include "core/triangle.hpp"
+#include "engine/triangle_topology.hpp"
+#include "engine/cycle_detector.hpp"
+#include "engine/cycle_table.hpp"
+#include "engine/edge_rate_table.hpp"
+#include "engine/route_guard_table.hpp"
+#include "exchange/exchange_info_cache.hpp"
 
 class OrderBookManager;
 class Simulator;
-
-/**
- * We'll store a simple structure for our priority queue
- */
-struct TriPriority {
-    double profit;
-    int triIdx; // index into triangles_ vector
-    // Priority queue: we want largest 'profit' on top
-    bool operator<(const TriPriority& other) const {
-        return profit < other.profit;
-    }
-};
+struct SimCandidate;
 
 /**
  * A simple structure for exporting top triangles
@@ -39,13 +37,19 @@ struct ScoredTriangle {
 /**
  * TriangleScanner
  * - Loads triangles either from file or /exchangeInfo
- * - BFS-based approach to build them
+ * - BFS-based approach to build them (TriangleTopology, cached on disk and
+ *   updated incrementally when listings change)
  * - Scans them when a symbol's orderbook updates
- * - Maintains a priority queue of best-profit triangles
+ * - Maintains an indexed max-heap of best-profit triangles
  * - Tracks last-known profit for each triangle
  *
  * Now includes:
  * - A cooldown to avoid spamming the same triangle repeatedly.
+ * - Exponential backoff for routes that keep failing (both per topology
+ *   id, lock-free, see RouteGuardTable). A backed-off route is parked: it
+ *   leaves bestTriangles_ and the per-symbol scans skip it until a timer
+ *   puts it back. Cooldown ends and reinstatements run on TimerService,
+ *   so the scan/execute path reads flags, not the clock.
  */
 class TriangleScanner {
 public:
@@ -57,28 +61,48 @@ public:
     void loadTrianglesFromFile(const std::string& filepath);
 
     // Dynamically fetch from Binance exchangeInfo => BFS-based approach
+    // (served from the on-disk cache while it's fresh)
     bool loadTrianglesFromBinanceExchangeInfo();
 
+    // cache file + TTL for exchangeInfo (call before loading)
+    void setExchangeInfoCache(const std::string& path, int ttlSec);
+
+    // re-download exchangeInfo in the background, apply changes when the hash differs
+    void startExchangeInfoRefresh(int intervalSec);
+
+    // where the discovered topology is persisted ("" => always rebuild)
+    void setTopologyCache(const std::string& path) { topologyCachePath_ = path; }
+
+    // rotation/whitelist rules for discovery (call before loading)
+    void setTopologyOptions(const TopologyOptions& opts) { topoOptions_ = opts; }
+
+    // also look for minLegs..maxLegs cycles on each book update (call before
+    // loading); up to maxCycles found routes are tracked at a time
+    void enableCycleDetection(int minLegs, int maxLegs, int maxCycles = 1024);
+
     // Called by OrderBookManager or user to re-check a symbol
     void scanTrianglesForSymbol(const std::string& symbol);
 
     // Full concurrency scanning
     void scanAllSymbolsConcurrently();
 
-    // Single-triangle naive profit check
+    // Single-route top-of-book profit (%), from the shared edge log rates
     double calculateProfit(const Triangle& tri);
 
+    // taker fees used for the edge rates (call before loading)
+    void setFeeSchedule(const FeeSchedule& fees) { rates_.setFees(fees); }
+
     void setMinProfitThreshold(double thresh) { minProfitThreshold_ = thresh; }
     void setSimulator(Simulator* sim) { simulator_ = sim; }
 
-    // For partial usage from existing code: get the current best triangle from the priority queue
+    // current best triangle: lock-free read of the heap's published top
     bool getBestTriangle(double& outProfit, Triangle& outTri);
 
     /**
-     * Re-check all discovered triangles in parallel, store results in bestTriangles_, 
-     * optionally also return a sorted vector for the user.
+     * Re-score all discovered triangles from the edge rates and re-key them in
+     * bestTriangles_, optionally also return a sorted vector for the user.
      * 
-     * @param minProfitPct: skip updating bestTriangles_ for triangles below this profit
+     * @param minProfitPct: only triangles above this profit go to outSorted
      * @param outSorted: if non-null, we fill it with all triangles above minProfit, sorted desc
      */
     void rescoreAllTrianglesConcurrently(
@@ -96,13 +120,37 @@ public:
                                int topN,
                                double minProfitPct=0.0);
 
+    /**
+     * Pre-stage orders for the top-K entries of bestTriangles_ so their
+     * legs are already built/signed when an opportunity fires.
+     */
+    void prestageTopTriangles(int topK);
+
+    /**
+     * Depth-check the top-K entries of bestTriangles_ as one batch: their
+     * books are snapshotted together and the routes evaluated in chunks on
+     * pool_. out[k] = { topology id, estimated USDT profit }, heap order.
+     */
+    void simulateTopTriangles(int topK, std::vector<SimCandidate>& out);
+
     // NEW: set the cooldown in seconds for each triangle
     void setTriangleCooldownSeconds(double secs) { triangleCooldownSeconds_ = secs; }
 
+    // failures absorbed before backing off, first/max backoff, one level forgiven per decaySec
+    void setFailureBackoff(int freeFails, double baseSec, double maxSec, double decaySec);
+
+    // routes currently out of the scan set
+    int parkedRouteCount() const { return parkedCount_.load(std::memory_order_relaxed); }
+
+    // a route only triggers while every leg's book is at most this old (0 => no gate)
+    void setMaxBookAgeMs(double ms) { maxBookAgeNs_ = (int64_t)(ms * 1e6); }
+
+    // above-threshold routes passed over because a leg's book was too old
+    uint64_t getStaleSkips() const { return staleSkips_.load(std::memory_order_relaxed); }
+
 private:
-    // BFS-based approach
-    void buildTrianglesBFS(const std::unordered_map<std::string,
-                         std::vector<std::pair<std::string,std::string>>>& adjacency);
+    // cache hit => as-is, changed universe => incremental update, else full BFS
+    void loadTopology(const std::vector<TopologySymbol>& symbols);
 
     void logScanResult(const std::string& symbol,
                        int triCount,
@@ -110,24 +158,41 @@ private:
                        double latencyMs);
 
     void updateTrianglePriority(int triIdx, double profit);
+    void updateTrianglePriorities(const int* triIdx, const double* profit, int count);
+
+    // estimate => cooldown => trade, for a route of any length (routeId < 0 => untracked)
+    void tryExecuteRoute(int routeId, const Triangle& tri);
+    void scanLongCyclesForSymbol(const std::string& symbol, double fwdLogRate, double invLogRate);
+
+    // resolve edge ids for topology ids not mapped yet (exclusive topo lock held)
+    void syncRouteEdges();
+    // sum of the route's edge log rates => % (shared topo lock held)
+    double routeProfitPct(int triIdx) const;
+    // every leg's book updated within maxBookAgeNs_ of nowNs (shared topo lock held)
+    bool routeIsFresh(int triIdx, int64_t nowNs) const;
+    bool symbolsFresh(const std::vector<SymbolId>& syms, int64_t nowNs) const;
+
+    void applyUniverseRefresh(const ExchangeUniverse& uni);
 
     std::string makeTriangleKey(const Triangle& tri) const;
 
     // -----------------------------------------------------------------------
-    // NEW: Data + methods for blacklisting repeated failures
+    // NEW: Data + methods for backing off repeated failures
     // -----------------------------------------------------------------------
 private:
-    // track # of recent fails for each triangle
-    std::unordered_map<std::string, std::vector<std::chrono::steady_clock::time_point>> failTimestamps_;  // NEW
-    int maxFailsInWindow_{3};    // e.g. 3 fails in the last 60s => blacklisted  // NEW
-    double failWindowSec_{60.0}; // e.g. 60s time window                        // NEW
-    std::mutex failMutex_;       // for concurrent writes to failTimestamps_    // NEW
+    RouteGuardTable::BackoffPolicy backoff_;
 
-    // Record a failure for tri => push back current time, prune old entries   // NEW
-    void recordFailure(const Triangle& tri, const std::string& reason);        // NEW
+    // cycle ids => cycles_'s guards at their slot, else routeGuards_ at the id
+    RouteGuardTable& guardsFor(int routeId, int& idx);
 
-    // Check if a triangle is currently blacklisted (exceeded fail threshold)  // NEW
-    bool isBlacklisted(const Triangle& tri);                                   // NEW
+    // Record a failure for route id => raise its backoff (parking it if due), log reason
+    void recordFailure(int routeId, const Triangle& tri, const std::string& reason);
+
+    // out of bestTriangles_ + scans for backoffNs; a park timer brings it back
+    void parkRoute(int routeId, int64_t backoffNs);
+    void reinstateRoute(int routeId, uint64_t generation);
+    // forget cooldowns + parked routes; their pending timers become no-ops (ids were reassigned)
+    void resetRouteGuards();
 
     // Log each failure reason to a CSV for debugging
     void logFailure(const Triangle& tri, const std::string& reason);           // NEW
@@ -135,12 +200,25 @@ private:
 
 private:
     OrderBookManager* obm_{nullptr};
-    std::vector<Triangle> triangles_;
 
-    // Reverse index: symbol => which triangles reference that symbol
-    std::unordered_map<std::string, std::vector<int>> symbolToTriangles_;
+    // Triangles + reverse index (raw symbol => triangle ids). Readers take a
+    // shared lock; a listing refresh takes it exclusively. Lock order:
+    // topoMutex_ before bestTriMutex_.
+    TriangleTopology topo_;
+    mutable std::shared_mutex topoMutex_;
+    std::string topologyCachePath_{"config/topology.cache"};
+    TopologyOptions topoOptions_;
+
+    // per-symbol log rates (fees folded in) + each route's edge ids, by topology id
+    EdgeRateTable rates_;
+    std::vector<std::vector<int>> routeEdges_;
+    std::vector<std::vector<SymbolId>> routeSymbols_; // legs' books, by topology id
+    std::unique_ptr<CycleDetector> cycleDetector_; // null => triangles only
+    std::unique_ptr<CycleTable> cycles_;           // its routes (not in topo_), with cycleDetector_
 
     double minProfitThreshold_{0.0};
+    int64_t maxBookAgeNs_{0};
+    std::atomic<uint64_t> staleSkips_{0};
     ThreadPool pool_{4};
     Simulator* simulator_{nullptr};
 
@@ -148,17 +226,23 @@ private:
     std::mutex scanLogMutex_;
     bool scanLogHeaderWritten_{false};
 
-    // Track last-known profit for each triangle
-    std::vector<double> lastProfits_;
-
-    // Priority queue of TriPriority items
-    std::priority_queue<TriPriority> bestTriangles_;
+    // last-known profit per live triangle id, max on top; bestTriMutex_
+    // serializes writers, the top itself is readable without it
+    IndexedMaxHeap bestTriangles_;
     std::mutex bestTriMutex_;
 
     // COOL DOWN
     double triangleCooldownSeconds_{10.0}; // e.g. 10s default
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastAttemptMap_;
-    std::mutex cooldownMutex_;
+
+    // cooldown + backoff per topology id; grown with bestTriangles_
+    RouteGuardTable routeGuards_;
+
+    // bumped on every reset: cooldown/reinstatement timers of a previous topology do nothing
+    std::atomic<uint64_t> guardGeneration_{0};
+    std::atomic<int> parkedCount_{0};
+
+    // exchangeInfo cache
+    std::unique_ptr<ExchangeInfoCache> exchangeInfo_; // last: its refresh thread uses the members above
 };
 
 #endif // TRIANGLE_SCANNER_HPP
@@ -0,0 +1,155 @@
+#ifndef TRIANGLE_TOPOLOGY_HPP
+#define TRIANGLE_TOPOLOGY_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include "core/triangle.hpp"
+
+/**
+ * One tradable pair as far as the topology cares (filters don't matter here).
+ */
+struct TopologySymbol {
+    std::string symbol;
+    std::string baseAsset;
+    std::string quoteAsset;
+};
+
+/**
+ * Which cycles discovery keeps.
+ * - baseAssets: only start triangles at these assets (empty => any); the
+ *   order is the preference when rotations are canonicalized.
+ * - quoteAssets: only use symbols quoted in these assets (empty => any).
+ * - keepRotations: emit A->B->C->A, B->C->A->B and C->A->B->C as separate
+ *   triangles (one per allowed base); otherwise only the rotation starting
+ *   at the most preferred allowed base (by name without a whitelist).
+ */
+struct TopologyOptions {
+    bool inverseEdges{true};
+    bool keepRotations{true};
+    std::vector<std::string> baseAssets;
+    std::vector<std::string> quoteAssets;
+
+    bool operator==(const TopologyOptions& o) const {
+        return inverseEdges == o.inverseEdges && keepRotations == o.keepRotations
+            && baseAssets == o.baseAssets && quoteAssets == o.quoteAssets;
+    }
+    bool operator!=(const TopologyOptions& o) const { return !(*this == o); }
+};
+
+/**
+ * Graph size and live triangle count, kept current by build(), update() and
+ * load(); threads and discoveryMs are from the last full build().
+ */
+struct TopologyStats {
+    int assets{0};
+    int edges{0};
+    int triangles{0};
+    int threads{0};
+    double discoveryMs{0.0};
+};
+
+/**
+ * What an incremental update changed (triangle ids).
+ */
+struct TopologyDelta {
+    std::vector<int> added;
+    std::vector<int> removed;
+    std::vector<std::string> symbolsAdded;
+    std::vector<std::string> symbolsRemoved;
+};
+
+/**
+ * TriangleTopology
+ * The discovered triangle set plus its reverse index (raw symbol => triangle
+ * ids), built from the trading-pair universe.
+ *
+ * build() runs over an integer CSR copy of the graph, split across threads
+ * by starting asset; update() works on the string adjacency it keeps.
+ *
+ * Triangle ids are stable for the life of the process: a delisted symbol
+ * tombstones its triangles instead of compacting the vector, so anything
+ * indexed by id (edge lists, the best-triangle heap) stays valid. New listings
+ * only search cycles through their own edges.
+ *
+ * save()/load() persist it (compacted) keyed by hashSymbols() of the
+ * universe it was built from, so a restart with the same listings skips
+ * discovery and a changed one only applies the difference.
+ */
+class TriangleTopology {
+public:
+    // full discovery from scratch (parallel over starting assets)
+    void build(const std::vector<TopologySymbol>& symbols, const TopologyOptions& options,
+               bool debug = false);
+
+    // bring the topology in line with `symbols`, touching only what changed
+    TopologyDelta update(const std::vector<TopologySymbol>& symbols);
+
+    // add one route as-is (file-based loading, detected N-leg cycles);
+    // returns its id or -1 if known
+    int addTriangle(const Triangle& tri);
+    int idOf(const Triangle& tri) const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // covers the listings and the options
+    static uint64_t hashSymbols(const std::vector<TopologySymbol>& symbols, const TopologyOptions& options);
+    uint64_t hash() const { return hash_; }
+    const TopologyOptions& options() const { return options_; }
+    const TopologyStats& stats() const { return stats_; }
+
+    // ids are [0, size()), some may be tombstones
+    int size() const { return (int)triangles_.size(); }
+    int aliveCount() const { return aliveCount_; }
+    bool isAlive(int idx) const { return idx >= 0 && idx < size() && alive_[idx]; }
+    const Triangle& triangle(int idx) const { return triangles_[idx]; }
+
+    // live triangle ids that trade rawSymbol (nullptr if none)
+    const std::vector<int>* trianglesForSymbol(const std::string& rawSymbol) const;
+    const std::unordered_map<std::string, std::vector<int>>& symbolIndex() const { return bySymbol_; }
+
+private:
+    using Edge = std::pair<std::string, std::string>; // (to asset, leg "SYM_FWD")
+
+    void clear();
+    void applyOptions(const TopologyOptions& options);
+    bool usesSymbol(const TopologySymbol& s) const;
+    int baseRank(const std::string& asset) const;
+    void addEdges(const TopologySymbol& s);
+    void removeEdges(const TopologySymbol& s);
+    void refreshStats();
+    void discoverThroughEdge(const std::string& from, const std::string& to,
+                             const std::string& leg, std::vector<int>& added);
+    int addCycle(const std::string& base, const std::string& l1,
+                 const std::string& l2, const std::string& l3);
+    // addCycle for each wanted rotation of A->B->C->A (legs ab, bc, ca)
+    void addRotations(const std::string& A, const std::string& B, const std::string& C,
+                      const std::string& ab, const std::string& bc, const std::string& ca,
+                      std::vector<int>* added);
+    void removeTriangle(int idx);
+    void rehash();
+
+private:
+    TopologyOptions options_;
+    std::unordered_map<std::string, int> baseRank_; // whitelist position
+    std::unordered_set<std::string> quoteAllowed_;
+    bool debug_{false};
+    TopologyStats stats_;
+
+    std::vector<Triangle> triangles_;
+    std::vector<uint8_t> alive_;
+    int aliveCount_{0};
+
+    std::unordered_map<std::string, std::vector<int>> bySymbol_; // raw symbol => live ids
+    std::unordered_map<std::string, int> byKey_;                 // "L1->L2->L3" => id
+    std::unordered_map<std::string, std::vector<Edge>> adjacency_;
+    std::map<std::string, TopologySymbol> symbols_;              // sorted => stable hash
+
+    uint64_t hash_{0};
+};
+
+#endif // TRIANGLE_TOPOLOGY_HPP
@@ -7,11 +7,14 @@
 #include "core/wallet.hpp"
 
 // Starts a background thread that periodically syncs wallet balances with Binance.
+// With the user data stream running this is only a low-frequency safety net,
+// so the interval is configurable (the stream keeps balances live in between).
 void startWalletSyncThread(Wallet* wallet,
                            const std::string& apiKey,
                            const std::string& secretKey,
                            const std::string& baseUrl,
                            std::atomic<bool>* keepRunning,
-                           std::thread& syncThread);
+                           std::thread& syncThread,
+                           int intervalSec = 5);
 
 #endif // BINANCE_ACCOUNT_SYNC_HPP
@@ -3,6 +3,7 @@
 
 #include "i_exchange_executor.hpp"
 #include "core/orderbook.hpp"
+#include "exchange/rate_limiter.hpp"
 #include <mutex>
 #include <chrono>
 
@@ -22,14 +23,17 @@ public:
                                  double quantityBase) override;
 
     OrderBookData getOrderBookSnapshot(const std::string& symbol) override;
+    bool getOrderBookSnapshots(const std::vector<std::string>& symbols,
+                               std::vector<OrderBookData>& out) override;
 
     // existing:
     void setMockPrice(double px);
     void setSlippageBps(double bps) { slippageBps_ = bps; }
 
-    // Rate-limiter config: same approach as real executor
-    void setMaxRequestsPerMinute(int rpm) { maxRequestsPerMinute_ = rpm; }
-    void setMaxOrdersPerSecond(int ops)   { maxOrdersPerSec_     = ops; }
+    // Rate-limiter config: same shared limiter as the real executor
+    void setMaxRequestsPerMinute(int rpm) { limiter_->setWeightPerMinute(rpm); }
+    void setMaxOrdersPerSecond(int ops)   { limiter_->setOrdersPerSecond(ops); }
+    void setRateLimiter(RateLimiter* limiter) { limiter_ = limiter; }
 
 private:
     double fillRatio_;
@@ -40,23 +44,8 @@ private:
     // pointer to OB manager
     OrderBookManager* obm_;
 
-    // --- Rate limiting / throttler data ---
-    int maxRequestsPerMinute_{1200};
-    int maxOrdersPerSec_{10};
-
-    static std::mutex throttleMutex_;
-
-    double requestTokens_;
-    std::chrono::steady_clock::time_point lastRefillRequests_;
-
-    int orderCountInCurrentSec_;
-    std::chrono::steady_clock::time_point currentSecStart_;
-
-private:
-    // Rate limiter logic
-    void throttleRequest(bool isOrder);
-    void refillRequestTokens();
-    void resetOrderCounterIfNewSecond();
+    // shared weight/order limiter
+    RateLimiter* limiter_;
 };
 
 #endif // BINANCE_DRY_EXECUTOR_HPP
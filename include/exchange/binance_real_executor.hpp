@@ -3,15 +3,35 @@
 
 #include "i_exchange_executor.hpp"
 #include "core/orderbook.hpp"
+#include "exchange/rate_limiter.hpp"
 #include <string>
 #include <mutex>
 #include <chrono>
+#include <memory>
+#include <deque>
+#include <unordered_map>
+#include <openssl/evp.h>
 
 class OrderBookManager; // forward declare if you use it
 
 /**
- * A real (testnet) Binance executor for spot trades, now with a simple
- * rate-limiting mechanism (token bucket or leaky bucket).
+ * A pre-built MARKET order skeleton for one symbol/side.
+ * `prefix` is everything up to "quantity=", and `innerCtx` is the HMAC inner
+ * hash with key^ipad AND the prefix already absorbed. At fire time we only
+ * append quantity + recvWindow + timestamp, hash that tail and finish.
+ */
+struct OrderTemplate {
+    std::string symbol;
+    OrderSide side;
+    std::string prefix;   // "symbol=BTCUSDT&side=SELL&type=MARKET&quantity="
+    int qtyDecimals{8};
+    int64_t stepRaw{1};   // LOT_SIZE.stepSize in 10^-qtyDecimals units
+    std::shared_ptr<EVP_MD_CTX> innerCtx;
+};
+
+/**
+ * A real (testnet) Binance executor for spot trades. Requests go through the
+ * shared RateLimiter (weight-aware, corrected from X-MBX-USED-WEIGHT-1M).
  */
 class BinanceRealExecutor : public IExchangeExecutor {
 public:
@@ -25,10 +45,23 @@ public:
                                  double quantityBase) override;
 
     OrderBookData getOrderBookSnapshot(const std::string& symbol) override;
+    bool getOrderBookSnapshots(const std::vector<std::string>& symbols,
+                               std::vector<OrderBookData>& out) override;
+
+    // Build (or refresh) a pre-signed template for symbol/side
+    void prestageOrder(const std::string& symbol,
+                       OrderSide side,
+                       int qtyDecimals = 8) override;
+
+    // cap on how many templates we keep around (oldest are evicted first)
+    void setMaxTemplates(size_t n) { maxTemplates_ = n; }
 
     // optionally, user can set these if your usage differs
-    void setMaxRequestsPerMinute(int rpm) { maxRequestsPerMinute_ = rpm; }
-    void setMaxOrdersPerSecond(int ops)   { maxOrdersPerSec_     = ops; }
+    void setMaxRequestsPerMinute(int rpm) { limiter_->setWeightPerMinute(rpm); }
+    void setMaxOrdersPerSecond(int ops)   { limiter_->setOrdersPerSecond(ops); }
+
+    // defaults to RateLimiter::shared()
+    void setRateLimiter(RateLimiter* limiter) { limiter_ = limiter; }
 
 private:
     std::string apiKey_;
@@ -38,33 +71,34 @@ private:
 
     // helper to create signature, do HTTP post, etc.
     std::string signQueryString(const std::string& query) const;
+
+    // HMAC-SHA256 split into a keyed inner/outer state computed once,
+    // so each signature only hashes the data that actually changes.
+    void initHmacKeyState();
+    std::string finishSignature(const EVP_MD_CTX* innerState,
+                                const std::string& tail) const;
+
+    std::shared_ptr<const OrderTemplate> buildTemplate(const std::string& symbol,
+                                                       OrderSide side,
+                                                       int qtyDecimals) const;
+    std::shared_ptr<const OrderTemplate> findTemplate(const std::string& symbol,
+                                                      OrderSide side);
     std::string httpRequest(const std::string& method,
                             const std::string& endpoint,
                             const std::string& queryString);
 
-    // --- Rate limiting / throttler data ---
-    // For instance: 1200 weight/min => 20 requests/sec average.
-    // We'll do a simpler version: X requests per minute + Y orders per second
-    int maxRequestsPerMinute_{1200}; 
-    int maxOrdersPerSec_{10}; // e.g. 10 new orders per second
+    // key^ipad / key^opad digest states (never mutated after construction)
+    std::shared_ptr<EVP_MD_CTX> hmacInner_;
+    std::shared_ptr<EVP_MD_CTX> hmacOuter_;
 
-    // We'll store the last times we've made requests and orders
-    // plus counters to ensure we don't exceed short-term bursts
-    static std::mutex throttleMutex_;
+    // pre-staged orders, keyed by "SYMBOL|B" / "SYMBOL|S"
+    std::unordered_map<std::string, std::shared_ptr<const OrderTemplate>> templates_;
+    std::deque<std::string> templateOrder_; // insertion order for eviction
+    size_t maxTemplates_{64};
+    std::mutex templateMutex_;
 
-    // token bucket approach for general requests
-    double requestTokens_{ (double)maxRequestsPerMinute_ }; 
-    std::chrono::steady_clock::time_point lastRefillRequests_;
-
-    // short-burst order count
-    int orderCountInCurrentSec_{0};
-    std::chrono::steady_clock::time_point currentSecStart_;
-
-private:
-    // We'll unify the logic in this method:
-    void throttleRequest(bool isOrder);
-    void refillRequestTokens();
-    void resetOrderCounterIfNewSecond();
+    // shared weight/order limiter
+    RateLimiter* limiter_;
 };
 
 #endif // BINANCE_REAL_EXECUTOR_HPP
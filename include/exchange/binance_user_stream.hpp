@@ -0,0 +1,97 @@
+#ifndef BINANCE_USER_STREAM_HPP
+#define BINANCE_USER_STREAM_HPP
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include "core/wallet.hpp"
+
+/**
+ * BinanceUserStream
+ * - Creates a listenKey (POST /api/v3/userDataStream)
+ * - Consumes the user-data websocket and applies balance events to Wallet as
+ *   they arrive (outboundAccountPosition, balanceUpdate)
+ * - PUTs a keepalive every 30 min (keys expire after 60)
+ *
+ * Fills reach the wallet through outboundAccountPosition, which Binance
+ * sends after every trade with the resulting balances; executionReport
+ * fills are only counted and logged (applying them too would count each
+ * fill twice). The trade path books the same fills as deltas, so the
+ * Wallet parks these pushes for assets an open transaction holds and
+ * applies them once it commits or rolls back (see WalletSlot).
+ *
+ * Both base URLs are configurable so it can run against a local mock (a
+ * ws:// URL connects without TLS), and applyEvent() can be fed recorded
+ * payloads directly.
+ */
+class BinanceUserStream {
+public:
+    BinanceUserStream(Wallet* wallet,
+                      const std::string& apiKey,
+                      const std::string& restBaseUrl = "https://testnet.binance.vision",
+                      const std::string& wsBaseUrl   = "wss://testnet.binance.vision/ws");
+    ~BinanceUserStream();
+
+    // create listenKey + spawn socket/keepalive threads
+    bool start();
+    void stop();
+
+    void setKeepaliveInterval(std::chrono::seconds s) { keepaliveInterval_ = s; }
+
+    /**
+     * Apply one user-data event (raw JSON) to the wallet.
+     * @return true if it was a recognised event type.
+     */
+    bool applyEvent(const std::string& payload);
+
+    bool isConnected() const { return connected_.load(); }
+    uint64_t eventsApplied() const { return eventsApplied_.load(); }
+    uint64_t fillsSeen() const { return fillsSeen_.load(); }
+
+private:
+    std::string createListenKey();
+    bool keepAliveListenKey();
+    void closeListenKey();
+    std::string restCall(const std::string& method, const std::string& query);
+
+    void runSocket();     // connect/run/reconnect loop (no recursion)
+    // one connection on a TLS (wss://) or plain (ws://) client, until close/fail/stop
+    template <class Client>
+    void runConnection(const std::string& url, int& backoffSec);
+    void runKeepalive();
+
+    // interruptible sleep; returns false if we're stopping
+    bool waitFor(std::chrono::milliseconds d);
+
+private:
+    Wallet* wallet_;
+    std::string apiKey_;
+    std::string restBaseUrl_;
+    std::string wsBaseUrl_;
+    std::chrono::seconds keepaliveInterval_{30 * 60};
+
+    std::mutex keyMutex_;
+    std::string listenKey_;
+
+    // lets stop()/listenKeyExpired close the socket that's currently running
+    std::mutex socketMutex_;
+    std::function<void()> closeSocket_;
+
+    std::mutex waitMutex_;
+    std::condition_variable waitCv_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> connected_{false};
+    std::atomic<uint64_t> eventsApplied_{0};
+    std::atomic<uint64_t> fillsSeen_{0};
+
+    std::thread socketThread_;
+    std::thread keepaliveThread_;
+};
+
+#endif // BINANCE_USER_STREAM_HPP
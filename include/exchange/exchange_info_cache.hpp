@@ -0,0 +1,92 @@
+#ifndef EXCHANGE_INFO_CACHE_HPP
+#define EXCHANGE_INFO_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include "core/symbol_registry.hpp"
+
+/**
+ * One TRADING symbol of the exchange universe, already reduced to what the
+ * bot uses (assets, fixed-point scale, filters).
+ */
+struct UniverseSymbol {
+    std::string symbol;
+    std::string baseAsset;
+    std::string quoteAsset;
+    SymbolInfo info;       // scale only; asset ids are assigned on register
+    SymbolFilters filters;
+};
+
+/**
+ * The processed exchangeInfo. `hash` covers the content only (not the fetch
+ * time), so two fetches with the same listings/filters compare equal.
+ */
+struct ExchangeUniverse {
+    std::vector<UniverseSymbol> symbols; // sorted by symbol
+    uint64_t hash{0};
+    int64_t fetchedAt{0};                // unix seconds
+};
+
+/**
+ * ExchangeInfoCache
+ * Keeps the processed universe in a compact binary file (fixed-size records
+ * + one string blob) so a warm start mmaps it instead of downloading and
+ * parsing several MB of exchangeInfo JSON.
+ *
+ * - load(): fresh cache => use it; stale/missing => download (falls back to
+ *   a stale cache when offline).
+ * - startRefresh(): background re-download every interval; if the content
+ *   hash differs the cache is rewritten and onChange gets the new universe,
+ *   otherwise only the timestamp is refreshed.
+ */
+class ExchangeInfoCache {
+public:
+    ExchangeInfoCache(const std::string& path = "config/exchange_info.cache",
+                      std::chrono::seconds ttl = std::chrono::hours(6),
+                      const std::string& url = "https://api.binance.com/api/v3/exchangeInfo");
+    ~ExchangeInfoCache();
+
+    bool load(ExchangeUniverse& out);
+
+    bool loadFromDisk(ExchangeUniverse& out) const;
+    bool fetch(ExchangeUniverse& out) const;
+    bool save(const ExchangeUniverse& uni) const;
+
+    bool isFresh(const ExchangeUniverse& uni) const;
+
+    void startRefresh(std::chrono::seconds interval,
+                      std::function<void(const ExchangeUniverse&)> onChange);
+    void stop();
+
+    // content hash of the universe currently in use
+    uint64_t currentHash() const { return currentHash_.load(); }
+
+    static uint64_t hashUniverse(const std::vector<UniverseSymbol>& symbols);
+
+private:
+    void runRefresh();
+
+private:
+    std::string path_;
+    std::chrono::seconds ttl_;
+    std::string url_;
+
+    std::atomic<uint64_t> currentHash_{0};
+
+    std::chrono::seconds refreshInterval_{3600};
+    std::function<void(const ExchangeUniverse&)> onChange_;
+
+    std::mutex waitMutex_;
+    std::condition_variable waitCv_;
+    std::atomic<bool> running_{false};
+    std::thread refreshThread_;
+};
+
+#endif // EXCHANGE_INFO_CACHE_HPP
@@ -2,6 +2,7 @@
 #define I_EXCHANGE_EXECUTOR_HPP
 
 #include <string>
+#include <vector>
 #include "core/orderbook.hpp"  // so we know OrderBookData
 
 enum class OrderSide { BUY, SELL };
@@ -27,6 +28,22 @@ public:
 
     // get local snapshot or fetch from an external endpoint
     virtual OrderBookData getOrderBookSnapshot(const std::string& symbol) = 0;
+
+    // books for several symbols as of one instant; false if no consistent
+    // view was available. Default: one snapshot per symbol (no guarantee)
+    virtual bool getOrderBookSnapshots(const std::vector<std::string>& symbols,
+                                       std::vector<OrderBookData>& out) {
+        out.resize(symbols.size());
+        for (size_t i = 0; i < symbols.size(); i++) out[i] = getOrderBookSnapshot(symbols[i]);
+        return true;
+    }
+
+    // Optional: pre-build the static part of a likely order (symbol, side,
+    // quantity precision) so only quantity + timestamp are left for fire time.
+    // Executors that don't sign anything can ignore it.
+    virtual void prestageOrder(const std::string& /*symbol*/,
+                               OrderSide /*side*/,
+                               int /*qtyDecimals*/ = 8) {}
 };
 
 #endif // I_EXCHANGE_EXECUTOR_HPP
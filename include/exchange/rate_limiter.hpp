@@ -0,0 +1,89 @@
+#ifndef RATE_LIMITER_HPP
+#define RATE_LIMITER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * Binance REST request weights for the calls we make.
+ * (see /api/v3 docs; depth weight depends on `limit`)
+ */
+namespace RequestWeight {
+    constexpr int ORDER          = 1;   // POST /api/v3/order
+    constexpr int ACCOUNT        = 20;  // GET  /api/v3/account
+    constexpr int EXCHANGE_INFO  = 20;  // GET  /api/v3/exchangeInfo
+    constexpr int USER_STREAM    = 2;   // POST/PUT /api/v3/userDataStream
+    constexpr int DEPTH_100      = 5;   // GET  /api/v3/depth?limit<=100
+    constexpr int LOCAL_SNAPSHOT = 1;   // local OB read, counted for safety
+}
+
+/**
+ * Counters exposed for the dashboard
+ */
+struct RateLimiterMetrics {
+    uint64_t acquired{0};       // total acquire() calls
+    uint64_t throttled{0};      // how many of those had to wait
+    double   throttledMs{0.0};  // total time spent waiting
+    double   maxWaitMs{0.0};    // worst single wait
+    int      serverUsedWeight{-1}; // last X-MBX-USED-WEIGHT-1M seen (-1 = none)
+};
+
+/**
+ * RateLimiter
+ * Shared, lock-free limiter for request weight/minute + orders/second.
+ *
+ * Each budget is a GCRA ("virtual scheduling") bucket: a single atomic
+ * theoretical-arrival-time advanced by CAS. acquire() reserves its slot
+ * immediately and then sleeps exactly until that slot opens, so there is no
+ * mutex held while sleeping and no fixed polling interval.
+ */
+class RateLimiter {
+public:
+    RateLimiter(int weightPerMinute = 1200, int ordersPerSecond = 10);
+
+    // process-wide instance shared by all executors + account sync
+    static RateLimiter& shared();
+
+    void setWeightPerMinute(int weightPerMinute);
+    void setOrdersPerSecond(int ordersPerSecond);
+
+    // Block until `weight` (and one order slot if isOrder) is available.
+    void acquire(int weight, bool isOrder = false);
+
+    /**
+     * Self-correct from the server's view of the current minute.
+     * If Binance says we used more than we think, push our bucket forward.
+     */
+    void updateUsedWeight(int usedWeight1m);
+
+    // Parse one raw HTTP header line; picks up X-MBX-USED-WEIGHT-1M.
+    void onResponseHeader(const char* line, size_t len);
+
+    RateLimiterMetrics metrics() const;
+
+private:
+    struct Bucket {
+        std::atomic<int64_t> tatNs{0};      // theoretical arrival time
+        std::atomic<int64_t> intervalNs{0}; // ns per unit of cost
+        std::atomic<int64_t> burstNs{0};    // how far ahead tat may run
+    };
+
+    static void configure(Bucket& b, int perPeriod, int64_t periodNs);
+
+    // Reserve `cost` units, return how long (ns) the caller must wait.
+    static int64_t reserve(Bucket& b, int cost, int64_t nowNs);
+
+    static int64_t nowNs();
+
+    Bucket weight_;
+    Bucket orders_;
+
+    std::atomic<uint64_t> acquired_{0};
+    std::atomic<uint64_t> throttled_{0};
+    std::atomic<int64_t>  throttledNs_{0};
+    std::atomic<int64_t>  maxWaitNs_{0};
+    std::atomic<int>      serverUsedWeight_{-1};
+};
+
+#endif // RATE_LIMITER_HPP
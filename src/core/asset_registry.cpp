@@ -0,0 +1,15 @@
+#include "core/asset_registry.hpp"
+#include <iostream>
+
+AssetRegistry& AssetRegistry::instance() {
+    static AssetRegistry registry;
+    return registry;
+}
+
+AssetId AssetRegistry::intern(const std::string& name) {
+    AssetId id = names_.intern(name);
+    if (id == INVALID_ASSET) {
+        std::cerr << "[ASSETS] registry full, can't add " << name << "\n";
+    }
+    return id;
+}
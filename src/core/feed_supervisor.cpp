@@ -0,0 +1,245 @@
+#include "core/feed_supervisor.hpp"
+#include <websocketpp/client.hpp>
+#include <websocketpp/config/asio_client.hpp>
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+using WebSocketClient = websocketpp::client<websocketpp::config::asio_tls_client>;
+
+// how often links are pinged / checked for silence
+static const int64_t SUPERVISE_NS = 250000000LL;
+// a dropped link's close handshake gets this long before the socket is cut
+static const long CLOSE_HANDSHAKE_MS = 1000;
+
+FeedSupervisor::FeedSupervisor(MessageSink sink)
+    : sink_(std::move(sink))
+{
+}
+
+FeedSupervisor::~FeedSupervisor()
+{
+    stop();
+}
+
+void FeedSupervisor::setOptions(const FeedOptions& opts)
+{
+    std::lock_guard<std::mutex> lk(optsMutex_);
+    opts_ = opts;
+}
+
+void FeedSupervisor::addChunk(const std::string& url)
+{
+    bool standby;
+    {
+        std::lock_guard<std::mutex> lk(optsMutex_);
+        standby = opts_.hotStandby;
+    }
+
+    std::lock_guard<std::mutex> lk(linksMutex_);
+    if (!running_.load()) return;
+    const int chunk = chunks_++;
+    for (int i = 0; i < (standby ? 2 : 1); i++) {
+        links_.emplace_back(new Link());
+        Link* link = links_.back().get();
+        link->chunk = chunk;
+        link->index = i;
+        link->url   = url;
+        link->thread = std::thread([this, link](){ runLink(link); });
+    }
+    if (!superviseTimer_) {
+        superviseTimer_ = TimerService::instance().schedulePeriodic(SUPERVISE_NS, [this](){ supervise(); });
+    }
+}
+
+void FeedSupervisor::stop()
+{
+    if (!running_.exchange(false)) return;
+    if (superviseTimer_) TimerService::instance().cancel(superviseTimer_);
+    {
+        std::lock_guard<std::mutex> lk(waitMutex_);
+    }
+    waitCv_.notify_all();
+
+    std::lock_guard<std::mutex> lk(linksMutex_);
+    for (auto& link : links_) {
+        std::lock_guard<std::mutex> sl(link->socketMutex);
+        if (link->closeSocket) link->closeSocket();
+    }
+    for (auto& link : links_) {
+        if (link->thread.joinable()) link->thread.join();
+    }
+}
+
+FeedStats FeedSupervisor::stats() const
+{
+    FeedStats st;
+    std::lock_guard<std::mutex> lk(linksMutex_);
+    st.chunks = chunks_;
+    st.links  = (int)links_.size();
+    for (const auto& link : links_) {
+        st.linksUp    += link->up.load(std::memory_order_relaxed) ? 1 : 0;
+        st.messages   += link->messages.load(std::memory_order_relaxed);
+        st.reconnects += link->reconnects.load(std::memory_order_relaxed);
+    }
+    st.gapDrops  = gapDrops_.load(std::memory_order_relaxed);
+    st.pongDrops = pongDrops_.load(std::memory_order_relaxed);
+    return st;
+}
+
+/**
+ * runLink => one client for the link's lifetime; each pass connects, runs
+ * until close/fail/drop, resets the client and waits out the backoff.
+ * A drop closes the connection on its io_service (close handshake, then
+ * the socket is cut), so run() returns with nothing of it left queued.
+ */
+void FeedSupervisor::runLink(Link* link)
+{
+    const char* role = (link->index == 0 ? "primary" : "standby");
+
+    WebSocketClient client;
+    client.init_asio();
+    client.set_tls_init_handler([](websocketpp::connection_hdl){
+        return websocketpp::lib::make_shared<boost::asio::ssl::context>(
+            boost::asio::ssl::context::tlsv12_client
+        );
+    });
+
+    int64_t openedNs = 0;
+    client.set_open_handler([link, role, &client, &openedNs](websocketpp::connection_hdl hdl){
+        int64_t now = TimerService::nowNs();
+        link->lastMsgNs.store(now, std::memory_order_relaxed);
+        link->lastPongNs.store(now, std::memory_order_relaxed);
+        link->up.store(true);
+        openedNs = now;
+        {
+            std::lock_guard<std::mutex> lk(link->socketMutex);
+            link->sendPing = [&client, hdl](){
+                websocketpp::lib::error_code ec;
+                client.ping(hdl, "", ec);
+            };
+        }
+        std::cout << "[FEED] chunk " << link->chunk << " " << role << " connected\n";
+    });
+    client.set_message_handler([this, link](websocketpp::connection_hdl, WebSocketClient::message_ptr msg){
+        int64_t now = TimerService::nowNs();
+        link->lastMsgNs.store(now, std::memory_order_relaxed);
+        link->messages.fetch_add(1, std::memory_order_relaxed);
+        sink_(msg->get_payload(), now);
+    });
+    client.set_pong_handler([link](websocketpp::connection_hdl, std::string){
+        link->lastPongNs.store(TimerService::nowNs(), std::memory_order_relaxed);
+    });
+    client.set_fail_handler([link, role](websocketpp::connection_hdl){
+        link->up.store(false);
+        std::cerr << "[FEED] chunk " << link->chunk << " " << role << " connect failed\n";
+    });
+    client.set_close_handler([link, role](websocketpp::connection_hdl){
+        link->up.store(false);
+        std::cerr << "[FEED] chunk " << link->chunk << " " << role << " closed\n";
+    });
+
+    int64_t backoffNs = 0;
+    while (running_.load()) {
+        openedNs = 0;
+        websocketpp::lib::error_code ec;
+        auto con = client.get_connection(link->url, ec);
+        if (ec) {
+            std::cerr << "[FEED] chunk " << link->chunk << " " << role
+                      << " connect error: " << ec.message() << "\n";
+        } else {
+            con->set_close_handshake_timeout(CLOSE_HANDSHAKE_MS);
+            client.connect(con);
+            {
+                std::lock_guard<std::mutex> lk(link->socketMutex);
+                link->closeSocket = [&client, con](){
+                    client.get_io_service().post([&client, con](){
+                        websocketpp::lib::error_code cec;
+                        client.close(con->get_handle(), websocketpp::close::status::going_away, "", cec);
+                        if (cec) con->terminate(cec); // not open (yet/anymore): just cut it
+                    });
+                };
+            }
+            if (running_.load()) {
+                client.run(); // blocking until close/fail/drop
+            }
+            std::lock_guard<std::mutex> lk(link->socketMutex);
+            link->closeSocket = nullptr;
+            link->sendPing    = nullptr;
+        }
+        link->up.store(false);
+        client.reset();
+        if (!running_.load()) break;
+
+        int64_t baseNs, maxNs, stableNs;
+        {
+            std::lock_guard<std::mutex> lk(optsMutex_);
+            baseNs   = opts_.backoffBaseNs;
+            maxNs    = opts_.backoffMaxNs;
+            stableNs = opts_.stableUpNs;
+        }
+        // only a connection that stayed up starts the ladder over: a server
+        // that accepts and drops at once still gets the growing backoff
+        bool stable = openedNs != 0 && TimerService::nowNs() - openedNs >= stableNs;
+        backoffNs = (stable || backoffNs == 0) ? baseNs : std::min(backoffNs * 2, maxNs);
+        link->reconnects.fetch_add(1, std::memory_order_relaxed);
+        if (!waitFor(jitteredBackoff(backoffNs))) break;
+    }
+}
+
+/**
+ * supervise => on TimerService: drop open links that went silent or stopped
+ * answering pings (their threads reconnect), ping the rest when due.
+ */
+void FeedSupervisor::supervise()
+{
+    FeedOptions o;
+    {
+        std::lock_guard<std::mutex> lk(optsMutex_);
+        o = opts_;
+    }
+    const int64_t now = TimerService::nowNs();
+
+    std::lock_guard<std::mutex> lk(linksMutex_);
+    for (auto& link : links_) {
+        if (!link->up.load()) continue;
+        std::lock_guard<std::mutex> sl(link->socketMutex);
+        if (!link->closeSocket) continue;
+
+        const char* role = (link->index == 0 ? "primary" : "standby");
+        int64_t silentNs = now - link->lastMsgNs.load(std::memory_order_relaxed);
+        int64_t pongNs   = now - link->lastPongNs.load(std::memory_order_relaxed);
+        if (o.gapNs > 0 && silentNs > o.gapNs) {
+            std::cerr << "[FEED] chunk " << link->chunk << " " << role << " silent for "
+                      << silentNs / 1000000 << " ms => reconnect\n";
+            gapDrops_.fetch_add(1, std::memory_order_relaxed);
+            link->up.store(false);
+            link->closeSocket();
+        } else if (o.pongTimeoutNs > 0 && pongNs > o.pongTimeoutNs) {
+            std::cerr << "[FEED] chunk " << link->chunk << " " << role << " no pong for "
+                      << pongNs / 1000000 << " ms => reconnect\n";
+            pongDrops_.fetch_add(1, std::memory_order_relaxed);
+            link->up.store(false);
+            link->closeSocket();
+        } else if (link->sendPing && now - link->lastPingNs >= o.pingIntervalNs) {
+            link->sendPing();
+            link->lastPingNs = now;
+        }
+    }
+}
+
+bool FeedSupervisor::waitFor(int64_t ns)
+{
+    std::unique_lock<std::mutex> lk(waitMutex_);
+    return !waitCv_.wait_for(lk, std::chrono::nanoseconds(ns), [this](){ return !running_.load(); });
+}
+
+// uniform in [backoff/2, backoff]: the links of a chunk (and all chunks after
+// a network blip) don't reconnect in lockstep
+int64_t FeedSupervisor::jitteredBackoff(int64_t backoffNs)
+{
+    static thread_local std::mt19937_64 rng(std::random_device{}());
+    if (backoffNs <= 1) return backoffNs;
+    std::uniform_int_distribution<int64_t> dist(backoffNs / 2, backoffNs);
+    return dist(rng);
+}
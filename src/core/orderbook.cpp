@@ -1,7 +1,7 @@
 #include "core/orderbook.hpp"
 #include "engine/triangle_scanner.hpp"
-#include <websocketpp/client.hpp>
-#include <websocketpp/config/asio_client.hpp>
+#include "core/symbol_registry.hpp"
+#include "core/fixed_point.hpp"
 #include <iostream>
 #include <chrono>
 #include <algorithm>
@@ -9,7 +9,6 @@
 #include <sstream>
 
 using json = nlohmann::json;
-using WebSocketClient = websocketpp::client<websocketpp::config::asio_tls_client>;
 
 /**
  * If you have > 50 or so symbols, building them all into one URL can lead to
@@ -18,42 +17,56 @@ using WebSocketClient = websocketpp::client<websocketpp::config::asio_tls_client
 static const size_t MAX_PER_STREAM = 50;
 
 OrderBookManager::OrderBookManager(TriangleScanner* scanner)
-    : running_(true)
+    : slots_(new BookSlot[SymbolRegistry::MAX_SYMBOLS])
+    , stale_(new std::atomic<bool>[SymbolRegistry::MAX_SYMBOLS])
+    , running_(true)
     , scanner_(scanner)
+    , feeds_(new FeedSupervisor([this](const std::string& payload, int64_t recvNs){
+          onCombinedMessage(payload, recvNs);
+      }))
 {
+    for(int i=0; i<SymbolRegistry::MAX_SYMBOLS; i++){
+        stale_[i].store(true, std::memory_order_relaxed); // no update yet
+    }
 }
 
 OrderBookManager::~OrderBookManager() {
     running_ = false;
-    // If we had multiple combined threads, join them
-    for(auto& kv: threads_){
-        if(kv.second.joinable()){
-            kv.second.join();
-        }
-    }
+    if(staleSweep_) TimerService::instance().cancel(staleSweep_);
+    // drops every connection and joins the link threads
+    feeds_->stop();
 }
 
 /**
  * Instead of opening 1 WS per symbol, we store them in a local map for combining.
  */
 void OrderBookManager::start(const std::string& symbol) {
+    SymbolId id = SymbolRegistry::instance().intern(symbol); // its BookSlot index
     std::lock_guard<std::mutex> lock(globalMutex_);
-    mutexes_[symbol]; // ensure there's a mutex for that symbol
+    if(symbols_.insert(symbol).second && id != INVALID_SYMBOL){
+        startedIds_.push_back(id);
+    }
 }
 
 /**
  * We'll define a new method: startCombinedWebSocket() that takes all known symbols,
- * splits them into chunks, and runs multiple WebSocket threads.
+ * splits them into chunks, and hands each chunk's URL to the FeedSupervisor.
+ * Calling it again (after new listings) only opens connections for symbols
+ * that aren't streamed yet.
  */
 void OrderBookManager::startCombinedWebSocket() {
-    // gather all symbols from `mutexes_` keys
+    // gather the not-yet-streamed symbols
     std::vector<std::string> symList;
+    std::lock_guard<std::mutex> streamsLock(streamsMutex_);
     {
         std::lock_guard<std::mutex> lk(globalMutex_);
-        for (auto& kv : mutexes_) {
-            symList.push_back(kv.first);
+        for (auto& sym : symbols_) {
+            if (streamed_.insert(sym).second) {
+                symList.push_back(sym);
+            }
         }
     }
+    if (symList.empty()) return;
 
     // Convert each symbol into "symbol@depth20@100ms"
     std::vector<std::string> streams;
@@ -85,12 +98,8 @@ void OrderBookManager::startCombinedWebSocket() {
             first = false;
         }
 
-        // spawn a dedicated thread for this chunk
-        std::string threadKey = "__combined_" + std::to_string(wsCount) + "__";
-        std::thread t([this, fullUrl=url.str()](){
-            connectCombinedWebSocket(fullUrl);
-        });
-        threads_[threadKey] = std::move(t);
+        // the supervisor runs its connection(s)
+        feeds_->addChunk(url.str());
 
         // move to next chunk
         startIdx = endIdx;
@@ -102,59 +111,48 @@ void OrderBookManager::startCombinedWebSocket() {
               << " symbols.\n";
 }
 
-void OrderBookManager::connectCombinedWebSocket(const std::string& fullUrl) {
-    WebSocketClient client;
-    client.init_asio();
-
-    client.set_tls_init_handler([](websocketpp::connection_hdl){
-        return websocketpp::lib::make_shared<boost::asio::ssl::context>(
-            boost::asio::ssl::context::tlsv12_client
-        );
-    });
-
-    client.set_message_handler([this](websocketpp::connection_hdl, WebSocketClient::message_ptr msg){
-        onCombinedMessage(msg->get_payload());
-    });
-
-    // fail/close => attempt reconnect
-    client.set_fail_handler([this, fullUrl, &client](websocketpp::connection_hdl){
-        std::cerr << "[WS-COMBINED] Fail => reconnect: " << fullUrl << "\n";
-        client.stop();
-        reconnectCombined(fullUrl, 2);
-    });
-    client.set_close_handler([this, fullUrl, &client](websocketpp::connection_hdl){
-        std::cerr << "[WS-COMBINED] Close => reconnect: " << fullUrl << "\n";
-        client.stop();
-        reconnectCombined(fullUrl, 2);
-    });
-
-    std::cout<<"[WS-COMBINED] Connecting to "<< fullUrl <<"\n";
-
-    websocketpp::lib::error_code ec;
-    auto con = client.get_connection(fullUrl, ec);
-    if(ec){
-        std::cerr<<"[WS-COMBINED] connect error: "<< ec.message() <<"\n";
-        reconnectCombined(fullUrl, 2);
-        return;
+/**
+ * peekStreamUpdate => symbol and lastUpdateId straight from the raw text,
+ * so a message the other link already delivered is dropped before the JSON
+ * parse. false if either is missing.
+ */
+static bool peekStreamUpdate(const std::string& p, std::string& symbol, uint64_t& updateId)
+{
+    static const char STREAM[] = "\"stream\":\"";
+    static const char UPDATE[] = "\"lastUpdateId\":";
+    size_t pos = p.find(STREAM);
+    if(pos == std::string::npos) return false;
+    symbol.clear();
+    for(pos += sizeof(STREAM) - 1; pos < p.size() && p[pos] != '@' && p[pos] != '"'; pos++){
+        symbol.push_back((char)::toupper((unsigned char)p[pos]));
     }
-
-    client.connect(con);
-    client.run();  // blocking
-}
-
-void OrderBookManager::reconnectCombined(const std::string& url, int backoff) {
-    std::this_thread::sleep_for(std::chrono::seconds(backoff));
-    int nextBackoff = std::min(backoff*2, 300);
-    connectCombinedWebSocket(url);
+    pos = p.find(UPDATE);
+    if(pos == std::string::npos) return false;
+    updateId = 0;
+    for(pos += sizeof(UPDATE) - 1; pos < p.size() && p[pos] >= '0' && p[pos] <= '9'; pos++){
+        updateId = updateId * 10 + (uint64_t)(p[pos] - '0');
+    }
+    return updateId != 0;
 }
 
 /**
  * onCombinedMessage => each JSON has shape:
  *   { "stream":"btcusdt@depth20@100ms", "data": { "bids":[...], "asks":[...] } }
  */
-void OrderBookManager::onCombinedMessage(const std::string& payload) {
+void OrderBookManager::onCombinedMessage(const std::string& payload, int64_t recvNs) {
     auto t0= std::chrono::steady_clock::now();
 
+    // hot standby: the same snapshot arrives once per link, the first one wins
+    static thread_local std::string peekSymbol;
+    uint64_t updateId = 0;
+    if(peekStreamUpdate(payload, peekSymbol, updateId)){
+        SymbolId id = SymbolRegistry::instance().find(peekSymbol);
+        if(id != INVALID_SYMBOL && updateId <= slots_[id].updateId()){
+            duplicates_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
     try {
         json j = json::parse(payload);
         if(!j.contains("stream") || !j.contains("data")) {
@@ -179,39 +177,48 @@ void OrderBookManager::onCombinedMessage(const std::string& payload) {
             return;
         }
 
-        std::vector<OrderBookLevel> newBids;
-        std::vector<OrderBookLevel> newAsks;
-
-        for (auto& lvl : dataObj["bids"]) {
-            double px = std::stod(lvl[0].get<std::string>());
-            double qty= std::stod(lvl[1].get<std::string>());
-            if(qty>0.0){
-                newBids.push_back({px, qty});
-            }
-        }
-        for (auto& lvl : dataObj["asks"]) {
-            double px = std::stod(lvl[0].get<std::string>());
-            double qty= std::stod(lvl[1].get<std::string>());
-            if(qty>0.0){
-                newAsks.push_back({px, qty});
+        SymbolId symId = SymbolRegistry::instance().find(symbol);
+        if(symId == INVALID_SYMBOL) return; // not start()ed
+
+        // parse straight into fixed-point at the symbol's scale (no stod)
+        const SymbolInfo& si = SymbolRegistry::instance().infoOrDefault(symId);
+
+        auto parseLevels = [&si](const json& side, std::vector<OrderBookLevel>& out){
+            out.reserve(side.size());
+            for (auto& lvl : side) {
+                const std::string& pxStr  = lvl[0].get_ref<const std::string&>();
+                const std::string& qtyStr = lvl[1].get_ref<const std::string&>();
+                OrderBookLevel l;
+                if (!FixedPoint::parse(pxStr.data(), pxStr.size(), si.priceDecimals, l.priceRaw) ||
+                    !FixedPoint::parse(qtyStr.data(), qtyStr.size(), si.qtyDecimals, l.qtyRaw)) {
+                    continue;
+                }
+                if (l.qtyRaw <= 0) continue;
+                l.price    = FixedPoint::toDouble(l.priceRaw, si.priceDecimals);
+                l.quantity = FixedPoint::toDouble(l.qtyRaw, si.qtyDecimals);
+                out.push_back(l);
             }
-        }
+        };
+
+        static thread_local std::vector<OrderBookLevel> newBids;
+        static thread_local std::vector<OrderBookLevel> newAsks;
+        newBids.clear();
+        newAsks.clear();
+        parseLevels(dataObj["bids"], newBids);
+        parseLevels(dataObj["asks"], newAsks);
         std::sort(newBids.begin(), newBids.end(), [](auto&a,auto&b){
-            return a.price>b.price;
+            return a.priceRaw>b.priceRaw;
         });
         std::sort(newAsks.begin(), newAsks.end(), [](auto&a,auto&b){
-            return a.price<b.price;
+            return a.priceRaw<b.priceRaw;
         });
 
-        {
-            std::lock_guard<std::mutex> lk(mutexes_[symbol]);
-            books_[symbol] = {newBids, newAsks};
-        }
-
-        // record last update time
-        {
-            std::lock_guard<std::mutex> g(globalMutex_);
-            lastMsgTime_[symbol] = std::chrono::steady_clock::now();
+        // re-checked under the slot's lock: the other link may have won meanwhile
+        if(!slots_[symId].write(newBids.data(), (int)newBids.size(),
+                                newAsks.data(), (int)newAsks.size(),
+                                si.priceDecimals, si.qtyDecimals, recvNs, updateId)){
+            duplicates_.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
 
         // partial re-scan
@@ -229,28 +236,134 @@ void OrderBookManager::onCombinedMessage(const std::string& payload) {
 }
 
 /**
- * This is the same getOrderBook logic but references the single books_ map
+ * getOrderBook => one symbol's slot (empty if it never had an update, or if
+ * no consistent copy could be taken within the retry budget)
  */
 OrderBookData OrderBookManager::getOrderBook(const std::string& symbol) {
-    std::lock_guard<std::mutex> lk(mutexes_[symbol]);
-    if(books_.count(symbol)==0){
-        return OrderBookData{};
+    OrderBookData out;
+    SymbolId id = SymbolRegistry::instance().find(symbol);
+    if(id == INVALID_SYMBOL) return out;
+    if(!getOrderBooks(&id, 1, &out)) {
+        out = OrderBookData(); // possibly torn
     }
-    return books_[symbol];
+    return out;
 }
 
-// NEW: Implementation for isStale(...) 
-bool OrderBookManager::isStale(const std::string& symbol, double maxStaleMs) const
+bool OrderBookManager::getTopOfBook(const std::string& symbol, double& bestBid, double& bestAsk) {
+    SymbolId id = SymbolRegistry::instance().find(symbol);
+    if(id == INVALID_SYMBOL) return false;
+    return slots_[id].top(bestBid, bestAsk);
+}
+
+/**
+ * getOrderBooks => seqlock read across all the books: note every slot's
+ * even seq, copy, then re-check them all; any moved => copy again. A book
+ * updates every ~100ms and a copy takes microseconds, so a retry is rare
+ * and the budget is only hit under a write storm.
+ */
+bool OrderBookManager::getOrderBooks(const SymbolId* symbols, size_t count, OrderBookData* out)
 {
-    auto now = std::chrono::steady_clock::now();
-    std::lock_guard<std::mutex> g(globalMutex_);
-    auto it = lastMsgTime_.find(symbol);
-    if(it == lastMsgTime_.end()){
-        // we've never updated this symbol => definitely stale
-        return true; 
+    static thread_local std::vector<uint64_t> seqs;
+    seqs.resize(count);
+
+    for (int attempt = 0; attempt <= MAX_READ_RETRIES; attempt++) {
+        for (size_t i = 0; i < count; i++) {
+            SymbolId id = symbols[i];
+            seqs[i] = (id >= 0 && id < SymbolRegistry::MAX_SYMBOLS) ? slots_[id].beginRead() : 0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            SymbolId id = symbols[i];
+            if (id >= 0 && id < SymbolRegistry::MAX_SYMBOLS) {
+                slots_[id].copyTo(out[i]);
+            } else {
+                out[i].bids.clear();
+                out[i].asks.clear();
+            }
+        }
+        bool stable = true;
+        for (size_t i = 0; i < count && stable; i++) {
+            SymbolId id = symbols[i];
+            stable = !(id >= 0 && id < SymbolRegistry::MAX_SYMBOLS) || slots_[id].validate(seqs[i]);
+        }
+        if (stable) return true;
+        tornReads_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+bool OrderBookManager::getOrderBooks(const std::vector<std::string>& symbols, std::vector<OrderBookData>& out)
+{
+    static thread_local std::vector<SymbolId> ids;
+    ids.clear();
+    for (const auto& sym : symbols) ids.push_back(SymbolRegistry::instance().find(sym));
+    out.resize(symbols.size());
+    return getOrderBooks(ids.data(), ids.size(), out.data());
+}
+
+/**
+ * snapshotBooks => compact the wanted ids (each once), then one consistent
+ * getOrderBooks() into the snapshot's reused buffers.
+ */
+bool OrderBookManager::snapshotBooks(const std::vector<SymbolId>& symbols, BookSnapshot& out)
+{
+    static thread_local std::vector<SymbolId> ids;
+    ids.clear();
+
+    std::fill(out.slot.begin(), out.slot.end(), -1);
+    if (out.slot.size() < (size_t)SymbolRegistry::MAX_SYMBOLS) {
+        out.slot.resize(SymbolRegistry::MAX_SYMBOLS, -1);
+    }
+    for (SymbolId id : symbols) {
+        if (id < 0 || id >= SymbolRegistry::MAX_SYMBOLS || out.slot[id] >= 0) continue;
+        out.slot[id] = (int)ids.size();
+        ids.push_back(id);
+    }
+    if (out.books.size() < ids.size()) out.books.resize(ids.size());
+    out.count = ids.size();
+    return getOrderBooks(ids.data(), ids.size(), out.books.data());
+}
+
+void OrderBookManager::startStaleSweep(double maxStaleMs)
+{
+    int64_t maxNs = (int64_t)(std::max(1.0, maxStaleMs) * 1e6);
+    maxStaleNs_.store(maxNs);
+    if(staleSweep_) return; // running; it picks up the new bound
+    staleSweep_ = TimerService::instance().schedulePeriodic(
+        std::max<int64_t>(maxNs / 4, TimerService::TICK_NS), [this](){ sweepStale(); });
+}
+
+/**
+ * sweepStale => a book is stale once its last write is maxStaleNs_ old
+ * (or it never had one).
+ */
+void OrderBookManager::sweepStale()
+{
+    static thread_local std::vector<SymbolId> ids;
+    {
+        std::lock_guard<std::mutex> g(globalMutex_);
+        ids = startedIds_;
     }
-    double elapsed = std::chrono::duration<double,std::milli>(now - it->second).count();
-    return (elapsed > maxStaleMs);
+    const int64_t now = TimerService::instance().coarseNowNs();
+    const int64_t maxNs = maxStaleNs_.load(std::memory_order_relaxed);
+    int stale = 0;
+    for(SymbolId id : ids){
+        int64_t t = slots_[id].updatedNs();
+        bool isOld = (t == 0 || now - t > maxNs);
+        stale_[id].store(isOld, std::memory_order_relaxed);
+        stale += isOld;
+    }
+    staleBooks_.store(stale, std::memory_order_relaxed);
+}
+
+bool OrderBookManager::isStale(SymbolId id) const
+{
+    if(id < 0 || id >= SymbolRegistry::MAX_SYMBOLS) return true;
+    return stale_[id].load(std::memory_order_relaxed);
+}
+
+bool OrderBookManager::isStale(const std::string& symbol) const
+{
+    return isStale(SymbolRegistry::instance().find(symbol));
 }
 
 //------------------------------------------
@@ -0,0 +1,249 @@
+#include "core/symbol_registry.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// old simulator defaults, for symbols exchangeInfo never told us about
+static constexpr double DEFAULT_MIN_QTY      = 0.0001;
+static constexpr double DEFAULT_MIN_NOTIONAL = 10.0;
+
+const char* filterRejectName(FilterReject r) {
+    switch (r) {
+        case FilterReject::OK:                 return "OK";
+        case FilterReject::QTY_BELOW_MIN:      return "QTY_BELOW_MIN";
+        case FilterReject::QTY_ABOVE_MAX:      return "QTY_ABOVE_MAX";
+        case FilterReject::PRICE_OUT_OF_RANGE: return "PRICE_OUT_OF_RANGE";
+        case FilterReject::NOTIONAL_BELOW_MIN: return "NOTIONAL_BELOW_MIN";
+        case FilterReject::NOTIONAL_ABOVE_MAX: return "NOTIONAL_ABOVE_MAX";
+        default:                               return "?";
+    }
+}
+
+SymbolRegistry::SymbolRegistry() {
+    defaultEntry_.filters.minQtyRaw   = FixedPoint::fromDouble(DEFAULT_MIN_QTY, defaultEntry_.info.qtyDecimals);
+    defaultEntry_.filters.minNotional = DEFAULT_MIN_NOTIONAL;
+    for (auto& e : entries_) e.store(&defaultEntry_, std::memory_order_relaxed);
+}
+
+static bool sameEntry(const SymbolEntry& a, const SymbolEntry& b) {
+    const SymbolInfo& x = a.info;
+    const SymbolInfo& y = b.info;
+    const SymbolFilters& f = a.filters;
+    const SymbolFilters& g = b.filters;
+    return x.baseAsset == y.baseAsset && x.quoteAsset == y.quoteAsset
+        && x.priceDecimals == y.priceDecimals && x.qtyDecimals == y.qtyDecimals
+        && x.tickRaw == y.tickRaw && x.stepRaw == y.stepRaw
+        && f.minQtyRaw == g.minQtyRaw && f.maxQtyRaw == g.maxQtyRaw
+        && f.marketMinQtyRaw == g.marketMinQtyRaw && f.marketMaxQtyRaw == g.marketMaxQtyRaw
+        && f.marketStepRaw == g.marketStepRaw
+        && f.minPriceRaw == g.minPriceRaw && f.maxPriceRaw == g.maxPriceRaw
+        && f.minNotional == g.minNotional && f.maxNotional == g.maxNotional
+        && f.minNotionalMarket == g.minNotionalMarket && f.maxNotionalMarket == g.maxNotionalMarket
+        && f.manualMinQty == g.manualMinQty && f.manualMinNotional == g.manualMinNotional;
+}
+
+void SymbolRegistry::publish(SymbolId id, const SymbolEntry& e)
+{
+    const SymbolEntry* cur = entries_[id].load(std::memory_order_relaxed);
+    if (sameEntry(*cur, e)) return;
+    versions_.emplace_back(new SymbolEntry(e));
+    entries_[id].store(versions_.back().get(), std::memory_order_release);
+}
+
+SymbolRegistry& SymbolRegistry::instance() {
+    static SymbolRegistry registry;
+    return registry;
+}
+
+SymbolId SymbolRegistry::intern(const std::string& symbol) {
+    SymbolId id = names_.intern(symbol);
+    if (id == INVALID_SYMBOL) {
+        std::cerr << "[SYMBOLS] registry full, can't add " << symbol << "\n";
+    }
+    return id;
+}
+
+SymbolId SymbolRegistry::registerSymbol(const std::string& symbol,
+                                        const std::string& baseAsset,
+                                        const std::string& quoteAsset,
+                                        const SymbolInfo& scale,
+                                        const SymbolFilters& filters)
+{
+    SymbolId id = intern(symbol);
+    if (id == INVALID_SYMBOL) return id;
+
+    std::lock_guard<std::mutex> lk(writeMutex_);
+    const SymbolEntry& cur = *entries_[id].load(std::memory_order_relaxed);
+    SymbolEntry e;
+    e.info = scale;
+    e.info.baseAsset  = AssetRegistry::instance().intern(baseAsset);
+    e.info.quoteAsset = AssetRegistry::instance().intern(quoteAsset);
+
+    // keep manual overrides across re-registration (e.g. a refresh)
+    e.filters = filters;
+    e.filters.manualMinQty      = cur.filters.manualMinQty;
+    e.filters.manualMinNotional = cur.filters.manualMinNotional;
+    applyManualMinimums(e);
+    publish(id, e);
+    return id;
+}
+
+// exchangeInfo sends numbers as strings ("0.00100000"); tolerate either
+static std::string filterStr(const json& f, const char* key) {
+    if (!f.contains(key)) return "";
+    const json& v = f[key];
+    if (v.is_string()) return v.get<std::string>();
+    if (v.is_number()) return std::to_string(v.get<double>());
+    return "";
+}
+
+static double filterNum(const json& f, const char* key, double def) {
+    std::string s = filterStr(f, key);
+    return s.empty() ? def : std::atof(s.c_str());
+}
+
+bool SymbolRegistry::parseExchangeInfo(const json& symObj,
+                                       std::string& symbol,
+                                       std::string& baseAsset,
+                                       std::string& quoteAsset,
+                                       SymbolInfo& si,
+                                       SymbolFilters& sf)
+{
+    if (!symObj.contains("symbol") || !symObj.contains("baseAsset") ||
+        !symObj.contains("quoteAsset")) {
+        return false;
+    }
+    symbol     = symObj["symbol"].get<std::string>();
+    baseAsset  = symObj["baseAsset"].get<std::string>();
+    quoteAsset = symObj["quoteAsset"].get<std::string>();
+    si = SymbolInfo{};
+    sf = SymbolFilters{};
+
+    const json* filters = nullptr;
+    if (symObj.contains("filters") && symObj["filters"].is_array()) {
+        filters = &symObj["filters"];
+    }
+
+    // scale first (tick/step), everything else is parsed at that scale
+    if (filters) {
+        for (auto& f : *filters) {
+            std::string ft = f.value("filterType", "");
+            std::string v;
+            if (ft == "PRICE_FILTER" && !(v = filterStr(f, "tickSize")).empty()) {
+                si.priceDecimals = FixedPoint::decimalsOf(v);
+                si.tickRaw       = FixedPoint::parse(v, si.priceDecimals);
+                if (si.tickRaw <= 0) si.tickRaw = 1;
+            } else if (ft == "LOT_SIZE" && !(v = filterStr(f, "stepSize")).empty()) {
+                si.qtyDecimals = FixedPoint::decimalsOf(v);
+                si.stepRaw     = FixedPoint::parse(v, si.qtyDecimals);
+                if (si.stepRaw <= 0) si.stepRaw = 1;
+            }
+        }
+    }
+    sf.minQtyRaw   = FixedPoint::fromDouble(DEFAULT_MIN_QTY, si.qtyDecimals);
+    sf.minNotional = DEFAULT_MIN_NOTIONAL;
+    if (!filters) return true;
+
+    auto qty   = [&](const json& f, const char* k){ return FixedPoint::parse(filterStr(f, k), si.qtyDecimals); };
+    auto price = [&](const json& f, const char* k){ return FixedPoint::parse(filterStr(f, k), si.priceDecimals); };
+
+    for (auto& f : *filters) {
+        std::string ft = f.value("filterType", "");
+        if (ft == "LOT_SIZE") {
+            sf.minQtyRaw = qty(f, "minQty");
+            sf.maxQtyRaw = qty(f, "maxQty");
+        } else if (ft == "MARKET_LOT_SIZE") {
+            sf.marketMinQtyRaw = qty(f, "minQty");
+            sf.marketMaxQtyRaw = qty(f, "maxQty");
+            sf.marketStepRaw   = qty(f, "stepSize");
+        } else if (ft == "PRICE_FILTER") {
+            sf.minPriceRaw = price(f, "minPrice");
+            sf.maxPriceRaw = price(f, "maxPrice");
+        } else if (ft == "MIN_NOTIONAL") {
+            sf.minNotional       = filterNum(f, "minNotional", sf.minNotional);
+            sf.minNotionalMarket = f.value("applyToMarket", true);
+        } else if (ft == "NOTIONAL") {
+            sf.minNotional       = filterNum(f, "minNotional", sf.minNotional);
+            sf.maxNotional       = filterNum(f, "maxNotional", 0.0);
+            sf.minNotionalMarket = f.value("applyMinToMarket", true);
+            sf.maxNotionalMarket = f.value("applyMaxToMarket", false);
+        }
+    }
+    return true;
+}
+
+SymbolId SymbolRegistry::registerFromExchangeInfo(const json& symObj)
+{
+    std::string symbol, base, quote;
+    SymbolInfo si;
+    SymbolFilters sf;
+    if (!parseExchangeInfo(symObj, symbol, base, quote, si, sf)) return INVALID_SYMBOL;
+    return registerSymbol(symbol, base, quote, si, sf);
+}
+
+void SymbolRegistry::overrideMinimums(SymbolId id, double minQty, double minNotional)
+{
+    if (id < 0 || id >= MAX_SYMBOLS) return;
+    std::lock_guard<std::mutex> lk(writeMutex_);
+    SymbolEntry e = *entries_[id].load(std::memory_order_relaxed);
+    e.filters.manualMinQty      = minQty;
+    e.filters.manualMinNotional = minNotional;
+    applyManualMinimums(e);
+    publish(id, e);
+}
+
+void SymbolRegistry::applyManualMinimums(SymbolEntry& e)
+{
+    SymbolFilters& sf = e.filters;
+    if (sf.manualMinQty > 0.0) {
+        sf.minQtyRaw = FixedPoint::fromDouble(sf.manualMinQty, e.info.qtyDecimals);
+    }
+    if (sf.manualMinNotional > 0.0) {
+        sf.minNotional = sf.manualMinNotional;
+    }
+}
+
+int64_t SymbolRegistry::roundQty(SymbolId id, double qty, bool market) const
+{
+    const SymbolEntry& e    = entry(id);
+    const SymbolInfo& si    = e.info;
+    const SymbolFilters& sf = e.filters;
+    int64_t step = (market && sf.marketStepRaw > 0) ? sf.marketStepRaw : si.stepRaw;
+    if (qty <= 0.0) return 0;
+    return FixedPoint::floorToStep(FixedPoint::fromDoubleFloor(qty, si.qtyDecimals), step);
+}
+
+/**
+ * check => first failing filter, in the order Binance reports them.
+ * PRICE_FILTER only constrains limit orders; notional checks follow the
+ * applyToMarket flags.
+ */
+FilterReject SymbolRegistry::check(SymbolId id, int64_t qtyRaw, double price, bool market) const
+{
+    const SymbolEntry& e    = entry(id);
+    const SymbolInfo& si    = e.info;
+    const SymbolFilters& sf = e.filters;
+
+    int64_t minQty = (market && sf.marketMinQtyRaw > 0) ? sf.marketMinQtyRaw : sf.minQtyRaw;
+    int64_t maxQty = (market && sf.marketMaxQtyRaw > 0) ? sf.marketMaxQtyRaw : sf.maxQtyRaw;
+    if (qtyRaw <= 0 || qtyRaw < minQty)     return FilterReject::QTY_BELOW_MIN;
+    if (maxQty > 0 && qtyRaw > maxQty)      return FilterReject::QTY_ABOVE_MAX;
+
+    if (!market) {
+        int64_t pxRaw = FixedPoint::fromDouble(price, si.priceDecimals);
+        if (pxRaw < sf.minPriceRaw || (sf.maxPriceRaw > 0 && pxRaw > sf.maxPriceRaw)) {
+            return FilterReject::PRICE_OUT_OF_RANGE;
+        }
+    }
+
+    double notional = FixedPoint::toDouble(qtyRaw, si.qtyDecimals) * price;
+    if ((!market || sf.minNotionalMarket) && notional < sf.minNotional) {
+        return FilterReject::NOTIONAL_BELOW_MIN;
+    }
+    if ((!market || sf.maxNotionalMarket) && sf.maxNotional > 0.0 && notional > sf.maxNotional) {
+        return FilterReject::NOTIONAL_ABOVE_MAX;
+    }
+    return FilterReject::OK;
+}
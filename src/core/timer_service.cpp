@@ -0,0 +1,133 @@
+#include "core/timer_service.hpp"
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+TimerService& TimerService::instance()
+{
+    static TimerService service;
+    return service;
+}
+
+TimerService::TimerService()
+    : wheel_(TICK_NS, nowNs()),
+      coarseNs_(nowNs())
+{
+}
+
+TimerService::~TimerService()
+{
+    stop();
+}
+
+int64_t TimerService::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TimerService::TimerId TimerService::scheduleAt(int64_t deadlineNs, Callback cb)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return wheel_.schedule(deadlineNs, std::move(cb));
+}
+
+TimerService::TimerId TimerService::scheduleAfter(int64_t delayNs, Callback cb)
+{
+    return scheduleAt(nowNs() + delayNs, std::move(cb));
+}
+
+TimerService::TimerId TimerService::schedulePeriodic(int64_t periodNs, Callback cb)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    TimerId handle = PERIODIC_BIT | nextPeriodic_++;
+    Periodic& p = periodic_[handle];
+    p.periodNs = std::max(periodNs, TICK_NS);
+    p.nextNs   = nowNs() + p.periodNs;
+    p.cb       = std::make_shared<Callback>(std::move(cb));
+    p.current  = wheel_.schedule(p.nextNs, [this, handle](){ firePeriodic(handle); });
+    return handle;
+}
+
+bool TimerService::cancel(TimerId id)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (id & PERIODIC_BIT) {
+        auto it = periodic_.find(id);
+        if (it == periodic_.end()) return false;
+        wheel_.cancel(it->second.current);
+        periodic_.erase(it);
+        return true;
+    }
+    return wheel_.cancel(id);
+}
+
+size_t TimerService::pending() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return wheel_.size();
+}
+
+// re-arm first (so cancel() from inside the job works), then run it
+void TimerService::firePeriodic(TimerId handle)
+{
+    std::shared_ptr<Callback> cb;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = periodic_.find(handle);
+        if (it == periodic_.end()) return;
+        Periodic& p = it->second;
+        int64_t now = nowNs();
+        p.nextNs += p.periodNs;
+        if (p.nextNs <= now) {
+            p.nextNs = now + p.periodNs - (now - p.nextNs) % p.periodNs;
+        }
+        p.current = wheel_.schedule(p.nextNs, [this, handle](){ firePeriodic(handle); });
+        cb = p.cb;
+    }
+    (*cb)();
+}
+
+void TimerService::run()
+{
+    running_.store(true);
+    loop();
+}
+
+void TimerService::loop()
+{
+    std::vector<Callback> due;
+    std::unique_lock<std::mutex> lk(mutex_);
+    while (running_.load(std::memory_order_relaxed)) {
+        int64_t now = nowNs();
+        coarseNs_.store(now, std::memory_order_relaxed);
+        due.clear();
+        wheel_.advance(now, due);
+        if (!due.empty()) {
+            lk.unlock();
+            for (auto& cb : due) cb();
+            lk.lock();
+            continue;
+        }
+        cv_.wait_for(lk, std::chrono::nanoseconds(TICK_NS));
+    }
+}
+
+void TimerService::start()
+{
+    if (thread_.joinable()) return;
+    running_.store(true);
+    thread_ = std::thread([this](){ loop(); });
+}
+
+void TimerService::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        running_.store(false);
+    }
+    cv_.notify_all();
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
@@ -0,0 +1,154 @@
+#include "core/timer_wheel.hpp"
+#include <algorithm>
+
+static constexpr int64_t SLOT_MASK = TimerWheel::SLOTS - 1;
+
+TimerWheel::TimerWheel(int64_t tickNs, int64_t nowNs)
+    : tickNs_(std::max<int64_t>(1, tickNs)),
+      originNs_(nowNs)
+{
+    for (auto& level : heads_) {
+        std::fill(std::begin(level), std::end(level), -1);
+    }
+}
+
+TimerWheel::TimerId TimerWheel::schedule(int64_t deadlineNs, Callback cb)
+{
+    int idx;
+    if (!free_.empty()) {
+        idx = free_.back();
+        free_.pop_back();
+    } else {
+        idx = (int)nodes_.size();
+        nodes_.emplace_back();
+    }
+    Node& n = nodes_[idx];
+    int64_t rel = deadlineNs - originNs_;
+    n.tick = (rel > 0 ? (rel + tickNs_ - 1) / tickNs_ : 0);
+    if (n.tick <= curTick_) n.tick = curTick_ + 1; // this tick's bucket already fired
+    n.cb = std::move(cb);
+    place(idx);
+    active_++;
+    return ((TimerId)n.gen << 32) | (TimerId)(idx + 1);
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    int idx = (int)(id & 0xffffffffu) - 1;
+    if (idx < 0 || idx >= (int)nodes_.size()) return false;
+    Node& n = nodes_[idx];
+    if (n.level < 0 || n.gen != (uint32_t)(id >> 32)) return false;
+    unlink(idx);
+    release(idx);
+    return true;
+}
+
+size_t TimerWheel::advance(int64_t nowNs, std::vector<Callback>& due)
+{
+    const int64_t target = (nowNs - originNs_) / tickNs_;
+    size_t fired = 0;
+    while (curTick_ < target) {
+        if (active_ == 0) { // nothing can fire: jump straight there
+            curTick_ = target;
+            break;
+        }
+        curTick_++;
+
+        // a higher level's bucket comes due when every digit below it wraps to 0
+        for (int level = LEVELS - 1; level >= 1; level--) {
+            if ((curTick_ & ((int64_t(1) << (level * SLOT_BITS)) - 1)) == 0) cascade(level);
+        }
+
+        int& head = heads_[0][curTick_ & SLOT_MASK];
+        int idx = head;
+        head = -1;
+        while (idx >= 0) {
+            int next = nodes_[idx].next;
+            due.push_back(std::move(nodes_[idx].cb));
+            release(idx);
+            fired++;
+            idx = next;
+        }
+    }
+    return fired;
+}
+
+void TimerWheel::clear()
+{
+    for (auto& level : heads_) {
+        std::fill(std::begin(level), std::end(level), -1);
+    }
+    free_.clear();
+    for (int i = (int)nodes_.size() - 1; i >= 0; i--) {
+        Node& n = nodes_[i];
+        if (n.level >= 0) n.gen++; // outstanding ids no longer cancel anything
+        n.cb = nullptr;
+        n.level = n.slot = -1;
+        n.prev = n.next = -1;
+        free_.push_back(i);
+    }
+    active_ = 0;
+}
+
+// lowest level whose higher digits match the current tick (tick >= curTick_)
+void TimerWheel::place(int idx)
+{
+    Node& n = nodes_[idx];
+    int level = LEVELS - 1;
+    int slot;
+    if (n.tick <= curTick_) {
+        level = 0;
+        slot = (int)(curTick_ & SLOT_MASK);
+    } else {
+        slot = -1;
+        for (int l = 0; l < LEVELS; l++) {
+            int shift = (l + 1) * SLOT_BITS;
+            if ((n.tick >> shift) == (curTick_ >> shift)) {
+                level = l;
+                slot = (int)((n.tick >> (l * SLOT_BITS)) & SLOT_MASK);
+                break;
+            }
+        }
+        if (slot < 0) {
+            // beyond the top level's reach: park in its last bucket, re-placed on cascade
+            slot = (int)(((curTick_ >> ((LEVELS - 1) * SLOT_BITS)) - 1) & SLOT_MASK);
+        }
+    }
+    n.level = level;
+    n.slot  = slot;
+    n.prev  = -1;
+    n.next  = heads_[level][slot];
+    if (n.next >= 0) nodes_[n.next].prev = idx;
+    heads_[level][slot] = idx;
+}
+
+void TimerWheel::unlink(int idx)
+{
+    Node& n = nodes_[idx];
+    if (n.prev >= 0) nodes_[n.prev].next = n.next;
+    else heads_[n.level][n.slot] = n.next;
+    if (n.next >= 0) nodes_[n.next].prev = n.prev;
+    n.prev = n.next = -1;
+}
+
+void TimerWheel::release(int idx)
+{
+    Node& n = nodes_[idx];
+    n.cb = nullptr;
+    n.level = n.slot = -1;
+    n.gen++;
+    free_.push_back(idx);
+    active_--;
+}
+
+void TimerWheel::cascade(int level)
+{
+    int& head = heads_[level][(curTick_ >> (level * SLOT_BITS)) & SLOT_MASK];
+    int idx = head;
+    head = -1;
+    while (idx >= 0) {
+        int next = nodes_[idx].next;
+        place(idx);
+        idx = next;
+    }
+}
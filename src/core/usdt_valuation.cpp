@@ -0,0 +1,63 @@
+#include "core/usdt_valuation.hpp"
+
+UsdtValuation& UsdtValuation::instance()
+{
+    static UsdtValuation valuation;
+    return valuation;
+}
+
+UsdtValuation::UsdtValuation()
+    : usdt_(AssetRegistry::instance().intern("USDT"))
+{
+    for (int i = 0; i < AssetRegistry::MAX_ASSETS; i++) {
+        direct_[i].store(0.0, std::memory_order_relaxed);
+        cross_[i].store(0.0, std::memory_order_relaxed);
+        via_[i].store(INVALID_ASSET, std::memory_order_relaxed);
+    }
+}
+
+void UsdtValuation::onTopOfBook(SymbolId symbol, double bestBid, double bestAsk)
+{
+    if (symbol < 0 || symbol >= SymbolRegistry::MAX_SYMBOLS) return;
+    const SymbolInfo& si = SymbolRegistry::instance().info(symbol);
+    const AssetId base = si.baseAsset, quote = si.quoteAsset;
+    if (base < 0 || quote < 0) return;
+
+    // an empty side keeps the last known price (valuation, not execution)
+    if (quote == usdt_) {
+        if (bestBid > 0.0) direct_[base].store(bestBid, std::memory_order_relaxed);
+    } else if (base == usdt_) {
+        if (bestAsk > 0.0) direct_[quote].store(1.0 / bestAsk, std::memory_order_relaxed);
+    } else {
+        if (bestBid > 0.0) adoptCross(base, quote, bestBid);
+        if (bestAsk > 0.0) adoptCross(quote, base, 1.0 / bestAsk);
+    }
+}
+
+void UsdtValuation::adoptCross(AssetId asset, AssetId partner, double rate)
+{
+    AssetId via = via_[asset].load(std::memory_order_relaxed);
+    if (via != partner) {
+        // first bridge seen, or the current one can't be valued and this one can
+        bool better = (via == INVALID_ASSET)
+                   || (direct_[via].load(std::memory_order_relaxed) <= 0.0
+                       && direct_[partner].load(std::memory_order_relaxed) > 0.0);
+        if (!better) return;
+        via_[asset].store(partner, std::memory_order_relaxed);
+    }
+    cross_[asset].store(rate, std::memory_order_relaxed);
+}
+
+double UsdtValuation::price(AssetId asset) const
+{
+    if (asset < 0 || asset >= AssetRegistry::MAX_ASSETS) return 0.0;
+    if (asset == usdt_) return 1.0;
+
+    double direct = direct_[asset].load(std::memory_order_relaxed);
+    if (direct > 0.0) return direct;
+
+    AssetId via = via_[asset].load(std::memory_order_relaxed);
+    if (via < 0) return 0.0;
+    double viaPx = (via == usdt_) ? 1.0 : direct_[via].load(std::memory_order_relaxed);
+    return cross_[asset].load(std::memory_order_relaxed) * viaPx;
+}
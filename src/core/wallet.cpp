@@ -1,42 +1,152 @@
 #include "core/wallet.hpp"
+#include "core/wallet_journal.hpp"
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <algorithm>
 
 // For JSON
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
-Wallet::Wallet() {
-    balances_["BTC"]  = 0.0;
-    balances_["ETH"]  = 0.0;
-    balances_["USDT"] = 0.0;
+Wallet::Wallet()
+    : slots_(new WalletSlot[AssetRegistry::MAX_ASSETS])
+{
+    slotFor("BTC");
+    slotFor("ETH");
+    slotFor("USDT");
+}
+
+/**
+ * slotFor => intern the asset and mark its slot as in use.
+ * nullptr only if the registry is full.
+ */
+static inline int64_t toRaw(double v) {
+    return FixedPoint::fromDouble(v, Wallet::DECIMALS);
+}
+
+static inline double fromRaw(int64_t raw) {
+    return FixedPoint::toDouble(raw, Wallet::DECIMALS);
+}
+
+WalletSlot* Wallet::slotFor(const std::string& asset) {
+    AssetId id = AssetRegistry::instance().intern(asset);
+    if (id == INVALID_ASSET) return nullptr;
+    WalletSlot& slot = slots_[id];
+    if (!slot.used.load(std::memory_order_relaxed)) {
+        slot.used.store(true, std::memory_order_release);
+    }
+    return &slot;
+}
 
-    locked_["BTC"]    = 0.0;
-    locked_["ETH"]    = 0.0;
-    locked_["USDT"]   = 0.0;
+uint64_t Wallet::lockSlot(WalletSlot& slot) const {
+    uint64_t s = slot.seq.load(std::memory_order_relaxed);
+    while (true) {
+        if ((s & 1) == 0 &&
+            slot.seq.compare_exchange_weak(s, s + 1,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+            return s + 1;
+        }
+        std::this_thread::yield();
+        s = slot.seq.load(std::memory_order_relaxed);
+    }
+}
+
+void Wallet::unlockSlot(WalletSlot& slot, uint64_t seq) const {
+    slot.seq.store(seq + 1, std::memory_order_release);
+}
+
+void Wallet::readSlot(AssetId id, int64_t& total, int64_t& locked) const {
+    const WalletSlot& slot = slots_[id];
+    while (true) {
+        uint64_t s1 = slot.seq.load(std::memory_order_acquire);
+        if (s1 & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        total  = slot.total.load(std::memory_order_relaxed);
+        locked = slot.locked.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == s1) return;
+    }
 }
 
 void Wallet::setBalance(const std::string& asset, double amount) {
-    std::lock_guard<std::mutex> lk(walletMutex_);
-    balances_[asset] = amount;
-    if (!locked_.count(asset)) {
-        locked_[asset] = 0.0;
+    WalletSlot* slot = slotFor(asset);
+    if (!slot) return;
+    uint64_t s = lockSlot(*slot);
+    slot->total.store(toRaw(amount), std::memory_order_relaxed);
+    if (journal_) {
+        journal_->appendSet(AssetRegistry::instance().find(asset),
+                            slot->total.load(std::memory_order_relaxed),
+                            slot->locked.load(std::memory_order_relaxed));
     }
+    unlockSlot(*slot, s);
+}
+
+void Wallet::setBalances(const std::string& asset, double free, double locked) {
+    WalletSlot* slot = slotFor(asset);
+    if (!slot) return;
+    uint64_t s = lockSlot(*slot);
+    int64_t l = toRaw(locked);
+    if (slot->holds > 0) {
+        // replaces anything parked before it
+        slot->pendingSet    = true;
+        slot->pendingTotal  = toRaw(free) + l;
+        slot->pendingLocked = l;
+        slot->pendingDelta  = 0;
+        unlockSlot(*slot, s);
+        return;
+    }
+    slot->total.store(toRaw(free) + l, std::memory_order_relaxed);
+    slot->locked.store(l, std::memory_order_relaxed);
+    if (journal_) {
+        journal_->appendSet(AssetRegistry::instance().find(asset), toRaw(free) + l, l);
+    }
+    unlockSlot(*slot, s);
+}
+
+void Wallet::adjustBalance(const std::string& asset, double delta) {
+    WalletSlot* slot = slotFor(asset);
+    if (!slot) return;
+    uint64_t s = lockSlot(*slot);
+    if (slot->holds > 0) {
+        slot->pendingDelta += toRaw(delta);
+        unlockSlot(*slot, s);
+        return;
+    }
+    int64_t t = slot->total.load(std::memory_order_relaxed) + toRaw(delta);
+    slot->total.store(t < 0 ? 0 : t, std::memory_order_relaxed);
+    if (journal_) {
+        journal_->appendSet(AssetRegistry::instance().find(asset),
+                            (t < 0 ? 0 : t),
+                            slot->locked.load(std::memory_order_relaxed));
+    }
+    unlockSlot(*slot, s);
 }
 
 double Wallet::getFreeBalance(const std::string& asset) const {
-    std::lock_guard<std::mutex> lk(walletMutex_);
-    if (!balances_.count(asset)) return 0.0;
-    double t = balances_.at(asset);
-    double l = locked_.at(asset);
-    double f = t - l;
-    return (f<0.0? 0.0 : f);
+    return getFreeBalance(AssetRegistry::instance().find(asset));
+}
+
+double Wallet::getFreeBalance(AssetId id) const {
+    if (id < 0 || id >= AssetRegistry::MAX_ASSETS) return 0.0;
+    int64_t t = 0, l = 0;
+    readSlot(id, t, l);
+    int64_t f = t - l;
+    return (f<0? 0.0 : fromRaw(f));
 }
 
 double Wallet::getTotalBalance(const std::string& asset) const {
-    std::lock_guard<std::mutex> lk(walletMutex_);
-    if (!balances_.count(asset)) return 0.0;
-    return balances_.at(asset);
+    return getTotalBalance(AssetRegistry::instance().find(asset));
+}
+
+double Wallet::getTotalBalance(AssetId id) const {
+    if (id < 0 || id >= AssetRegistry::MAX_ASSETS) return 0.0;
+    int64_t t = 0, l = 0;
+    readSlot(id, t, l);
+    return fromRaw(t);
 }
 
 WalletTransaction Wallet::beginTransaction() {
@@ -45,46 +155,117 @@ WalletTransaction Wallet::beginTransaction() {
     return tx;
 }
 
+WalletTransaction Wallet::beginTransaction(const AssetId* ids, size_t count) {
+    WalletTransaction tx = beginTransaction();
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] < 0 || ids[i] >= AssetRegistry::MAX_ASSETS) continue;
+        WalletSlot& slot = slots_[ids[i]];
+        uint64_t s = lockSlot(slot);
+        holdLocked(tx, ids[i]);
+        unlockSlot(slot, s);
+    }
+    return tx;
+}
+
+void Wallet::holdLocked(WalletTransaction& tx, AssetId id) {
+    if (std::find(tx.held.begin(), tx.held.end(), id) != tx.held.end()) return;
+    slots_[id].holds++;
+    tx.held.push_back(id);
+}
+
+/**
+ * releaseHolds => the exchange's word wins: a position reported while tx
+ * was open already includes its fills, so it overwrites what tx booked
+ * (after the journal got tx, so replay ends on the same SET).
+ */
+void Wallet::releaseHolds(WalletTransaction& tx) {
+    for (AssetId id : tx.held) {
+        WalletSlot& slot = slots_[id];
+        uint64_t s = lockSlot(slot);
+        if (--slot.holds == 0 && (slot.pendingSet || slot.pendingDelta != 0)) {
+            int64_t t = slot.pendingSet ? slot.pendingTotal  : slot.total.load(std::memory_order_relaxed);
+            int64_t l = slot.pendingSet ? slot.pendingLocked : slot.locked.load(std::memory_order_relaxed);
+            t += slot.pendingDelta;
+            if (t < 0) t = 0;
+            slot.total.store(t, std::memory_order_relaxed);
+            slot.locked.store(l, std::memory_order_relaxed);
+            slot.pendingSet   = false;
+            slot.pendingDelta = 0;
+            if (journal_) journal_->appendSet(id, t, l);
+        }
+        unlockSlot(slot, s);
+    }
+    tx.held.clear();
+}
+
 bool Wallet::applyChange(WalletTransaction& tx,
                          const std::string& asset,
                          double deltaBalance,
                          double deltaLocked)
 {
     if (!tx.active) return false;
-    std::lock_guard<std::mutex> lk(walletMutex_);
+    if (!slotFor(asset)) return false;
+    return applyChange(tx, AssetRegistry::instance().find(asset), deltaBalance, deltaLocked);
+}
 
-    if (!balances_.count(asset)) {
-        balances_[asset] = 0.0;
-        locked_[asset]   = 0.0;
+/**
+ * Validate + apply under the asset's slot lock only. Changes are applied
+ * immediately (as before) and undone by rollbackTransaction.
+ */
+bool Wallet::applyChange(WalletTransaction& tx,
+                         AssetId id,
+                         double deltaBalance,
+                         double deltaLocked)
+{
+    if (!tx.active) return false;
+    if (id < 0 || id >= AssetRegistry::instance().size()) return false;
+
+    WalletSlot& slot = slots_[id];
+    if (!slot.used.load(std::memory_order_relaxed)) {
+        slot.used.store(true, std::memory_order_release);
     }
-    double newBal = balances_[asset] + deltaBalance;
-    double newLock= locked_[asset]   + deltaLocked;
 
-    if (newBal < 0.0 || newLock < 0.0) {
+    int64_t dBal  = toRaw(deltaBalance);
+    int64_t dLock = toRaw(deltaLocked);
+
+    uint64_t s = lockSlot(slot);
+    int64_t newBal = slot.total.load(std::memory_order_relaxed)  + dBal;
+    int64_t newLock= slot.locked.load(std::memory_order_relaxed) + dLock;
+
+    if (newBal < 0 || newLock < 0 || newLock > newBal) {
+        // can't go negative or lock more than total
+        unlockSlot(slot, s);
         return false;
     }
-    if (newLock > newBal) {
-        return false; // can't lock more than total
-    }
+    slot.total.store(newBal, std::memory_order_relaxed);
+    slot.locked.store(newLock, std::memory_order_relaxed);
+    holdLocked(tx, id);
+    // ordered against SETs of this asset, which also take theirs under the lock
+    uint64_t journalSeq = journal_ ? journal_->reserveSeq() : 0;
+    unlockSlot(slot, s);
 
     // record
     WalletChange c;
-    c.asset = asset;
+    c.asset        = AssetRegistry::instance().name(id);
+    c.assetId      = id;
     c.deltaBalance = deltaBalance;
     c.deltaLocked  = deltaLocked;
+    c.deltaBalanceRaw = dBal;
+    c.deltaLockedRaw  = dLock;
+    c.journalSeq      = journalSeq;
     tx.changes.push_back(c);
-
-    // apply
-    balances_[asset] = newBal;
-    locked_[asset]   = newLock;
-
     return true;
 }
 
 bool Wallet::commitTransaction(WalletTransaction& tx) {
     if (!tx.active) return false;
     tx.active = false;
-    // changes are already applied in applyChange
+    // changes are already applied in applyChange; only the log write is left
+    // (queued, the journal's writer thread does the I/O)
+    if (journal_ && !tx.changes.empty()) {
+        journal_->appendTransaction(tx);
+    }
+    releaseHolds(tx);
     return true;
 }
 
@@ -92,27 +273,70 @@ void Wallet::rollbackTransaction(WalletTransaction& tx) {
     if (!tx.active) return;
     tx.active = false;
 
-    std::lock_guard<std::mutex> lk(walletMutex_);
+    // a SET taken while the changes were applied includes them, so the
+    // journal gets the changes and their reversal (net zero otherwise)
+    WalletTransaction undo;
+    if (journal_) undo.changes = tx.changes;
+
     // revert in reverse order
     for (auto it = tx.changes.rbegin(); it != tx.changes.rend(); ++it) {
         auto &ch = *it;
-        balances_[ch.asset] -= ch.deltaBalance;
-        locked_[ch.asset]   -= ch.deltaLocked;
-        if (balances_[ch.asset] < 0.0) balances_[ch.asset] = 0.0;
-        if (locked_[ch.asset] < 0.0)   locked_[ch.asset]   = 0.0;
+        WalletSlot& slot = slots_[ch.assetId];
+        uint64_t s = lockSlot(slot);
+        int64_t t = slot.total.load(std::memory_order_relaxed)  - ch.deltaBalanceRaw;
+        int64_t l = slot.locked.load(std::memory_order_relaxed) - ch.deltaLockedRaw;
+        slot.total.store(t < 0 ? 0 : t, std::memory_order_relaxed);
+        slot.locked.store(l < 0 ? 0 : l, std::memory_order_relaxed);
+        if (journal_) {
+            WalletChange rev = ch;
+            rev.deltaBalance    = -ch.deltaBalance;
+            rev.deltaLocked     = -ch.deltaLocked;
+            rev.deltaBalanceRaw = -ch.deltaBalanceRaw;
+            rev.deltaLockedRaw  = -ch.deltaLockedRaw;
+            rev.journalSeq      = journal_->reserveSeq();
+            undo.changes.push_back(rev);
+        }
+        unlockSlot(slot, s);
     }
+    if (journal_ && !undo.changes.empty()) {
+        journal_->appendTransaction(undo);
+    }
+    releaseHolds(tx);
+}
+
+std::vector<WalletBalance> Wallet::balancesRaw() const {
+    auto& reg = AssetRegistry::instance();
+    std::vector<WalletBalance> out;
+    for (AssetId id = 0; id < reg.size(); id++) {
+        if (!slots_[id].used.load(std::memory_order_acquire)) continue;
+        int64_t t = 0, l = 0;
+        readSlot(id, t, l);
+        out.push_back({reg.name(id), t, l});
+    }
+    return out;
+}
+
+void Wallet::restoreRaw(const std::string& asset, int64_t totalRaw, int64_t lockedRaw) {
+    WalletSlot* slot = slotFor(asset);
+    if (!slot) return;
+    uint64_t s = lockSlot(*slot);
+    slot->total.store(totalRaw, std::memory_order_relaxed);
+    slot->locked.store(lockedRaw, std::memory_order_relaxed);
+    unlockSlot(*slot, s);
 }
 
 void Wallet::printAll() const {
-    std::lock_guard<std::mutex> lk(walletMutex_);
+    std::lock_guard<std::mutex> lk(ioMutex_);
+    auto& reg = AssetRegistry::instance();
     std::cout << "[WALLET] Balances:\n";
-    for (auto &kv : balances_) {
-        double l = locked_.at(kv.first);
-        double f = kv.second - l;
-        std::cout << "  " << kv.first 
-                  << ": total=" << kv.second 
-                  << " locked=" << l
-                  << " free=" << f << "\n";
+    for (AssetId id = 0; id < reg.size(); id++) {
+        if (!slots_[id].used.load(std::memory_order_acquire)) continue;
+        int64_t t = 0, l = 0;
+        readSlot(id, t, l);
+        std::cout << "  " << reg.name(id)
+                  << ": total=" << FixedPoint::toString(t, DECIMALS)
+                  << " locked=" << FixedPoint::toString(l, DECIMALS)
+                  << " free=" << FixedPoint::toString(t - l, DECIMALS) << "\n";
     }
 }
 
@@ -121,16 +345,17 @@ void Wallet::printAll() const {
  */
 void Wallet::saveToFile(const std::string& filename) const
 {
-    std::lock_guard<std::mutex> lk(walletMutex_);
+    std::lock_guard<std::mutex> lk(ioMutex_);
+    auto& reg = AssetRegistry::instance();
 
     json j;
-    // store balances
-    for (auto &kv : balances_) {
-        j["balances"][kv.first] = kv.second;
-    }
-    // store locked
-    for (auto &lv : locked_) {
-        j["locked"][lv.first] = lv.second;
+    // store balances + locked (per-asset consistent snapshot)
+    for (AssetId id = 0; id < reg.size(); id++) {
+        if (!slots_[id].used.load(std::memory_order_acquire)) continue;
+        int64_t t = 0, l = 0;
+        readSlot(id, t, l);
+        j["balances"][reg.name(id)] = fromRaw(t);
+        j["locked"][reg.name(id)]   = fromRaw(l);
     }
 
     // attempt to write
@@ -150,7 +375,7 @@ void Wallet::saveToFile(const std::string& filename) const
  */
 bool Wallet::loadFromFile(const std::string& filename)
 {
-    std::lock_guard<std::mutex> lk(walletMutex_);
+    std::lock_guard<std::mutex> lk(ioMutex_);
 
     std::ifstream ifs(filename);
     if (!ifs.is_open()) {
@@ -165,23 +390,26 @@ bool Wallet::loadFromFile(const std::string& filename)
         // parse balances
         if (j.contains("balances") && j["balances"].is_object()) {
             for (auto it = j["balances"].begin(); it != j["balances"].end(); ++it) {
-                std::string asset = it.key();
-                double bal = it.value().get<double>();
-                balances_[asset] = bal;
-                if (!locked_.count(asset)) {
-                    locked_[asset] = 0.0;
-                }
+                WalletSlot* slot = slotFor(it.key());
+                if (!slot) continue;
+                uint64_t s = lockSlot(*slot);
+                slot->total.store(toRaw(it.value().get<double>()), std::memory_order_relaxed);
+                unlockSlot(*slot, s);
             }
         }
-        // parse locked
+        // parse locked (if an asset only has a locked entry, total = locked)
         if (j.contains("locked") && j["locked"].is_object()) {
+            bool hasBalances = j.contains("balances") && j["balances"].is_object();
             for (auto it = j["locked"].begin(); it != j["locked"].end(); ++it) {
-                std::string asset = it.key();
-                double lockVal = it.value().get<double>();
-                locked_[asset] = lockVal;
-                if (!balances_.count(asset)) {
-                    balances_[asset] = lockVal;
+                WalletSlot* slot = slotFor(it.key());
+                if (!slot) continue;
+                int64_t lockVal = toRaw(it.value().get<double>());
+                uint64_t s = lockSlot(*slot);
+                slot->locked.store(lockVal, std::memory_order_relaxed);
+                if (!hasBalances || !j["balances"].contains(it.key())) {
+                    slot->total.store(lockVal, std::memory_order_relaxed);
                 }
+                unlockSlot(*slot, s);
             }
         }
 
@@ -0,0 +1,496 @@
+#include "core/wallet_journal.hpp"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * On-disk formats (little-endian, as written by this host):
+ *
+ * log record : u32 bodyLen | body | u32 fnv1a(body)
+ *   body     : u8 type | u64 seq | u16 count | count x entry
+ *   entry    : u8 nameLen | name | i64 a | i64 b [| u64 seq (DELTA only)]
+ *
+ * snapshot   : u32 magic | u32 version | u64 lastSeq | u32 count
+ *              | count x (entry | u64 setSeq (v2)) | u32 fnv1a(everything before)
+ *
+ * Names (not AssetIds) go to disk since ids depend on intern order.
+ */
+
+static constexpr uint32_t SNAP_MAGIC   = 0x50534E57; // "WNSP"
+static constexpr uint32_t SNAP_VERSION = 2;
+static constexpr uint32_t MAX_RECORD   = 1u << 20;
+static constexpr int WRITE_ATTEMPTS    = 3;
+
+static uint32_t fnv1a(const char* data, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+template <typename T>
+static void put(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+static bool get(const char*& p, const char* end, T& v) {
+    if ((size_t)(end - p) < sizeof(T)) return false;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+static void putEntry(std::string& out, const std::string& name, int64_t a, int64_t b) {
+    uint8_t n = (uint8_t)(name.size() > 255 ? 255 : name.size());
+    put(out, n);
+    out.append(name.data(), n);
+    put(out, a);
+    put(out, b);
+}
+
+static bool getEntry(const char*& p, const char* end, std::string& name, int64_t& a, int64_t& b) {
+    uint8_t n = 0;
+    if (!get(p, end, n) || (size_t)(end - p) < n) return false;
+    name.assign(p, n);
+    p += n;
+    return get(p, end, a) && get(p, end, b);
+}
+
+static bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t w = ::write(fd, data, len);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += w;
+        len  -= (size_t)w;
+    }
+    return true;
+}
+
+static bool readFile(const std::string& path, std::string& out) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) return false;
+    out.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    return true;
+}
+
+WalletJournal::WalletJournal(const std::string& basePath)
+    : walPath_(basePath + ".wal")
+    , snapPath_(basePath + ".snap")
+    , shadow_(AssetRegistry::MAX_ASSETS)
+{
+}
+
+WalletJournal::~WalletJournal() {
+    stop();
+}
+
+/**
+ * recover => snapshot first, then every log record newer than it.
+ * Stops at the first torn/corrupt record and cuts the log there, since
+ * anything after it was never acknowledged as durable.
+ */
+bool WalletJournal::recover(Wallet& wallet)
+{
+    std::unordered_map<std::string, Balance> state;
+    uint64_t snapSeq = 0;
+    bool found = false;
+
+    std::string buf;
+    if (readFile(snapPath_, buf) && buf.size() >= 24) {
+        const char* p   = buf.data();
+        const char* end = buf.data() + buf.size() - 4;
+        uint32_t magic = 0, version = 0, count = 0, sum = 0;
+        std::memcpy(&sum, end, 4);
+
+        if (fnv1a(buf.data(), buf.size() - 4) == sum
+            && get(p, end, magic) && magic == SNAP_MAGIC
+            && get(p, end, version) && (version == 1 || version == SNAP_VERSION)
+            && get(p, end, snapSeq) && get(p, end, count))
+        {
+            for (uint32_t i = 0; i < count; i++) {
+                std::string name; Balance b;
+                if (!getEntry(p, end, name, b.total, b.locked)) break;
+                if (version >= 2 && !get(p, end, b.setSeq)) break;
+                state[name] = b;
+            }
+            found = true;
+        } else {
+            std::cerr << "[JOURNAL] Snapshot " << snapPath_ << " is corrupt, ignoring it.\n";
+            snapSeq = 0;
+        }
+    }
+
+    uint64_t lastSeq = snapSeq;
+    size_t replayed = 0;
+    if (readFile(walPath_, buf)) {
+        const char* start = buf.data();
+        const char* p     = start;
+        const char* end   = start + buf.size();
+        size_t goodLen = 0;
+
+        while (p < end) {
+            uint32_t len = 0, sum = 0;
+            if (!get(p, end, len) || len > MAX_RECORD || (size_t)(end - p) < (size_t)len + 4) break;
+            const char* body = p;
+            const char* bodyEnd = p + len;
+            std::memcpy(&sum, bodyEnd, 4);
+            if (fnv1a(body, len) != sum) break;
+
+            uint8_t type = 0; uint64_t seq = 0; uint16_t count = 0;
+            const char* q = body;
+            if (!get(q, bodyEnd, type) || !get(q, bodyEnd, seq) || !get(q, bodyEnd, count)) break;
+
+            bool ok = true;
+            std::vector<std::pair<std::string, Entry>> entries;
+            for (uint16_t i = 0; i < count && ok; i++) {
+                std::string name; Entry e{INVALID_ASSET, 0, 0};
+                ok = getEntry(q, bodyEnd, name, e.a, e.b)
+                  && (type != REC_DELTA || get(q, bodyEnd, e.seq));
+                if (ok) entries.push_back({name, e});
+            }
+            if (!ok) break;
+
+            if (seq > snapSeq) {
+                for (auto& e : entries) {
+                    applyEntry(state[e.first], (RecordType)type, seq, e.second);
+                }
+                replayed++;
+            }
+            if (seq > lastSeq) lastSeq = seq;
+
+            p = bodyEnd + 4;
+            goodLen = (size_t)(p - start);
+        }
+
+        if (goodLen < buf.size()) {
+            std::cerr << "[JOURNAL] Dropping " << (buf.size() - goodLen)
+                      << " bytes of torn log tail.\n";
+            if (::truncate(walPath_.c_str(), (off_t)goodLen) != 0) {
+                std::cerr << "[JOURNAL] Could not truncate " << walPath_ << "\n";
+            }
+        }
+        if (goodLen > 0) found = true;
+    }
+
+    for (auto& kv : state) {
+        wallet.restoreRaw(kv.first, kv.second.total, kv.second.locked);
+    }
+    nextSeq_ = lastSeq + 1;
+
+    if (found) {
+        std::cout << "[JOURNAL] Recovered " << state.size() << " assets (snapshot seq="
+                  << snapSeq << ", replayed " << replayed << " records).\n";
+    }
+    return found;
+}
+
+bool WalletJournal::start(Wallet* wallet)
+{
+    if (running_.load()) return true;
+    wallet_ = wallet;
+
+    // nothing is trading yet, so the live wallet is a consistent base
+    for (auto& b : shadow_) b = Balance{};
+    for (const auto& wb : wallet_->balancesRaw()) {
+        AssetId id = AssetRegistry::instance().find(wb.asset);
+        if (id == INVALID_ASSET) continue;
+        shadow_[id].total  = wb.totalRaw;
+        shadow_[id].locked = wb.lockedRaw;
+        shadow_[id].used   = true;
+    }
+    durableSeq_ = nextSeq_ - 1;
+    lastQueuedSeq_ = durableSeq_;
+
+    // snapshot covers everything so far => start with an empty log
+    if (!writeSnapshot(durableSeq_) || !openLog(/*truncate=*/true)) {
+        std::cerr << "[JOURNAL] Could not start, wallet will not be persisted.\n";
+        return false;
+    }
+
+    running_ = true;
+    writerThread_ = std::thread([this](){ runWriter(); });
+    wallet_->setJournal(this);
+    std::cout << "[JOURNAL] Writing to " << walPath_ << "\n";
+    return true;
+}
+
+void WalletJournal::stop()
+{
+    if (!running_.load()) return;
+    if (wallet_) wallet_->setJournal(nullptr);
+
+    {
+        std::lock_guard<std::mutex> lk(appendMutex_);
+        running_ = false;
+    }
+    appendCv_.notify_all();
+    if (writerThread_.joinable()) writerThread_.join();
+
+    writeSnapshot(durableSeq_);
+    closeLog();
+    openLog(/*truncate=*/true);
+    closeLog();
+    std::cout << "[JOURNAL] Stopped after " << recordsWritten_.load()
+              << " records, " << syncs_.load() << " syncs.\n";
+}
+
+uint64_t WalletJournal::reserveSeq()
+{
+    std::lock_guard<std::mutex> lk(appendMutex_);
+    return nextSeq_++;
+}
+
+void WalletJournal::appendTransaction(const WalletTransaction& tx)
+{
+    PendingRecord rec;
+    rec.type = REC_DELTA;
+    rec.entries.reserve(tx.changes.size());
+    for (const auto& ch : tx.changes) {
+        rec.entries.push_back({ch.assetId, ch.deltaBalanceRaw, ch.deltaLockedRaw, ch.journalSeq});
+    }
+    {
+        std::lock_guard<std::mutex> lk(appendMutex_);
+        rec.seq = nextSeq_++;
+        lastQueuedSeq_ = rec.seq;
+        pending_.push_back(std::move(rec));
+    }
+    // no notify: the writer picks it up within one group-commit interval
+}
+
+void WalletJournal::appendSet(AssetId id, int64_t totalRaw, int64_t lockedRaw)
+{
+    if (id == INVALID_ASSET) return;
+    PendingRecord rec;
+    rec.type = REC_SET;
+    rec.entries.push_back({id, totalRaw, lockedRaw});
+    std::lock_guard<std::mutex> lk(appendMutex_);
+    rec.seq = nextSeq_++;
+    lastQueuedSeq_ = rec.seq;
+    pending_.push_back(std::move(rec));
+}
+
+bool WalletJournal::flush()
+{
+    {
+        std::lock_guard<std::mutex> lk(durableMutex_);
+        writeFailed_ = false; // report on the attempt this flush triggers
+    }
+    uint64_t target;
+    {
+        std::lock_guard<std::mutex> lk(appendMutex_);
+        target = lastQueuedSeq_;
+        flushRequested_ = true;
+    }
+    appendCv_.notify_all();
+
+    std::unique_lock<std::mutex> lk(durableMutex_);
+    durableCv_.wait(lk, [&]{ return durableSeq_ >= target || writeFailed_ || !running_.load(); });
+    return durableSeq_ >= target;
+}
+
+/**
+ * runWriter => every groupCommit_ (or on flush()), take all queued records,
+ * write them with one write() + one fdatasync().
+ */
+void WalletJournal::runWriter()
+{
+    std::vector<PendingRecord> batch;
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lk(appendMutex_);
+            appendCv_.wait_for(lk, groupCommit_, [this]{
+                return !running_.load() || flushRequested_;
+            });
+            batch.swap(pending_);
+            flushRequested_ = false;
+            stopping = !running_.load();
+        }
+
+        if (!batch.empty()) {
+            if (!writeBatch(batch) && !stopping) {
+                // keep them (in order) ahead of anything queued meanwhile
+                std::lock_guard<std::mutex> lk(appendMutex_);
+                pending_.insert(pending_.begin(),
+                                std::make_move_iterator(batch.begin()),
+                                std::make_move_iterator(batch.end()));
+            } else if (stopping && durableSeq_ < batch.back().seq) {
+                std::cerr << "[JOURNAL] " << batch.size()
+                          << " records could not be written before stopping.\n";
+            }
+            batch.clear();
+        }
+        if (stopping) break;
+
+        if (sinceSnapshot_ >= snapshotEvery_) {
+            // compact: snapshot as of durableSeq_, then the log can restart empty
+            if (writeSnapshot(durableSeq_)) {
+                openLog(/*truncate=*/true);
+            }
+        }
+    }
+    durableCv_.notify_all();
+}
+
+/**
+ * writeBatch => encode, write, fdatasync. A failed attempt is cut back off
+ * the log (a torn tail would hide every later record from recovery) and
+ * retried; shadow_ and durableSeq_ only move once the batch is durable.
+ */
+bool WalletJournal::writeBatch(std::vector<PendingRecord>& batch)
+{
+    auto& reg = AssetRegistry::instance();
+    std::string out;
+    out.reserve(batch.size() * 64);
+
+    std::string body;
+    for (auto& rec : batch) {
+        body.clear();
+        put(body, (uint8_t)rec.type);
+        put(body, rec.seq);
+        put(body, (uint16_t)rec.entries.size());
+        for (auto& e : rec.entries) {
+            putEntry(body, reg.name(e.asset), e.a, e.b);
+            if (rec.type == REC_DELTA) put(body, e.seq);
+        }
+        put(out, (uint32_t)body.size());
+        out += body;
+        put(out, fnv1a(body.data(), body.size()));
+    }
+
+    bool ok = false;
+    for (int attempt = 0; attempt < WRITE_ATTEMPTS && !ok; attempt++) {
+        if (attempt > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10 << attempt));
+        }
+        if (walFd_ < 0 && !openLog(/*truncate=*/false)) continue;
+        off_t before = ::lseek(walFd_, 0, SEEK_END);
+        ok = before >= 0
+          && writeAll(walFd_, out.data(), out.size())
+          && ::fdatasync(walFd_) == 0;
+        if (!ok) {
+            std::cerr << "[JOURNAL] Log write failed (" << std::strerror(errno) << ")\n";
+            writeErrors_++;
+            if (before < 0 || ::ftruncate(walFd_, before) != 0) {
+                closeLog(); // reopen next attempt
+            }
+        }
+    }
+
+    if (!ok) {
+        {
+            std::lock_guard<std::mutex> lk(durableMutex_);
+            writeFailed_ = true;
+        }
+        durableCv_.notify_all();
+        return false;
+    }
+
+    for (auto& rec : batch) {
+        for (auto& e : rec.entries) {
+            Balance& b = shadow_[e.asset];
+            b.used = true;
+            applyEntry(b, rec.type, rec.seq, e);
+        }
+    }
+    syncs_++;
+    recordsWritten_ += batch.size();
+    sinceSnapshot_  += batch.size();
+
+    {
+        std::lock_guard<std::mutex> lk(durableMutex_);
+        durableSeq_ = batch.back().seq;
+        writeFailed_ = false;
+    }
+    durableCv_.notify_all();
+    return true;
+}
+
+/**
+ * applyEntry => one log entry onto a balance, in log order. A delta written
+ * before the asset's last SET (lower seq) is already inside that SET.
+ */
+void WalletJournal::applyEntry(Balance& b, RecordType type, uint64_t recSeq, const Entry& e)
+{
+    if (type == REC_SET) {
+        b.total  = e.a;
+        b.locked = e.b;
+        b.setSeq = recSeq;
+    } else if (type == REC_TX || e.seq > b.setSeq) {
+        b.total  += e.a;
+        b.locked += e.b;
+    }
+}
+
+/**
+ * writeSnapshot => shadow_ to <base>.snap.tmp, fsync, rename over the old one.
+ * Only called from start/stop or the writer thread.
+ */
+bool WalletJournal::writeSnapshot(uint64_t lastSeq)
+{
+    auto& reg = AssetRegistry::instance();
+    std::string out;
+    put(out, SNAP_MAGIC);
+    put(out, SNAP_VERSION);
+    put(out, lastSeq);
+
+    uint32_t count = 0;
+    std::string entries;
+    for (AssetId id = 0; id < reg.size(); id++) {
+        if (!shadow_[id].used) continue;
+        putEntry(entries, reg.name(id), shadow_[id].total, shadow_[id].locked);
+        put(entries, shadow_[id].setSeq);
+        count++;
+    }
+    put(out, count);
+    out += entries;
+    put(out, fnv1a(out.data(), out.size()));
+
+    std::string tmp = snapPath_ + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "[JOURNAL] Could not open " << tmp << "\n";
+        return false;
+    }
+    bool ok = writeAll(fd, out.data(), out.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || std::rename(tmp.c_str(), snapPath_.c_str()) != 0) {
+        std::cerr << "[JOURNAL] Snapshot write failed.\n";
+        return false;
+    }
+    sinceSnapshot_ = 0;
+    snapshots_++;
+    return true;
+}
+
+bool WalletJournal::openLog(bool truncate)
+{
+    closeLog();
+    int flags = O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0);
+    walFd_ = ::open(walPath_.c_str(), flags, 0644);
+    if (walFd_ < 0) {
+        std::cerr << "[JOURNAL] Could not open " << walPath_ << "\n";
+        return false;
+    }
+    return true;
+}
+
+void WalletJournal::closeLog()
+{
+    if (walFd_ >= 0) {
+        ::close(walFd_);
+        walFd_ = -1;
+    }
+}
@@ -0,0 +1,199 @@
+#include "engine/cycle_detector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <limits>
+
+static const double INF = std::numeric_limits<double>::infinity();
+
+CycleDetector::CycleDetector(int minLegs, int maxLegs, double minProfitPct)
+    : minLegs_(std::max(3, minLegs))
+    , maxLegs_(std::max(std::max(3, minLegs), maxLegs))
+    , maxWeight_(-std::log(1.0 + minProfitPct / 100.0))
+{
+}
+
+/**
+ * build => asset ids (sorted by name), one edge per tradable direction,
+ * CSR out-edge lists. All edges start unpriced.
+ */
+void CycleDetector::build(const std::vector<TopologySymbol>& symbols, const TopologyOptions& options)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+
+    std::unordered_map<std::string, bool> quoteOk;
+    for (const auto& q : options.quoteAssets) quoteOk[q] = true;
+
+    std::vector<const TopologySymbol*> used;
+    used.reserve(symbols.size());
+    assets_.clear();
+    for (const auto& s : symbols) {
+        if (!quoteOk.empty() && !quoteOk.count(s.quoteAsset)) continue;
+        used.push_back(&s);
+        assets_.push_back(s.baseAsset);
+        assets_.push_back(s.quoteAsset);
+    }
+    std::sort(assets_.begin(), assets_.end());
+    assets_.erase(std::unique(assets_.begin(), assets_.end()), assets_.end());
+    const int n = (int)assets_.size();
+    auto assetId = [&](const std::string& a) {
+        return (int)(std::lower_bound(assets_.begin(), assets_.end(), a) - assets_.begin());
+    };
+
+    edges_.clear();
+    legNames_.clear();
+    bySymbol_.clear();
+    for (const auto* s : used) {
+        int b = assetId(s->baseAsset), q = assetId(s->quoteAsset);
+        std::array<int, 2> ids = { -1, -1 };
+        ids[0] = (int)edges_.size();
+        edges_.push_back({ b, q });
+        legNames_.push_back(s->symbol + "_FWD");
+        if (options.inverseEdges) {
+            ids[1] = (int)edges_.size();
+            edges_.push_back({ q, b });
+            legNames_.push_back(s->symbol + "_INV");
+        }
+        bySymbol_[s->symbol] = ids;
+    }
+    weight_.assign(edges_.size(), INF);
+
+    const int m = (int)edges_.size();
+    offsets_.assign(n + 1, 0);
+    outEdges_.assign(m, 0);
+    for (const auto& e : edges_) offsets_[e.from + 1]++;
+    for (int i = 0; i < n; i++) offsets_[i + 1] += offsets_[i];
+    std::vector<int> fill(offsets_.begin(), offsets_.end() - 1);
+    for (int e = 0; e < m; e++) outEdges_[fill[edges_[e].from]++] = e;
+
+    // same preference as TriangleTopology: whitelist order, else by name
+    std::unordered_map<std::string, int> rank;
+    for (size_t i = 0; i < options.baseAssets.size(); i++) rank.emplace(options.baseAssets[i], (int)i);
+    baseKey_.assign(n, INT_MAX);
+    for (int i = 0; i < n; i++) {
+        if (rank.empty()) baseKey_[i] = i;
+        else {
+            auto it = rank.find(assets_[i]);
+            if (it != rank.end()) baseKey_[i] = it->second;
+        }
+    }
+
+    dist_.assign((size_t)maxLegs_ * n, INF);
+    pred_.assign((size_t)maxLegs_ * n, -1);
+    queued_.assign(n, 0);
+    frontier_.clear();
+    nextFrontier_.clear();
+}
+
+std::vector<DetectedCycle> CycleDetector::onBookUpdate(const std::string& rawSymbol,
+                                                       double fwdLogRate, double invLogRate)
+{
+    std::vector<DetectedCycle> out;
+    std::lock_guard<std::mutex> lk(mutex_);
+
+    auto it = bySymbol_.find(rawSymbol);
+    if (it == bySymbol_.end()) return out;
+    const int fwd = it->second[0], inv = it->second[1];
+
+    if (fwd >= 0) weight_[fwd] = EdgeRateTable::priced(fwdLogRate) ? -fwdLogRate : INF;
+    if (inv >= 0) weight_[inv] = EdgeRateTable::priced(invLogRate) ? -invLogRate : INF;
+
+    std::unordered_map<std::string, int> seen;
+    if (fwd >= 0 && weight_[fwd] < INF) searchThrough(fwd, out, seen);
+    if (inv >= 0 && weight_[inv] < INF) searchThrough(inv, out, seen);
+
+    std::sort(out.begin(), out.end(),
+              [](const DetectedCycle& a, const DetectedCycle& b){ return a.profitPct > b.profitPct; });
+    return out;
+}
+
+/**
+ * searchThrough => cycles u->v (the updated edge) + a k-hop path v ~> u.
+ * Row k of dist_ only grows from row k-1's frontier (exact hop count), so a
+ * row costs the out-edges of the vertices that improved in the row before.
+ */
+void CycleDetector::searchThrough(int edgeId, std::vector<DetectedCycle>& out,
+                                  std::unordered_map<std::string, int>& seen)
+{
+    const int n = (int)assets_.size();
+    const int u = edges_[edgeId].from;
+    const int v = edges_[edgeId].to;
+    const int maxHops = maxLegs_ - 1;
+
+    std::fill(dist_.begin(), dist_.end(), INF);
+    dist_[v] = 0.0;
+    frontier_.assign(1, v);
+
+    for (int k = 1; k <= maxHops && !frontier_.empty(); k++) {
+        double* prevRow = &dist_[(size_t)(k - 1) * n];
+        double* row     = &dist_[(size_t)k * n];
+        int* predRow    = &pred_[(size_t)k * n];
+        nextFrontier_.clear();
+
+        for (int x : frontier_) {
+            const double dx = prevRow[x];
+            for (int i = offsets_[x]; i < offsets_[x + 1]; i++) {
+                const int e = outEdges_[i];
+                const int y = edges_[e].to;
+                if (y == v) continue; // back at the start before closing => not simple
+                const double nd = dx + weight_[e];
+                if (nd < row[y]) {
+                    row[y] = nd;
+                    predRow[y] = e;
+                    if (!queued_[y]) {
+                        queued_[y] = 1;
+                        nextFrontier_.push_back(y);
+                    }
+                }
+            }
+        }
+        for (int y : nextFrontier_) queued_[y] = 0;
+        frontier_.swap(nextFrontier_);
+
+        if (k + 1 < minLegs_ || row[u] == INF) continue;
+        const double total = row[u] + weight_[edgeId];
+        if (!(total < maxWeight_)) continue;
+
+        // walk predecessors back to v; reject paths that revisit an asset
+        std::vector<int> legs(k + 1);
+        std::vector<int> verts(k + 1);
+        legs[k] = edgeId;
+        int y = u;
+        bool simple = true;
+        for (int h = k; h >= 1; h--) {
+            int e = pred_[(size_t)h * n + y];
+            legs[h - 1] = e;
+            verts[h] = y;
+            y = edges_[e].from;
+        }
+        verts[0] = v;
+        for (int a = 0; a <= k && simple; a++) {
+            for (int b = a + 1; b <= k; b++) {
+                if (verts[a] == verts[b]) { simple = false; break; }
+            }
+        }
+        if (!simple) continue;
+
+        // rotate so the route starts at the preferred base (verts[i] = start of legs[i])
+        int best = -1;
+        for (int i = 0; i <= k; i++) {
+            if (baseKey_[verts[i]] == INT_MAX) continue;
+            if (best < 0 || baseKey_[verts[i]] < baseKey_[verts[best]]) best = i;
+        }
+        if (best < 0) continue;
+
+        DetectedCycle c;
+        c.route.base = assets_[verts[best]];
+        std::string key;
+        for (int i = 0; i <= k; i++) {
+            const std::string& leg = legNames_[legs[(best + i) % (k + 1)]];
+            c.route.path.push_back(leg);
+            if (i > 0) key += "->";
+            key += leg;
+        }
+        c.profitPct = (std::exp(-total) - 1.0) * 100.0;
+        if (seen.emplace(key, (int)out.size()).second) {
+            out.push_back(std::move(c));
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include "engine/cycle_table.hpp"
+#include <algorithm>
+
+CycleTable::CycleTable(int capacity)
+    : slots_(std::max(1, capacity))
+{
+    guards_.reserve((int)slots_.size());
+}
+
+int CycleTable::acquire(const std::string& key, const Triangle& route)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    tick_++;
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        slots_[it->second].lastSeen = tick_;
+        return CYCLE_ID_BASE + it->second;
+    }
+
+    // free slot first, else the least recently seen idle one
+    int victim = -1;
+    for (int i = 0; i < (int)slots_.size(); i++) {
+        const Slot& s = slots_[i];
+        if (!s.used) {
+            victim = i;
+            break;
+        }
+        if (guards_.isCoolingDown(i) || guards_.isParked(i)) continue;
+        if (victim < 0 || s.lastSeen < slots_[victim].lastSeen) victim = i;
+    }
+    if (victim < 0) return -1;
+
+    Slot& s = slots_[victim];
+    if (s.used) {
+        index_.erase(s.key);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    guards_.reset(victim); // the last occupant's backoff history isn't this route's
+    s.key      = key;
+    s.route    = route;
+    s.lastSeen = tick_;
+    s.used     = true;
+    index_[key] = victim;
+    return CYCLE_ID_BASE + victim;
+}
+
+int CycleTable::size() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return (int)index_.size();
+}
@@ -0,0 +1,46 @@
+#include "engine/edge_rate_table.hpp"
+#include "core/triangle.hpp"
+#include <cmath>
+
+void EdgeRateTable::reset()
+{
+    slots_.clear();
+    bySymbol_.clear();
+}
+
+int EdgeRateTable::addSymbol(const std::string& rawSymbol)
+{
+    auto it = bySymbol_.find(rawSymbol);
+    if (it != bySymbol_.end()) return it->second;
+
+    int slot = (int)slots_.size();
+    slots_.emplace_back();
+    slots_.back().logFee = std::log(1.0 - fees_.feeFor(rawSymbol));
+    bySymbol_.emplace(rawSymbol, slot);
+    return slot;
+}
+
+int EdgeRateTable::slotOf(const std::string& rawSymbol) const
+{
+    auto it = bySymbol_.find(rawSymbol);
+    return it == bySymbol_.end() ? -1 : it->second;
+}
+
+int EdgeRateTable::edgeFor(const std::string& leg) const
+{
+    std::string rawSymbol;
+    LegDirection dir = splitLegSymbol(leg, rawSymbol);
+    int slot = slotOf(rawSymbol);
+    if (slot < 0) return -1;
+    return slot * 2 + (dir == LegDirection::INVERSE ? 1 : 0);
+}
+
+bool EdgeRateTable::update(int slot, double bestBid, double bestAsk)
+{
+    Slot& s = slots_[slot];
+    double fwd = bestBid > 0.0 ? std::log(bestBid) + s.logFee : UNPRICED;
+    double inv = bestAsk > 0.0 ? s.logFee - std::log(bestAsk) : UNPRICED;
+    double oldFwd = s.fwd.exchange(fwd, std::memory_order_relaxed);
+    double oldInv = s.inv.exchange(inv, std::memory_order_relaxed);
+    return oldFwd != fwd || oldInv != inv;
+}
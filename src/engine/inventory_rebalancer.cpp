@@ -0,0 +1,45 @@
+#include "engine/inventory_rebalancer.hpp"
+#include <cmath>
+
+void InventoryRebalancer::plan(const std::vector<LegPlan>& plans,
+                               const std::map<std::string, double>& drift,
+                               double feePercent,
+                               const QtyCheck& check,
+                               std::vector<RebalanceOrder>& out)
+{
+    out.clear();
+    if (plans.size() < 2) return;
+
+    // what earlier corrections moved onto the asset being settled
+    double carry = 0.0;
+    for (size_t j = 1; j < plans.size(); j++) {
+        const LegPlan& next = plans[j];
+        auto it = drift.find(next.input());
+        double d = (it == drift.end() ? 0.0 : it->second) + carry;
+        carry = 0.0;
+        if (std::fabs(d) <= 1e-12 || next.bestPx <= 0.0) continue;
+
+        const double px = next.bestPx;
+        RebalanceOrder o;
+        o.leg    = j;
+        o.symbol = next.symbol;
+        if (d > 0.0) {
+            // surplus => trade it forward, as the leg did
+            o.isSell  = next.isSell;
+            o.qtyBase = (next.isSell ? d : d / (px * (1.0 + feePercent)));
+        } else {
+            // shortfall => buy it back out of the next asset
+            o.isSell  = !next.isSell;
+            o.qtyBase = (next.isSell ? -d : -d / (px * (1.0 - feePercent)));
+        }
+        if (!check(next, o.qtyBase) || o.qtyBase <= 0.0) continue;
+
+        // effect on the next asset, from the quantity actually sent
+        if (o.isSell == next.isSell) {
+            carry = (next.isSell ? o.qtyBase * px * (1.0 - feePercent) : o.qtyBase);
+        } else {
+            carry = -(next.isSell ? o.qtyBase * px * (1.0 + feePercent) : o.qtyBase);
+        }
+        out.push_back(o);
+    }
+}
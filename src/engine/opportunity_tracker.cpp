@@ -0,0 +1,174 @@
+#include "engine/opportunity_tracker.hpp"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* oppStageName(OppStage s) {
+    switch (s) {
+        case OppStage::DETECT:   return "detect";
+        case OppStage::ESTIMATE: return "estimate";
+        case OppStage::COOLDOWN: return "cooldown";
+        case OppStage::REFETCH:  return "refetch";
+        case OppStage::RECHECK:  return "recheck";
+        default: break;
+    }
+    static const char* legs[] = { "leg1", "leg2", "leg3", "leg4", "leg5", "leg6", "leg7", "leg8" };
+    int leg = (int)s - (int)OppStage::LEG_1;
+    return (leg >= 0 && leg < (int)MAX_ROUTE_LEGS) ? legs[leg] : "?";
+}
+
+const char* oppOutcomeName(OppOutcome o) {
+    switch (o) {
+        case OppOutcome::TRADED:       return "traded";
+        case OppOutcome::UNPROFITABLE: return "unprofitable";
+        case OppOutcome::BELOW_MIN:    return "below_min";
+        case OppOutcome::COOLDOWN:     return "cooldown";
+        case OppOutcome::TORN_BOOKS:   return "torn_books";
+        case OppOutcome::EMPTY_BOOK:   return "empty_book";
+        case OppOutcome::RECHECK_FAIL: return "recheck_fail";
+        case OppOutcome::LEG_FAIL:     return "leg_fail";
+        case OppOutcome::BAD_ROUTE:    return "bad_route";
+        case OppOutcome::ABANDONED:    return "abandoned";
+        default:                       return "?";
+    }
+}
+
+OppOutcome oppOutcomeFromFailReason(const std::string& r) {
+    if (r == "UNPROFITABLE_OR_FILL_FAIL") return OppOutcome::RECHECK_FAIL;
+    if (r == "BELOW_MIN_PROFIT_USDT")     return OppOutcome::BELOW_MIN;
+    if (r == "TORN_BOOKS")                return OppOutcome::TORN_BOOKS;
+    if (r == "BAD_ROUTE")                 return OppOutcome::BAD_ROUTE;
+    if (r.size() > 9 && r.compare(r.size() - 9, 9, "_EMPTY_OB") == 0) return OppOutcome::EMPTY_BOOK;
+    return OppOutcome::LEG_FAIL; // LEGn_FAIL, PARALLEL_LEG_FAIL, anything else mid-trade
+}
+
+void OppStats::add(const OppStats& o) {
+    opportunities += o.opportunities;
+    for (int i = 0; i < (int)OppOutcome::COUNT; i++) outcomes[i] += o.outcomes[i];
+    for (int i = 0; i < (int)OppStage::COUNT; i++) {
+        reached[i]      += o.reached[i];
+        latencySumNs[i] += o.latencySumNs[i];
+        latencyMaxNs[i]  = std::max(latencyMaxNs[i], o.latencyMaxNs[i]);
+    }
+}
+
+OpportunityTracker& OpportunityTracker::instance() {
+    static OpportunityTracker tracker;
+    return tracker;
+}
+
+OpportunityTracker::Open& OpportunityTracker::current() {
+    static thread_local Open open;
+    return open;
+}
+
+uint64_t OpportunityTracker::begin(int routeId, SymbolId trigger) {
+    Open& o = current();
+    if (o.id != 0) finish(OppOutcome::ABANDONED);
+    o = Open{};
+    o.id        = nextId_.fetch_add(1, std::memory_order_relaxed);
+    o.routeId   = routeId;
+    o.trigger   = trigger;
+    o.stampNs[(int)OppStage::DETECT] = nowNs();
+    return o.id;
+}
+
+void OpportunityTracker::stamp(OppStage stage) {
+    Open& o = current();
+    if (o.id == 0 || stage >= OppStage::COUNT) return;
+    o.stampNs[(int)stage] = nowNs();
+}
+
+void OpportunityTracker::stampLeg(size_t legIndex) {
+    if (legIndex < MAX_ROUTE_LEGS) stamp((OppStage)((int)OppStage::LEG_1 + (int)legIndex));
+}
+
+void OpportunityTracker::finish(OppOutcome outcome) {
+    Open& o = current();
+    if (o.id == 0) return;
+
+    // this opportunity alone, then merged into the tables
+    OppStats one;
+    one.opportunities = 1;
+    one.outcomes[(int)outcome] = 1;
+    const int64_t t0 = o.stampNs[(int)OppStage::DETECT];
+    for (int s = 0; s < (int)OppStage::COUNT; s++) {
+        if (o.stampNs[s] == 0) continue;
+        uint64_t ns = (uint64_t)std::max<int64_t>(0, o.stampNs[s] - t0);
+        one.reached[s]      = 1;
+        one.latencySumNs[s] = ns;
+        one.latencyMaxNs[s] = ns;
+    }
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        totals_.add(one);
+        if (o.routeId >= 0) byRoute_[o.routeId].add(one);
+        if (o.trigger != INVALID_SYMBOL) bySymbol_[o.trigger].add(one);
+    }
+    o.id = 0;
+}
+
+bool OpportunityTracker::routeStats(int routeId, OppStats& out) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = byRoute_.find(routeId);
+    if (it == byRoute_.end()) return false;
+    out = it->second;
+    return true;
+}
+
+bool OpportunityTracker::symbolStats(SymbolId symbol, OppStats& out) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = bySymbol_.find(symbol);
+    if (it == bySymbol_.end()) return false;
+    out = it->second;
+    return true;
+}
+
+OppStats OpportunityTracker::totals() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return totals_;
+}
+
+void OpportunityTracker::printSummary(std::ostream& os) const {
+    OppStats t = totals();
+    os << " Opportunities: " << t.opportunities
+       << " traded=" << t.outcomes[(int)OppOutcome::TRADED]
+       << " (" << std::fixed << std::setprecision(1) << t.conversion() * 100.0 << "%)";
+    for (int i = 1; i < (int)OppOutcome::COUNT; i++) {
+        if (t.outcomes[i]) os << " " << oppOutcomeName((OppOutcome)i) << "=" << t.outcomes[i];
+    }
+    os << std::setprecision(3) << "\n   ms from detect:";
+    for (int s = 1; s < (int)OppStage::COUNT; s++) {
+        if (t.reached[s]) os << " " << oppStageName((OppStage)s) << "=" << t.meanLatencyMs((OppStage)s);
+    }
+    os << std::defaultfloat << "\n";
+}
+
+bool OpportunityTracker::exportCSV(const std::string& path) const {
+    std::ofstream fs(path, std::ios::trunc);
+    if (!fs.is_open()) return false;
+
+    fs << "kind,key,opportunities,conversion";
+    for (int i = 0; i < (int)OppOutcome::COUNT; i++) fs << "," << oppOutcomeName((OppOutcome)i);
+    for (int s = 1; s < (int)OppStage::COUNT; s++) fs << ",ms_" << oppStageName((OppStage)s);
+    fs << "\n";
+
+    auto row = [&fs](const char* kind, const std::string& key, const OppStats& st) {
+        fs << kind << "," << key << "," << st.opportunities << "," << st.conversion();
+        for (int i = 0; i < (int)OppOutcome::COUNT; i++) fs << "," << st.outcomes[i];
+        for (int s = 1; s < (int)OppStage::COUNT; s++) fs << "," << st.meanLatencyMs((OppStage)s);
+        fs << "\n";
+    };
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    row("total", "all", totals_);
+    for (const auto& kv : byRoute_) row("route", std::to_string(kv.first), kv.second);
+    for (const auto& kv : bySymbol_) row("symbol", SymbolRegistry::instance().name(kv.first), kv.second);
+    return true;
+}
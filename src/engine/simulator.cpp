@@ -1,4 +1,7 @@
 #include "engine/simulator.hpp"
+#include "core/symbol_registry.hpp"
+#include "core/usdt_valuation.hpp"
+#include "engine/opportunity_tracker.hpp"
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -33,8 +36,15 @@ std::pair<std::string,std::string> parseSymbol(const std::string& pair) {
     return { pair, "UNKNOWN" };
 }
 
-// Global locks for assets
-std::map<std::string, std::mutex> Simulator::assetLocks_;
+// books are keyed by the exchange symbol, not the tagged leg name
+static std::string rawLegSymbol(const std::string& leg) {
+    std::string raw;
+    splitLegSymbol(leg, raw);
+    return raw;
+}
+
+// Global locks for assets, by AssetId
+std::mutex Simulator::assetLocks_[AssetRegistry::MAX_ASSETS];
 
 /**
  * Constructor
@@ -57,16 +67,6 @@ Simulator::Simulator(const std::string& logFileName,
   , minProfitUSDT_(minProfitUSDT)
   , liveMode_(false)
 {
-    // Initialize static asset locks if empty
-    if (assetLocks_.empty()) {
-        assetLocks_.try_emplace("BTC");
-        assetLocks_.try_emplace("ETH");
-        assetLocks_.try_emplace("USDT");
-        assetLocks_.try_emplace("BNB");
-        assetLocks_.try_emplace("BUSD");
-        assetLocks_.try_emplace("USDC");
-    }
-
     // Start or append the sim_log
     std::ofstream file(logFileName_, std::ios::app);
     if (file.is_open()) {
@@ -77,61 +77,77 @@ Simulator::Simulator(const std::string& logFileName,
     loadSymbolFilters("config/symbol_filters.json");
 }
 
+void Simulator::setParallelLegs(bool on)
+{
+    if (on && !legPool_) legPool_.reset(new ThreadPool(MAX_ROUTE_LEGS));
+    parallelLegs_ = on;
+}
+
+/**
+ * loadSymbolFilters => optional manual minQty/minNotional overrides.
+ * The full filter set comes from exchangeInfo (SymbolRegistry); this file
+ * only wins for the two minimums it names.
+ */
 void Simulator::loadSymbolFilters(const std::string& path)
 {
     std::ifstream f(path);
     if (!f.is_open()) {
-        std::cerr << "[SIM] Could not open symbol filters file: " << path << "\n";
-        std::cerr << "[SIM] Orders may fail if below exchange limits.\n";
         return;
     }
 
     try {
         json j;
         f >> j;
+        auto& reg = SymbolRegistry::instance();
+        int n = 0;
         for (auto it = j.begin(); it != j.end(); ++it) {
-            std::string sym = it.key();  // e.g. "BTCUSDT"
-            auto obj        = it.value();
-            SymbolFilter sf;
-            sf.minNotional  = obj.value("minNotional", 10.0);
-            sf.minQty       = obj.value("minQty", 0.0001);
-            symbolFilters_[sym] = sf;
+            auto obj = it.value();
+            reg.overrideMinimums(reg.intern(it.key()),   // e.g. "BTCUSDT"
+                                 obj.value("minQty", 0.0),
+                                 obj.value("minNotional", 0.0));
+            n++;
         }
-        std::cout << "[SIM] Loaded " << symbolFilters_.size()
-                  << " symbol filters from " << path << "\n";
+        std::cout << "[SIM] Loaded " << n
+                  << " symbol filter overrides from " << path << "\n";
     } catch (std::exception& e) {
         std::cerr << "[SIM] Error parsing " << path << ": " << e.what() << "\n";
     }
 }
 
-bool Simulator::passesExchangeFilters(const std::string& symbol,
-                                      double quantityBase,
-                                      double priceEstimate)
+/**
+ * passesExchangeFilters => dense table lookup by id, no logging on the hot
+ * path; rejects are counted per reason instead. Only orders we were about
+ * to send count (countReject): depth estimates size hypothetical trades.
+ */
+bool Simulator::passesExchangeFilters(SymbolId id,
+                                      int64_t qtyRaw,
+                                      double priceEstimate,
+                                      bool countReject)
 {
-    if (symbolFilters_.count(symbol) == 0) {
-        double notional = quantityBase * priceEstimate;
-        if (notional < 10.0 || quantityBase < 0.0001) {
-            std::cout << "[FILTER] " << symbol
-                      << ": below default minNotional=10 or minQty=0.0001\n";
-            return false;
-        }
-        return true;
-    }
+    FilterReject r = SymbolRegistry::instance().check(id, qtyRaw, priceEstimate);
+    if (r == FilterReject::OK) return true;
+    if (countReject) filterRejects_[(int)r].fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
 
-    auto& filt = symbolFilters_[symbol];
-    double notional = quantityBase * priceEstimate;
+bool Simulator::roundAndCheckQty(const std::string& symbol,
+                                 double& quantityBase,
+                                 double priceEstimate,
+                                 bool countReject)
+{
+    return roundAndCheckQty(SymbolRegistry::instance().find(symbol), quantityBase,
+                            priceEstimate, countReject);
+}
 
-    if (quantityBase < filt.minQty) {
-        std::cout << "[FILTER] " << symbol << ": quantityBase="
-                  << quantityBase << " < minQty=" << filt.minQty << "\n";
-        return false;
-    }
-    if (notional < filt.minNotional) {
-        std::cout << "[FILTER] " << symbol << ": notional="
-                  << notional << " < minNotional=" << filt.minNotional << "\n";
-        return false;
-    }
-    return true;
+bool Simulator::roundAndCheckQty(SymbolId id,
+                                 double& quantityBase,
+                                 double priceEstimate,
+                                 bool countReject)
+{
+    auto& reg = SymbolRegistry::instance();
+    int64_t qtyRaw = reg.roundQty(id, quantityBase);
+    quantityBase = FixedPoint::toDouble(qtyRaw, reg.infoOrDefault(id).qtyDecimals);
+    return passesExchangeFilters(id, qtyRaw, priceEstimate, countReject);
 }
 
 //-------------------------------------------------------------
@@ -143,36 +159,54 @@ bool Simulator::simulateTradeDepthWithWallet(const Triangle& tri,
                                              const OrderBookData& ob3_initial,
                                              std::string* failReason /* = nullptr */)
 {
-    // (1) We'll do a final "freshness" re-fetch for all 3 books right before Leg 1
-    OrderBookData ob1 = (executor_? executor_->getOrderBookSnapshot(tri.path[0]) : ob1_initial);
-    if(ob1.bids.empty() || ob1.asks.empty()){
-        if(failReason) *failReason = "LEG1_EMPTY_OB";
-        std::cout<<"[SIM] Leg1 fresh OB is empty => skip.\n";
-        return false;
-    }
+    return simulateCycleDepthWithWallet(tri, { ob1_initial, ob2_initial, ob3_initial }, failReason);
+}
 
-    OrderBookData ob2 = (executor_? executor_->getOrderBookSnapshot(tri.path[1]) : ob2_initial);
-    if(ob2.bids.empty() || ob2.asks.empty()){
-        if(failReason) *failReason = "LEG2_EMPTY_OB";
-        std::cout<<"[SIM] Leg2 fresh OB is empty => skip.\n";
+bool Simulator::simulateCycleDepthWithWallet(const Triangle& tri,
+                                             const std::vector<OrderBookData>& booksInitial,
+                                             std::string* failReason /* = nullptr */)
+{
+    const size_t legCount = tri.path.size();
+    RouteLeg legs[MAX_ROUTE_LEGS];
+    if (booksInitial.size() < legCount || !resolveRoute(tri, legs)) {
+        if(failReason) *failReason = "BAD_ROUTE";
         return false;
     }
-
-    OrderBookData ob3 = (executor_? executor_->getOrderBookSnapshot(tri.path[2]) : ob3_initial);
-    if(ob3.bids.empty() || ob3.asks.empty()){
-        if(failReason) *failReason = "LEG3_EMPTY_OB";
-        std::cout<<"[SIM] Leg3 fresh OB is empty => skip.\n";
-        return false;
+    auto& symbols = SymbolRegistry::instance();
+
+    // (1) We'll do a final "freshness" re-fetch for every book right before Leg 1,
+    //     all legs as of one instant
+    std::vector<OrderBookData> books(booksInitial.begin(), booksInitial.begin() + legCount);
+    if (executor_) {
+        std::vector<std::string> names(legCount);
+        for (size_t i = 0; i < legCount; i++) names[i] = symbols.name(legs[i].symbol);
+        if (!executor_->getOrderBookSnapshots(names, books)) {
+            if(failReason) *failReason = "TORN_BOOKS";
+            std::cout<<"[SIM] fresh books kept moving, no consistent view => skip.\n";
+            return false;
+        }
     }
+    for (size_t i = 0; i < legCount; i++) {
+        if(books[i].bids.empty() || books[i].asks.empty()){
+            if(failReason) *failReason = "LEG" + std::to_string(i+1) + "_EMPTY_OB";
+            std::cout<<"[SIM] Leg"<< (i+1) <<" fresh OB is empty => skip.\n";
+            return false;
+        }
+    }
+
+    auto& tracker = OpportunityTracker::instance();
+    tracker.stamp(OppStage::REFETCH);
 
-    double b1 = ob1.bids.empty() ? 0.0 : ob1.bids[0].price;
-    double b2 = ob2.bids.empty() ? 0.0 : ob2.bids[0].price;
-    double b3 = ob3.bids.empty() ? 0.0 : ob3.bids[0].price;
-    double oldValUSDT = wallet_->getFreeBalance("BTC") * b1
-                      + wallet_->getFreeBalance("ETH") * b2
-                      + wallet_->getFreeBalance("USDT");
+    // every asset the route touches, valued at one set of USDT prices
+    RouteAssets assets;
+    collectRouteAssets(legs, legCount, assets);
+    double oldValUSDT = assets.value(*wallet_);
 
-    double estProfitUSDT = estimateTriangleProfitUSDT(tri, ob1, ob2, ob3);
+    // profit-maximizing size for every leg, priced on the fresh books
+    const OrderBookData* bookPtrs[MAX_ROUTE_LEGS];
+    for (size_t i = 0; i < legCount; i++) bookPtrs[i] = &books[i];
+    SizedRoute sized;
+    double estProfitUSDT = estimateSizedProfitUSDT(legs, legCount, bookPtrs, sized);
     if (estProfitUSDT < 0.0) {
         if(failReason) *failReason = "UNPROFITABLE_OR_FILL_FAIL";
         std::cout << "[SIM] Real-time re-check => unprofitable or fill fail => skip.\n";
@@ -185,55 +219,43 @@ bool Simulator::simulateTradeDepthWithWallet(const Triangle& tri,
         return false;
     }
 
-    // lock all relevant assets
-    std::vector<std::string> allAssets;
-    for (auto& p : tri.path) {
-        auto pairAssets = getAssetsForPair(p);
-        for (auto& a : pairAssets) {
-            if (std::find(allAssets.begin(), allAssets.end(), a) == allAssets.end()) {
-                allAssets.push_back(a);
-            }
-        }
-    }
-    std::sort(allAssets.begin(), allAssets.end());
+    tracker.stamp(OppStage::RECHECK);
 
-    std::vector<std::unique_lock<std::mutex>> lockGuards;
-    lockGuards.reserve(allAssets.size());
-    for (auto& asset : allAssets) {
-        lockGuards.emplace_back(assetLocks_[asset]);
+    // lock all relevant assets, in id order (collectRouteAssets sorts)
+    std::unique_lock<std::mutex> lockGuards[MAX_ROUTE_LEGS + 1];
+    for (size_t i = 0; i < assets.count; i++) {
+        lockGuards[i] = std::unique_lock<std::mutex>(assetLocks_[assets.id[i]]);
     }
 
-    auto tx = wallet_->beginTransaction();
-    ReversibleLeg realLegs[3];
+    // the user stream's balance pushes for these wait for commit/rollback
+    auto tx = wallet_->beginTransaction(assets.id, assets.count);
+    ReversibleLeg realLegs[MAX_ROUTE_LEGS];
 
-    // Leg 1
-    if (!doLeg(tx, tri.path[0], ob1, &realLegs[0])) {
-        if(failReason) *failReason = "LEG1_FAIL";
-        std::cout << "[SIM] Leg1 failed => rollback.\n";
+    // If inventory already covers every leg's input, the legs don't depend on
+    // each other's fills => fire them all at once (one round trip, not N).
+    std::vector<LegPlan> plans;
+    bool parallel = (liveMode_ && parallelLegs_ && legPool_ && executor_
+                     && planIndependentLegs(legs, legCount, books, plans, &sized));
+    if (parallel && !executeLegsParallel(tx, plans, failReason)) {
         wallet_->rollbackTransaction(tx);
         return false;
     }
+    for (size_t i = 0; parallel && i < legCount; i++) tracker.stampLeg(i);
 
-    // Leg 2
-    if (!doLeg(tx, tri.path[1], ob2, &realLegs[1])) {
-        if(failReason) *failReason = "LEG2_FAIL";
-        std::cout << "[SIM] Leg2 failed => reversing Leg1 if live.\n";
-        if (liveMode_ && realLegs[0].success) {
-            reverseRealLeg(realLegs[0]);
+    // Legs in order; a failure reverses every earlier leg that hit the exchange
+    for (size_t i = 0; !parallel && i < legCount; i++) {
+        if (doLeg(tx, legs[i], books[i], &realLegs[i], sized.legQtyBase[i])) {
+            tracker.stampLeg(i);
+            continue;
         }
-        wallet_->rollbackTransaction(tx);
-        return false;
-    }
 
-    // Leg 3
-    if (!doLeg(tx, tri.path[2], ob3, &realLegs[2])) {
-        if(failReason) *failReason = "LEG3_FAIL";
-        std::cout << "[SIM] Leg3 failed => reversing Leg2 & Leg1 if live.\n";
-        if (liveMode_ && realLegs[1].success) {
-            reverseRealLeg(realLegs[1]);
-        }
-        if (liveMode_ && realLegs[0].success) {
-            reverseRealLeg(realLegs[0]);
+        if(failReason) *failReason = "LEG" + std::to_string(i+1) + "_FAIL";
+        std::cout << "[SIM] Leg" << (i+1) << " failed => "
+                  << (i > 0 ? "reversing earlier legs if live.\n" : "rollback.\n");
+        for (size_t j = i; j-- > 0; ) {
+            if (liveMode_ && realLegs[j].success) {
+                reverseRealLeg(realLegs[j]);
+            }
         }
         wallet_->rollbackTransaction(tx);
         return false;
@@ -241,9 +263,7 @@ bool Simulator::simulateTradeDepthWithWallet(const Triangle& tri,
 
     wallet_->commitTransaction(tx);
 
-    double newValUSDT = wallet_->getFreeBalance("BTC") * b3
-                      + wallet_->getFreeBalance("ETH") * b2
-                      + wallet_->getFreeBalance("USDT");
+    double newValUSDT = assets.value(*wallet_);
     double absoluteProfit = (newValUSDT - oldValUSDT);
     double profitPercent  = (oldValUSDT > 0.0 ? (absoluteProfit / oldValUSDT)*100.0 : 0.0);
 
@@ -259,17 +279,14 @@ bool Simulator::simulateTradeDepthWithWallet(const Triangle& tri,
         cumulativeProfit_ += absoluteProfit;
     }
 
-    std::cout << "[SIM] Traded triangle: " << ps.str()
+    std::cout << "[SIM] Traded " << (legCount == 3 ? "triangle" : std::to_string(legCount) + "-leg cycle")
+              << ": " << ps.str()
               << " oldVal=" << oldValUSDT
               << " newVal=" << newValUSDT
               << " profit=" << profitPercent << "%\n";
 
-    // NEW: Save wallet after a successful trade
-    {
-        // Optional: Print a small log so we know it's saving
-        std::cout << "[SIM] Saving wallet to wallet.json\n";
-        wallet_->saveToFile("wallet.json");
-    }
+    // persistence: commitTransaction above queued the journal record,
+    // the journal's writer thread does the disk I/O
 
     return true;
 }
@@ -307,77 +324,63 @@ void Simulator::reverseRealLeg(const ReversibleLeg& leg)
 }
 
 bool Simulator::doLeg(WalletTransaction& tx,
-                      const std::string& pairName,
+                      const RouteLeg& leg,
                       const OrderBookData& ob,
-                      ReversibleLeg* realRec)
+                      ReversibleLeg* realRec,
+                      double sizedQtyBase)
 {
+    const std::string& symbol     = SymbolRegistry::instance().name(leg.symbol);
+    const std::string& baseAsset  = AssetRegistry::instance().name(leg.base);
+    const std::string& quoteAsset = AssetRegistry::instance().name(leg.quote);
+    const bool isSell = leg.isSell;
+
     if (liveMode_) {
-        auto [baseAsset, quoteAsset] = parseSymbol(pairName);
-        if (quoteAsset=="UNKNOWN") {
-            std::cout << "[SIM-LIVE] unknown quote for " << pairName << "\n";
-            return false;
-        }
-        bool isSell = (quoteAsset=="USDT"||quoteAsset=="BTC"||quoteAsset=="BUSD"||quoteAsset=="ETH");
-        double freeAmt = (isSell ? wallet_->getFreeBalance(baseAsset)
-                                 : wallet_->getFreeBalance(quoteAsset));
+        double freeAmt = wallet_->getFreeBalance(leg.input());
         if (freeAmt<=0.0) {
             std::cout << "[SIM-LIVE] not enough " << (isSell? baseAsset : quoteAsset) << "\n";
             return false;
         }
 
-        double fraction = maxFractionPerTrade_;
-        double used     = freeAmt * fraction;
-        if (used<=0.0) {
-            std::cout << "[SIM-LIVE] fraction-based=0?\n";
+        // side we'd hit: bids for a sell, asks for a buy
+        double refPx = (isSell ? (ob.bids.empty() ? 0.0 : ob.bids[0].price)
+                               : (ob.asks.empty() ? 0.0 : ob.asks[0].price));
+        if (refPx <= 1e-12) {
+            std::cout << "[SIM-LIVE] no bestPx for " << symbol << "\n";
             return false;
         }
 
         double desiredQtyBase = 0.0;
-        if (isSell) {
-            desiredQtyBase = used;
+        if (sizedQtyBase > 0.0) {
+            desiredQtyBase = (isSell ? std::min(sizedQtyBase, freeAmt) : sizedQtyBase);
         } else {
-            double bestAsk = (ob.asks.empty()?1e9 : ob.asks[0].price);
-            desiredQtyBase = used / bestAsk;
+            double used = freeAmt * maxFractionPerTrade_;
+            desiredQtyBase = (isSell ? used : used / refPx);
         }
         if (desiredQtyBase<=1e-12) {
             std::cout << "[SIM-LIVE] can't calc desiredQtyBase\n";
             return false;
         }
 
-        bool ok = doLegLive(tx, pairName, desiredQtyBase, isSell);
+        bool ok = doLegLive(tx, leg, desiredQtyBase, refPx);
         if (ok && realRec) {
             realRec->success       = true;
-            realRec->symbol        = pairName;
+            realRec->symbol        = symbol;
             realRec->sideSell      = isSell;
             realRec->filledQtyBase = desiredQtyBase;
         }
         return ok;
     }
 
-    // local sim logic (unchanged)
+    // local sim logic
     auto t0 = std::chrono::high_resolution_clock::now();
-    auto [baseAsset, quoteAsset] = parseSymbol(pairName);
-    if (quoteAsset=="UNKNOWN") {
-        std::cout<<"[SIM] unknown quote for "<< pairName <<"\n";
-        return false;
-    }
-    bool isSell = (quoteAsset=="USDT"||quoteAsset=="BTC"||quoteAsset=="BUSD"||quoteAsset=="ETH");
     std::string sideStr = (isSell?"SELL":"BUY");
 
-    double freeAmt = (isSell ? wallet_->getFreeBalance(baseAsset)
-                             : wallet_->getFreeBalance(quoteAsset));
+    double freeAmt = wallet_->getFreeBalance(leg.input());
     if (freeAmt<=0.0) {
         std::cout<<"[SIM] not enough "<< (isSell? baseAsset : quoteAsset) <<"\n";
         return false;
     }
 
-    double fraction = maxFractionPerTrade_;
-    double used     = freeAmt * fraction;
-    if (used<=0.0) {
-        std::cout<<"[SIM] fraction=0?\n";
-        return false;
-    }
-
     // pick best price
     double bestPx = 0.0;
     if (isSell && !ob.bids.empty()) {
@@ -390,16 +393,31 @@ bool Simulator::doLeg(WalletTransaction& tx,
         return false;
     }
 
-    double desiredQtyBase = (isSell? used : (used / bestPx));
-    if (!passesExchangeFilters(pairName, desiredQtyBase, bestPx)) {
+    // sized by the route optimizer, else the legacy fraction of free balance
+    double desiredQtyBase = 0.0;
+    if (sizedQtyBase > 0.0) {
+        desiredQtyBase = (isSell ? std::min(sizedQtyBase, freeAmt) : sizedQtyBase);
+    } else {
+        double used = freeAmt * maxFractionPerTrade_;
+        desiredQtyBase = (isSell? used : (used / bestPx));
+    }
+    if (desiredQtyBase<=0.0) {
+        std::cout<<"[SIM] fraction=0?\n";
+        return false;
+    }
+    if (!roundAndCheckQty(leg.symbol, desiredQtyBase, bestPx)) {
         return false;
     }
 
+    // a sized buy may not spend more quote than we hold (step rounding upstream)
+    double budget = (!isSell && sizedQtyBase > 0.0) ? freeAmt / (1.0 + feePercent_) : INFINITY;
     double filled=0.0, cost=0.0;
     const auto &levels = (isSell ? ob.bids : ob.asks);
     double remain = desiredQtyBase;
     for (auto &lvl: levels) {
         double tradeQty  = std::min(remain, lvl.quantity);
+        tradeQty = std::min(tradeQty, (budget - cost) / lvl.price);
+        if (tradeQty <= 0.0) break;
         double tradeCost = tradeQty * lvl.price;
         filled += tradeQty;
         cost   += tradeCost;
@@ -429,11 +447,11 @@ bool Simulator::doLeg(WalletTransaction& tx,
 
     bool ok1=false, ok2=false;
     if (isSell) {
-        ok1= wallet_->applyChange(tx, baseAsset,  -filled, 0.0);
-        ok2= wallet_->applyChange(tx, quoteAsset, netCostOrProceeds, 0.0);
+        ok1= wallet_->applyChange(tx, leg.base,  -filled, 0.0);
+        ok2= wallet_->applyChange(tx, leg.quote, netCostOrProceeds, 0.0);
     } else {
-        ok1= wallet_->applyChange(tx, quoteAsset, -netCostOrProceeds, 0.0);
-        ok2= wallet_->applyChange(tx, baseAsset,  filled, 0.0);
+        ok1= wallet_->applyChange(tx, leg.quote, -netCostOrProceeds, 0.0);
+        ok2= wallet_->applyChange(tx, leg.base,  filled, 0.0);
     }
     if(!ok1||!ok2){
         std::cout<<"[SIM] wallet applyChange fail\n";
@@ -443,34 +461,58 @@ bool Simulator::doLeg(WalletTransaction& tx,
     auto t1= std::chrono::high_resolution_clock::now();
     double ms= std::chrono::duration<double,std::milli>(t1 - t0).count();
 
-    std::cout<<"[SIM] "<< sideStr <<" on "<< pairName
-             <<" fraction="<< fraction
+    std::cout<<"[SIM] "<< sideStr <<" on "<< symbol
+             <<" sizing="<< (sizedQtyBase > 0.0 ? "optimal" : "fraction")
              <<" desiredQty="<< desiredQtyBase
              <<" filled="<< filled
              <<" avgPx="<< avgPx
              <<" slip="<< slip
              <<" time="<< ms <<" ms\n";
 
-    logLeg(pairName, sideStr, desiredQtyBase, filled, fillRatio, slip, ms);
+    logLeg(symbol, sideStr, desiredQtyBase, filled, fillRatio, slip, ms);
     return true;
 }
 
 bool Simulator::doLegLive(WalletTransaction& tx,
-                          const std::string& pairName,
+                          const RouteLeg& leg,
                           double desiredQtyBase,
-                          bool isSell)
+                          double refPrice)
 {
     auto t0= std::chrono::high_resolution_clock::now();
-    std::string sideStr= (isSell? "SELL":"BUY");
+    const std::string& pairName = SymbolRegistry::instance().name(leg.symbol);
+    const bool isSell = leg.isSell;
 
-    double approximatePrice=30000.0; // filter check
-    if(!passesExchangeFilters(pairName, desiredQtyBase, approximatePrice)){
-        std::cout<<"[SIM-LIVE] fails exchange filters\n";
+    // checked at the live book price, with the quantity we'll actually send
+    if(!roundAndCheckQty(leg.symbol, desiredQtyBase, refPrice)){
         return false;
     }
 
     OrderSide sideEnum= (isSell? OrderSide::SELL : OrderSide::BUY);
     OrderResult res= executor_->placeMarketOrder(pairName, sideEnum, desiredQtyBase);
+
+    auto t1= std::chrono::high_resolution_clock::now();
+    double ms= std::chrono::duration<double,std::milli>(t1 - t0).count();
+
+    return applyLiveFill(tx, pairName,
+                         AssetRegistry::instance().name(leg.base),
+                         AssetRegistry::instance().name(leg.quote),
+                         isSell, desiredQtyBase, res, ms);
+}
+
+/**
+ * applyLiveFill => validate an exchange fill and book it into tx.
+ * Shared by the sequential (doLegLive) and parallel dispatch paths.
+ */
+bool Simulator::applyLiveFill(WalletTransaction& tx,
+                              const std::string& pairName,
+                              const std::string& baseAsset,
+                              const std::string& quoteAsset,
+                              bool isSell,
+                              double desiredQtyBase,
+                              const OrderResult& res,
+                              double latencyMs)
+{
+    std::string sideStr= (isSell? "SELL":"BUY");
     if(!res.success || res.filledQuantity<=0.0){
         std::cout<<"[SIM-LIVE] placeMarketOrder fail: "<< res.message <<"\n";
         return false;
@@ -490,7 +532,6 @@ bool Simulator::doLegLive(WalletTransaction& tx,
         netCostOrProceeds *= (1.0 + feePercent_);
     }
 
-    auto [baseAsset, quoteAsset]= parseSymbol(pairName);
     bool ok1=false, ok2=false;
     if(isSell){
         ok1= wallet_->applyChange(tx, baseAsset,  -res.filledQuantity, 0.0);
@@ -504,19 +545,199 @@ bool Simulator::doLegLive(WalletTransaction& tx,
         return false;
     }
 
-    auto t1= std::chrono::high_resolution_clock::now();
-    double ms= std::chrono::duration<double,std::milli>(t1 - t0).count();
     std::cout<<"[SIM-LIVE] "<< sideStr <<" "<< res.filledQuantity
              <<" base on "<< pairName
              <<" costOrProceeds="<< res.costOrProceeds
              <<" fillRatio="<< fillRatio
-             <<" time="<< ms <<" ms\n";
+             <<" time="<< latencyMs <<" ms\n";
 
     logLeg(pairName, sideStr, desiredQtyBase, res.filledQuantity,
-           fillRatio, 0.0, ms);
+           fillRatio, 0.0, latencyMs);
+    return true;
+}
+
+/**
+ * planIndependentLegs => size every leg up-front off current inventory.
+ * With `sized`, every leg takes the optimizer's quantity; otherwise leg 1
+ * spends maxFractionPerTrade_ of its input asset and each next leg spends
+ * what the previous one is expected to return (at best price, after fees).
+ * Returns false if any leg can't be resolved or if free inventory doesn't
+ * already cover every leg's input.
+ */
+bool Simulator::planIndependentLegs(const RouteLeg* legs,
+                                    size_t legCount,
+                                    const std::vector<OrderBookData>& books,
+                                    std::vector<LegPlan>& plans,
+                                    const SizedRoute* sized)
+{
+    if (legCount < 3 || books.size() < legCount) return false;
+    plans.assign(legCount, LegPlan{});
+
+    std::map<std::string, double> needed;
+    double carry = 0.0;
+    for (size_t i = 0; i < legCount; i++) {
+        LegPlan& p = plans[i];
+        p.symbol     = SymbolRegistry::instance().name(legs[i].symbol);
+        p.baseAsset  = AssetRegistry::instance().name(legs[i].base);
+        p.quoteAsset = AssetRegistry::instance().name(legs[i].quote);
+        p.isSell     = legs[i].isSell;
+
+        const auto& ob = books[i];
+        if (p.isSell && !ob.bids.empty())       p.bestPx = ob.bids[0].price;
+        else if (!p.isSell && !ob.asks.empty()) p.bestPx = ob.asks[0].price;
+        if (p.bestPx <= 0.0) return false;
+
+        const std::string& inAsset = (p.isSell ? p.baseAsset : p.quoteAsset);
+        if (i == 0) {
+            carry = wallet_->getFreeBalance(inAsset) * maxFractionPerTrade_;
+        }
+        if (carry <= 1e-12) return false;
+
+        if (sized && sized->ok) p.qtyBase = sized->legQtyBase[i];
+        else p.qtyBase = (p.isSell ? carry : carry / (p.bestPx * (1.0 + feePercent_)));
+        if (!roundAndCheckQty(legs[i].symbol, p.qtyBase, p.bestPx)) return false;
+
+        // sized off the step-rounded quantity we'll actually send
+        if (p.isSell) {
+            p.inputAmt    = p.qtyBase;
+            p.expectedOut = p.qtyBase * p.bestPx * (1.0 - feePercent_);
+        } else {
+            p.inputAmt    = p.qtyBase * p.bestPx * (1.0 + feePercent_);
+            p.expectedOut = p.qtyBase;
+        }
+
+        needed[inAsset] += p.inputAmt;
+        carry = p.expectedOut;
+    }
+
+    for (auto& kv : needed) {
+        if (wallet_->getFreeBalance(kv.first) + 1e-12 < kv.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * executeLegsParallel => fire all planned legs concurrently, then reconcile.
+ * If any leg fails, every leg that did fill is reversed on the exchange and
+ * the caller rolls back tx. On success the per-asset inventory drift (what
+ * each asset gained/lost vs. before the triangle) is rebalanced.
+ */
+bool Simulator::executeLegsParallel(WalletTransaction& tx,
+                                    const std::vector<LegPlan>& plans,
+                                    std::string* failReason)
+{
+    auto t0 = std::chrono::high_resolution_clock::now();
+    const size_t legCount = plans.size();
+
+    std::vector<std::future<OrderResult>> futs(legCount);
+    for (size_t i = 0; i < legCount; i++) {
+        const LegPlan* p = &plans[i];
+        futs[i] = legPool_->submit([this, p](){
+            return executor_->placeMarketOrder(p->symbol,
+                                               p->isSell ? OrderSide::SELL : OrderSide::BUY,
+                                               p->qtyBase);
+        });
+    }
+    std::vector<OrderResult> results(legCount);
+    for (size_t i = 0; i < legCount; i++) {
+        results[i] = futs[i].get();
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    double ms = std::chrono::duration<double,std::milli>(t1 - t0).count();
+
+    // reconcile: book every fill, remember which ones hit the exchange
+    bool allOk = true;
+    std::vector<ReversibleLeg> filled(legCount);
+    std::map<std::string, double> drift;
+    for (size_t i = 0; i < legCount; i++) {
+        const LegPlan& p = plans[i];
+        const OrderResult& r = results[i];
+        if (r.success && r.filledQuantity > 0.0) {
+            filled[i].success       = true;
+            filled[i].symbol        = p.symbol;
+            filled[i].sideSell      = p.isSell;
+            filled[i].filledQtyBase = r.filledQuantity;
+        }
+        if (!applyLiveFill(tx, p.symbol, p.baseAsset, p.quoteAsset, p.isSell,
+                           p.qtyBase, r, ms)) {
+            allOk = false;
+            continue;
+        }
+        double quoteAmt = r.costOrProceeds * (p.isSell ? (1.0 - feePercent_) : (1.0 + feePercent_));
+        drift[p.baseAsset]  += (p.isSell ? -r.filledQuantity : r.filledQuantity);
+        drift[p.quoteAsset] += (p.isSell ? quoteAmt : -quoteAmt);
+    }
+
+    if (!allOk) {
+        if (failReason) *failReason = "PARALLEL_LEG_FAIL";
+        std::cout << "[SIM-PARALLEL] leg failure => reversing filled legs.\n";
+        for (size_t i = legCount; i-- > 0; ) {
+            if (filled[i].success) {
+                reverseRealLeg(filled[i]);
+            }
+        }
+        return false;
+    }
+
+    std::cout << "[SIM-PARALLEL] " << legCount << " legs in " << ms << " ms, inventory drift:";
+    for (auto& kv : drift) {
+        std::cout << " " << kv.first << "=" << kv.second;
+    }
+    std::cout << "\n";
+
+    rebalanceInventory(tx, plans, drift);
     return true;
 }
 
+/**
+ * rebalanceInventory => place the InventoryRebalancer orders one after the
+ * other (each settles what the previous one moved) and book them into tx.
+ * The triangle itself already filled, so a failed correction only stops the
+ * rest: the assets it would have settled keep their drift.
+ */
+void Simulator::rebalanceInventory(WalletTransaction& tx,
+                                   const std::vector<LegPlan>& plans,
+                                   const std::map<std::string, double>& drift)
+{
+    std::vector<RebalanceOrder> orders;
+    InventoryRebalancer::plan(plans, drift, feePercent_,
+        [this](const LegPlan& leg, double& qtyBase){
+            // dust left below the filters is expected, not a refused order
+            return roundAndCheckQty(leg.symbol, qtyBase, leg.bestPx, false);
+        },
+        orders);
+
+    for (const auto& o : orders) {
+        const LegPlan& p = plans[o.leg];
+        auto t0 = std::chrono::high_resolution_clock::now();
+        OrderResult r = executor_->placeMarketOrder(o.symbol,
+                                                    o.isSell ? OrderSide::SELL : OrderSide::BUY,
+                                                    o.qtyBase);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double,std::milli>(t1 - t0).count();
+
+        std::cout << "[SIM-REBALANCE] " << (o.isSell ? "SELL " : "BUY ") << o.qtyBase
+                  << " base on " << o.symbol << "\n";
+        if (applyLiveFill(tx, o.symbol, p.baseAsset, p.quoteAsset, o.isSell, o.qtyBase, r, ms)) {
+            continue;
+        }
+        if (r.success && r.filledQuantity > 0.0) {
+            // filled but not bookable => take it back off the exchange
+            ReversibleLeg rev;
+            rev.success       = true;
+            rev.symbol        = o.symbol;
+            rev.sideSell      = o.isSell;
+            rev.filledQtyBase = r.filledQuantity;
+            reverseRealLeg(rev);
+        }
+        std::cout << "[SIM-REBALANCE] " << o.symbol << " failed => remaining drift left in place.\n";
+        return;
+    }
+}
+
 double Simulator::simulateTrade(const Triangle&,
                                 double,
                                 double, double,
@@ -526,6 +747,19 @@ double Simulator::simulateTrade(const Triangle&,
     return 0.0;
 }
 
+void Simulator::prestageTriangle(const Triangle& tri)
+{
+    if (!executor_ || !liveMode_) return;
+    RouteLeg legs[MAX_ROUTE_LEGS];
+    if (!resolveRoute(tri, legs)) return;
+    auto& reg = SymbolRegistry::instance();
+    for (size_t i = 0; i < tri.path.size(); i++) {
+        executor_->prestageOrder(reg.name(legs[i].symbol),
+                                 legs[i].isSell ? OrderSide::SELL : OrderSide::BUY,
+                                 reg.info(legs[i].symbol).qtyDecimals);
+    }
+}
+
 void Simulator::printWallet() const {
     wallet_->printAll();
 }
@@ -589,48 +823,137 @@ double Simulator::getCumulativeProfit() const {
     return cumulativeProfit_;
 }
 
-std::vector<std::string> Simulator::getAssetsForPair(const std::string& pairName) const {
-    auto [b,q]= parseSymbol(pairName);
-    if(q=="UNKNOWN"){
-        return {};
+/**
+ * resolveLeg => symbol id, assets and side for one path entry.
+ * The side comes from the _FWD/_INV tag; an untagged (file) leg follows the
+ * route: it spends `from`, the asset the previous leg produced. Only looks
+ * the symbol up: anything the topology loader didn't register fails the
+ * route (BAD_ROUTE).
+ */
+bool Simulator::resolveLeg(const std::string& leg, AssetId from, RouteLeg& out) const
+{
+    std::string raw;
+    LegDirection dir = splitLegSymbol(leg, raw);
+
+    auto& reg = SymbolRegistry::instance();
+    SymbolId id = reg.find(raw);
+    if (id == INVALID_SYMBOL) return false;
+    const SymbolInfo& si = reg.info(id);
+    if (si.baseAsset == INVALID_ASSET) return false;
+
+    out.symbol = id;
+    out.base   = si.baseAsset;
+    out.quote  = si.quoteAsset;
+    if (dir == LegDirection::FORWARD)      out.isSell = true;
+    else if (dir == LegDirection::INVERSE) out.isSell = false;
+    else out.isSell = (from == INVALID_ASSET || from == out.base);
+
+    return from == INVALID_ASSET || out.input() == from;
+}
+
+// every leg resolved, each spending what the previous one produced, back to the start
+bool Simulator::resolveRoute(const Triangle& tri, RouteLeg* legs) const
+{
+    const size_t legCount = tri.path.size();
+    if (legCount < 3 || legCount > MAX_ROUTE_LEGS) return false;
+
+    AssetId from = tri.base.empty() ? INVALID_ASSET : AssetRegistry::instance().find(tri.base);
+    for (size_t i = 0; i < legCount; i++) {
+        if (!resolveLeg(tri.path[i], from, legs[i])) return false;
+        from = legs[i].output();
     }
-    return {b,q};
+    return from == legs[0].input();
 }
 
-std::vector<SimCandidate> Simulator::simulateMultipleTrianglesConcurrently(
-    const std::vector<Triangle>& triangles)
+void Simulator::collectRouteAssets(const RouteLeg* legs, size_t legCount, RouteAssets& out) const
 {
-    std::vector<SimCandidate> results(triangles.size());
-    std::vector<std::future<double>> futs;
-    futs.reserve(triangles.size());
-
-    for(size_t i=0; i< triangles.size(); i++){
-        futs.push_back(std::async(std::launch::async, [this, &triangles, i](){
-            const auto& tri = triangles[i];
-            if(tri.path.size()<3) return -999.0;
-
-            OrderBookData ob1, ob2, ob3;
-            if(executor_){
-                ob1 = executor_->getOrderBookSnapshot(tri.path[0]);
-                ob2 = executor_->getOrderBookSnapshot(tri.path[1]);
-                ob3 = executor_->getOrderBookSnapshot(tri.path[2]);
-            }
-            if(ob1.bids.empty()||ob1.asks.empty()||
-               ob2.bids.empty()||ob2.asks.empty()||
-               ob3.bids.empty()||ob3.asks.empty()){
-                return -999.0;
-            }
+    out.count = 0;
+    for (size_t i = 0; i < legCount; i++) {
+        for (AssetId a : { legs[i].base, legs[i].quote }) {
+            size_t k = 0;
+            while (k < out.count && out.id[k] != a) k++;
+            if (k == out.count && out.count < MAX_ROUTE_LEGS + 1) out.id[out.count++] = a;
+        }
+    }
+    std::sort(out.id, out.id + out.count); // lock order
+    for (size_t k = 0; k < out.count; k++) {
+        out.usdtPx[k] = UsdtValuation::instance().price(out.id[k]);
+    }
+}
+
+/**
+ * simulateBatch => chunks of candidates on the caller's pool. Each task
+ * writes only its own slice of `out`, the snapshot is read-only and the
+ * sizer's scratch is thread_local, so the tasks share nothing mutable.
+ */
+void Simulator::simulateBatch(const std::vector<Triangle>& routes,
+                              const int* ids,
+                              size_t count,
+                              const BookSnapshot& books,
+                              ThreadPool& pool,
+                              SimCandidate* out,
+                              size_t chunkSize)
+{
+    if (count == 0) return;
+    if (chunkSize == 0) chunkSize = 1;
+
+    auto runChunk = [this, &routes, ids, &books, out](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            int id = ids[k];
+            out[k].triIndex = id;
+            out[k].estimatedProfit = (id >= 0 && id < (int)routes.size())
+                                   ? estimateSnapshotProfitUSDT(routes[id], books)
+                                   : -999.0;
+        }
+    };
 
-            double est = this->estimateTriangleProfitUSDT(tri, ob1, ob2, ob3);
-            return est;
-        }));
+    // a single chunk isn't worth the hand-off
+    if (count <= chunkSize) {
+        runChunk(0, count);
+        return;
     }
 
-    for(size_t i=0; i<futs.size(); i++){
-        double pf= futs[i].get();
-        results[i].triIndex        = (int)i;
-        results[i].estimatedProfit = pf;
+    std::vector<std::future<void>> futs;
+    futs.reserve((count + chunkSize - 1) / chunkSize);
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+        futs.push_back(pool.submit(runChunk, begin, std::min(begin + chunkSize, count)));
     }
+    for (auto& f : futs) f.get();
+}
+
+std::vector<SimCandidate> Simulator::simulateMultipleTrianglesConcurrently(
+    const std::vector<Triangle>& triangles,
+    ThreadPool& pool)
+{
+    std::vector<SimCandidate> results(triangles.size());
+    if (triangles.empty()) return results;
+
+    // one executor fetch per distinct symbol, not one per leg
+    auto& reg = SymbolRegistry::instance();
+    std::vector<SymbolId> symbols;
+    for (const auto& tri : triangles) {
+        for (const auto& leg : tri.path) {
+            SymbolId id = reg.find(rawLegSymbol(leg));
+            if (id != INVALID_SYMBOL) symbols.push_back(id);
+        }
+    }
+    std::sort(symbols.begin(), symbols.end());
+    symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+    BookSnapshot books;
+    books.slot.assign(reg.size(), -1);
+    if (executor_) {
+        books.books.resize(symbols.size());
+        for (SymbolId id : symbols) {
+            books.books[books.count] = executor_->getOrderBookSnapshot(reg.name(id));
+            books.slot[id] = (int)books.count++;
+        }
+    }
+
+    std::vector<int> ids(triangles.size());
+    for (size_t i = 0; i < ids.size(); i++) ids[i] = (int)i;
+
+    simulateBatch(triangles, ids.data(), ids.size(), books, pool, results.data());
     return results;
 }
 
@@ -654,12 +977,15 @@ void Simulator::executeTopCandidatesSequentially(const std::vector<Triangle>& tr
         if(idx<0 || idx>=(int)triangles.size()) continue;
         const auto& tri = triangles[idx];
 
-        OrderBookData ob1, ob2, ob3;
-        if(executor_){
-            ob1= executor_->getOrderBookSnapshot(tri.path[0]);
-            ob2= executor_->getOrderBookSnapshot(tri.path[1]);
-            ob3= executor_->getOrderBookSnapshot(tri.path[2]);
+        std::vector<OrderBookData> obs(3);
+        if(executor_ && !executor_->getOrderBookSnapshots(
+               { rawLegSymbol(tri.path[0]), rawLegSymbol(tri.path[1]), rawLegSymbol(tri.path[2]) }, obs)){
+            std::cout << "[EXEC] skip triIdx="<< idx <<" => torn OB\n";
+            continue;
         }
+        const OrderBookData& ob1 = obs[0];
+        const OrderBookData& ob2 = obs[1];
+        const OrderBookData& ob3 = obs[2];
         if(ob1.bids.empty()||ob1.asks.empty()||
            ob2.bids.empty()||ob2.asks.empty()||
            ob3.bids.empty()||ob3.asks.empty()){
@@ -738,100 +1064,148 @@ double Simulator::estimateTriangleProfitUSDT(const Triangle& tri,
                                              const OrderBookData& ob2,
                                              const OrderBookData& ob3)
 {
-    double b1 = (ob1.bids.empty()? 0.0 : ob1.bids[0].price);
-    double b2 = (ob2.bids.empty()? 0.0 : ob2.bids[0].price);
-    double b3 = (ob3.bids.empty()? 0.0 : ob3.bids[0].price);
-
-    double oldValUSDT = wallet_->getFreeBalance("USDT")
-                      + wallet_->getFreeBalance("BTC") * b1
-                      + wallet_->getFreeBalance("ETH") * b2;
-
-    double fakeUSDT = wallet_->getFreeBalance("USDT");
-    double fakeBTC  = wallet_->getFreeBalance("BTC");
-    double fakeETH  = wallet_->getFreeBalance("ETH");
-
-    auto simulateLegFake = [&](const std::string &symbol, const OrderBookData &ob)->bool {
-        auto [baseAsset, quoteAsset] = parseSymbol(symbol);
-        if (quoteAsset=="UNKNOWN") return false;
-
-        bool isSell = (quoteAsset=="USDT"||quoteAsset=="BTC"||quoteAsset=="BUSD"||quoteAsset=="ETH");
-
-        double bestPx=0.0;
-        if(isSell && !ob.bids.empty()) bestPx= ob.bids[0].price;
-        else if(!isSell && !ob.asks.empty()) bestPx= ob.asks[0].price;
-        if(bestPx<=0.0) return false;
-
-        double fraction= maxFractionPerTrade_;
-        double freeAmt=0.0;
-        double desiredQtyBase=0.0;
-
-        if(isSell){
-            if(baseAsset=="BTC") freeAmt= fakeBTC;
-            else if(baseAsset=="ETH") freeAmt= fakeETH;
-            if(freeAmt<=1e-12) return false;
+    return estimateCycleProfitUSDT(tri, { ob1, ob2, ob3 });
+}
 
-            desiredQtyBase= freeAmt * fraction;
-        } else {
-            if(quoteAsset=="USDT") freeAmt= fakeUSDT;
-            else if(quoteAsset=="BTC") freeAmt= fakeBTC;
-            else if(quoteAsset=="ETH") freeAmt= fakeETH;
-            if(freeAmt<=1e-12) return false;
+double Simulator::estimateCycleProfitUSDT(const Triangle& tri,
+                                          const std::vector<OrderBookData>& books)
+{
+    RouteLeg legs[MAX_ROUTE_LEGS];
+    if (books.size() < tri.path.size() || !resolveRoute(tri, legs)) return -1.0;
+    const OrderBookData* bookPtrs[MAX_ROUTE_LEGS];
+    for (size_t i = 0; i < tri.path.size(); i++) bookPtrs[i] = &books[i];
+    SizedRoute sized;
+    return estimateSizedProfitUSDT(legs, tri.path.size(), bookPtrs, sized);
+}
 
-            double rawSpend= freeAmt * fraction;
-            if(rawSpend<=1e-12) return false;
+double Simulator::estimateSnapshotProfitUSDT(const Triangle& tri, const BookSnapshot& books)
+{
+    RouteLeg legs[MAX_ROUTE_LEGS];
+    if (!resolveRoute(tri, legs)) return -999.0;
+    const size_t legCount = tri.path.size();
+    const OrderBookData* bookPtrs[MAX_ROUTE_LEGS];
+    for (size_t i = 0; i < legCount; i++) {
+        bookPtrs[i] = books.find(legs[i].symbol);
+        if (!bookPtrs[i]) return -999.0;
+    }
+    SizedRoute sized;
+    return estimateSizedProfitUSDT(legs, legCount, bookPtrs, sized);
+}
 
-            desiredQtyBase= rawSpend / bestPx;
-        }
+/**
+ * estimateSizedProfitUSDT => optimal size from TradeSizer, then the
+ * step-rounded legs replayed through the books on a scratch portfolio (one
+ * delta per route asset) and valued in USDT. Rounding dust left in an
+ * intermediate asset counts at its USDT price (0 if it has none).
+ * -1 if no size is profitable, a leg fails the exchange filters / fill /
+ * slippage checks or free inventory doesn't cover it, or the start asset
+ * can't be valued. Never allocates.
+ */
+double Simulator::estimateSizedProfitUSDT(const RouteLeg* legs,
+                                          size_t legCount,
+                                          const OrderBookData* const* books,
+                                          SizedRoute& sized)
+{
+    if (!sizeRoute(legs, legCount, books, sized)) return -1.0;
+
+    RouteAssets assets;
+    collectRouteAssets(legs, legCount, assets);
+    double delta[MAX_ROUTE_LEGS + 1] = {};
+    auto slot = [&](AssetId a) -> size_t {
+        size_t k = 0;
+        while (assets.id[k] != a) k++;
+        return k;
+    };
 
-        if(!passesExchangeFilters(symbol, desiredQtyBase, bestPx)){
-            return false;
-        }
+    for (size_t i = 0; i < legCount; i++) {
+        const RouteLeg& leg = legs[i];
+        const auto& levels = (leg.isSell ? books[i]->bids : books[i]->asks);
+        const double bestPx = levels[0].price;
+        const double qty = sized.legQtyBase[i];
 
-        double filled=0.0, cost=0.0;
-        const auto &levels= (isSell? ob.bids : ob.asks);
-        double remain= desiredQtyBase;
-        for(auto &lvl: levels){
-            double tradeQty= std::min(remain, lvl.quantity);
-            double tradeCost= tradeQty* lvl.price;
+        double filled = 0.0, cost = 0.0, remain = qty;
+        for (const auto& lvl : levels) {
+            double tradeQty = std::min(remain, lvl.quantity);
             filled += tradeQty;
-            cost   += tradeCost;
+            cost   += tradeQty * lvl.price;
             remain -= tradeQty;
-            if(remain<=1e-12) break;
+            if (remain <= 1e-12) break;
         }
-        if(filled<=1e-12) return false;
-
-        double fillRatio= filled/ desiredQtyBase;
-        if(fillRatio< minFillRatio_) return false;
+        if (filled <= 1e-12 || filled / qty < minFillRatio_) return -1.0;
+        if (std::fabs(cost / filled - bestPx) / bestPx > slippageTolerance_) return -1.0;
+
+        size_t in = slot(leg.input()), out = slot(leg.output());
+        double spent = (leg.isSell ? filled : cost * (1.0 + feePercent_));
+        double got   = (leg.isSell ? cost * (1.0 - feePercent_) : filled);
+        double have = wallet_->getFreeBalance(leg.input()) + delta[in];
+        if (have * (1.0 + 1e-12) + 1e-12 < spent) return -1.0;
+        delta[in]  -= spent;
+        delta[out] += got;
+    }
 
-        double avgPx= cost/ filled;
-        double slip= std::fabs(avgPx- bestPx)/ bestPx;
-        if(slip> slippageTolerance_) return false;
+    if (assets.usdtPx[slot(legs[0].input())] <= 0.0) return -1.0;
+    double netProfit = 0.0;
+    for (size_t k = 0; k < assets.count; k++) {
+        netProfit += delta[k] * assets.usdtPx[k];
+    }
+    return netProfit;
+}
 
-        if(isSell){
-            double netProceeds= cost*(1.0 - feePercent_);
-            if(baseAsset=="BTC") fakeBTC -= filled;
-            else if(baseAsset=="ETH") fakeETH -= filled;
+/**
+ * sizeRoute => let TradeSizer find the profit-maximizing input (capped at
+ * maxFractionPerTrade_ of the free start asset, levels within
+ * slippageTolerance_ of best), then floor each leg's quantity to its step
+ * (never more than the previous rounded leg delivers) and check it against
+ * the exchange filters.
+ */
+bool Simulator::sizeRoute(const RouteLeg* legs,
+                          size_t legCount,
+                          const OrderBookData* const* books,
+                          SizedRoute& sized)
+{
+    if (legCount < 3 || legCount > MAX_ROUTE_LEGS) return false;
+
+    SizerLeg sizerLegs[MAX_ROUTE_LEGS];
+    for (size_t i = 0; i < legCount; i++) {
+        sizerLegs[i].book    = books[i];
+        sizerLegs[i].isSell  = legs[i].isSell;
+        sizerLegs[i].fee     = feePercent_;
+        sizerLegs[i].maxSlip = slippageTolerance_;
+    }
 
-            if(quoteAsset=="USDT") fakeUSDT += netProceeds;
-            else if(quoteAsset=="BTC") fakeBTC += netProceeds;
-            else if(quoteAsset=="ETH") fakeETH += netProceeds;
+    double maxInput = wallet_->getFreeBalance(legs[0].input()) * maxFractionPerTrade_;
+    if (maxInput <= 1e-12) return false;
+    if (!TradeSizer::optimize(sizerLegs, legCount, maxInput, sized)) return false;
+
+    // rounding a leg down leaves the next one a little less to spend: carry
+    // what each rounded leg actually returns into the next one's quantity
+    double carry = sized.input;
+    for (size_t i = 0; i < legCount; i++) {
+        const auto& lv = (legs[i].isSell ? books[i]->bids : books[i]->asks);
+        double qty = sized.legQtyBase[i];
+        if (legs[i].isSell) {
+            qty = std::min(qty, carry);
         } else {
-            double netCost= cost*(1.0 + feePercent_);
-            if(quoteAsset=="USDT") fakeUSDT -= netCost;
-            else if(quoteAsset=="BTC") fakeBTC -= netCost;
-            else if(quoteAsset=="ETH") fakeETH -= netCost;
-
-            if(baseAsset=="BTC") fakeBTC += filled;
-            else if(baseAsset=="ETH") fakeETH += filled;
+            double budget = carry / (1.0 + feePercent_), affordable = 0.0;
+            for (const auto& lvl : lv) {
+                double take = std::min(lvl.quantity, budget / lvl.price);
+                affordable += take;
+                budget     -= take * lvl.price;
+                if (budget <= 0.0) break;
+            }
+            qty = std::min(qty, affordable);
         }
-        return true;
-    };
-
-    if(!simulateLegFake(tri.path[0], ob1)) return -1.0;
-    if(!simulateLegFake(tri.path[1], ob2)) return -1.0;
-    if(!simulateLegFake(tri.path[2], ob3)) return -1.0;
-
-    double finalValUSDT= fakeUSDT + (fakeBTC * b3) + (fakeETH * b2);
-    double netProfit= finalValUSDT - oldValUSDT;
-    return netProfit;
+        if (!roundAndCheckQty(legs[i].symbol, qty, lv[0].price, false)) return false;
+        sized.legQtyBase[i] = qty;
+
+        double cost = 0.0, remain = qty;
+        for (const auto& lvl : lv) {
+            double take = std::min(remain, lvl.quantity);
+            cost   += take * lvl.price;
+            remain -= take;
+            if (remain <= 0.0) break;
+        }
+        carry = (legs[i].isSell ? cost * (1.0 - feePercent_) : qty);
+    }
+    return true;
 }
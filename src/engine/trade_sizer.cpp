@@ -0,0 +1,137 @@
+#include "engine/trade_sizer.hpp"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct Segment {
+    double cap;  // input units this segment absorbs
+    double rate; // output per input
+};
+
+/**
+ * ladder => one segment per level within maxSlip of best price.
+ * SELL: base in, quote out at price*(1-fee).
+ * BUY:  quote in (price*qty*(1+fee) per level), base out at 1/(price*(1+fee)).
+ */
+void buildLadder(const SizerLeg& leg, std::vector<Segment>& out)
+{
+    out.clear();
+    if (!leg.book) return;
+    const auto& levels = (leg.isSell ? leg.book->bids : leg.book->asks);
+    if (levels.empty() || levels[0].price <= 0.0) return;
+    const double best = levels[0].price;
+
+    for (const auto& lvl : levels) {
+        if (lvl.price <= 0.0 || lvl.quantity <= 0.0) continue;
+        if (std::fabs(lvl.price - best) / best > leg.maxSlip) break;
+        if (leg.isSell) {
+            out.push_back({ lvl.quantity, lvl.price * (1.0 - leg.fee) });
+        } else {
+            double px = lvl.price * (1.0 + leg.fee);
+            out.push_back({ lvl.quantity * px, 1.0 / px });
+        }
+    }
+}
+
+} // namespace
+
+bool TradeSizer::optimize(const SizerLeg* legs, size_t n, double maxInput, SizedRoute& out)
+{
+    out = SizedRoute{};
+    if (n == 0 || n > MAX_ROUTE_LEGS) return false;
+
+    static thread_local std::vector<Segment> ladders[MAX_ROUTE_LEGS];
+    static thread_local std::vector<Segment> cur, next;
+
+    // suffix[j] = best rate of legs j..n-1 combined: an upper bound on what
+    // one unit entering leg j can still become
+    double suffix[MAX_ROUTE_LEGS + 1];
+    suffix[n] = 1.0;
+    for (size_t j = 0; j < n; j++) {
+        buildLadder(legs[j], ladders[j]);
+        if (ladders[j].empty()) return false;
+    }
+    for (size_t j = n; j-- > 0; ) {
+        suffix[j] = suffix[j + 1] * ladders[j][0].rate;
+    }
+    if (suffix[0] <= 1.0) return false; // not even the top of book pays
+
+    // leg 1, capped at maxInput, cut where nothing downstream can pay
+    cur.clear();
+    double left = (maxInput > 0.0 ? maxInput : INFINITY);
+    for (const auto& s : ladders[0]) {
+        if (left <= 0.0 || s.rate * suffix[1] <= 1.0) break;
+        double cap = std::min(s.cap, left);
+        cur.push_back({ cap, s.rate });
+        left -= cap;
+    }
+
+    // merge breakpoints: a segment of the composed route ends where either
+    // the route-so-far or leg j runs out of its current level
+    for (size_t j = 1; j < n && !cur.empty(); j++) {
+        const auto& lad = ladders[j];
+        next.clear();
+        size_t a = 0, b = 0;
+        double remA = cur[0].cap;   // route-input units
+        double remB = lad[0].cap;   // leg-j input units
+        while (a < cur.size() && b < lad.size()) {
+            double rate = cur[a].rate * lad[b].rate;
+            if (rate * suffix[j + 1] <= 1.0) break; // rates only fall from here
+            double fitB = remB / cur[a].rate; // leg j's level, in route-input units
+            if (remA <= fitB) {
+                next.push_back({ remA, rate });
+                remB -= remA * cur[a].rate;
+                if (++a < cur.size()) remA = cur[a].cap;
+                if (remB <= 0.0 && ++b < lad.size()) remB = lad[b].cap;
+            } else {
+                next.push_back({ fitB, rate });
+                remA -= fitB;
+                if (++b < lad.size()) remB = lad[b].cap;
+            }
+        }
+        cur.swap(next);
+    }
+    if (cur.empty()) return false;
+
+    double input = 0.0, output = 0.0;
+    for (const auto& s : cur) {
+        input  += s.cap;
+        output += s.cap * s.rate;
+    }
+    if (output <= input) return false;
+
+    walk(legs, n, input, &out);
+    out.ok     = true;
+    out.input  = input;
+    out.output = output;
+    out.profit = output - input;
+    return true;
+}
+
+double TradeSizer::walk(const SizerLeg* legs, size_t n, double input, SizedRoute* out)
+{
+    if (n > MAX_ROUTE_LEGS) return 0.0;
+    if (out) out->legs = n;
+
+    static thread_local std::vector<Segment> lad;
+    double amount = input;
+    for (size_t j = 0; j < n; j++) {
+        buildLadder(legs[j], lad);
+        double spent = 0.0, got = 0.0;
+        for (const auto& s : lad) {
+            double x = std::min(s.cap, amount - spent);
+            if (x <= 0.0) break;
+            spent += x;
+            got   += x * s.rate;
+        }
+        if (out) {
+            out->legInput[j]   = spent;
+            out->legOutput[j]  = got;
+            out->legQtyBase[j] = (legs[j].isSell ? spent : got);
+        }
+        amount = got;
+    }
+    return amount;
+}
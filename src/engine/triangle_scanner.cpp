@@ -1,6 +1,10 @@
 #include "engine/triangle_scanner.hpp"
 #include "engine/simulator.hpp"
 #include "core/orderbook.hpp"
+#include "core/symbol_registry.hpp"
+#include "core/usdt_valuation.hpp"
+#include "engine/opportunity_tracker.hpp"
+#include "core/timer_service.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -9,20 +13,12 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
-#include <curl/curl.h>  // for HTTP fetch
+#include <cmath>
 
 using json = nlohmann::json;
 
-// Turn on reversed edges by default
-static bool USE_INVERSE_EDGES = true;
-// BFS debug info
-static bool DEBUG_BFS = true;
-
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* out) {
-    size_t totalSize = size * nmemb;
-    out->append((char*)contents, totalSize);
-    return totalSize;
-}
+// BFS debug info (one line per discovered cycle)
+static bool DEBUG_BFS = false;
 
 TriangleScanner::TriangleScanner()
     : pool_(4)
@@ -34,7 +30,9 @@ void TriangleScanner::setOrderBookManager(OrderBookManager* obm) {
 }
 
 /**
- * Optionally keep: load triangles from file
+ * Optionally keep: load triangles from file. Legs exchangeInfo never told us
+ * about are registered here, once, from the quote suffix with default
+ * filters; a triangle with a leg that can't be parsed is skipped.
  */
 void TriangleScanner::loadTrianglesFromFile(const std::string& filepath) {
     std::ifstream file(filepath);
@@ -45,6 +43,8 @@ void TriangleScanner::loadTrianglesFromFile(const std::string& filepath) {
 
     json j;
     file >> j;
+
+    std::unique_lock<std::shared_mutex> topoLock(topoMutex_);
     for (auto& item : j) {
         Triangle tri;
         tri.base = item["base"].get<std::string>();
@@ -53,24 +53,45 @@ void TriangleScanner::loadTrianglesFromFile(const std::string& filepath) {
             tri.path.push_back(p.get<std::string>());
         }
 
-        // start websockets
-        for (const auto& sym : tri.path) {
-            if (obm_) {
-                obm_->start(sym);
+        auto& reg = SymbolRegistry::instance();
+        bool known = true;
+        for (const auto& leg : tri.path) {
+            std::string rawSym;
+            splitLegSymbol(leg, rawSym);
+            SymbolId id = reg.find(rawSym);
+            if (id != INVALID_SYMBOL && reg.info(id).baseAsset != INVALID_ASSET) continue;
+            auto [b,q] = parseSymbol(rawSym);
+            if (q == "UNKNOWN" ||
+                reg.registerSymbol(rawSym, b, q, SymbolInfo{}, SymbolFilters{}) == INVALID_SYMBOL) {
+                std::cerr << "[FILE] Unknown symbol " << rawSym << ", skipping triangle\n";
+                known = false;
+                break;
             }
         }
+        if (!known) continue;
 
-        int idx = (int)triangles_.size();
-        triangles_.push_back(tri);
-        for (auto& sym : tri.path) {
-            symbolToTriangles_[sym].push_back(idx);
+        // start websockets (raw exchange symbol, not the _FWD/_INV leg name)
+        for (const auto& leg : tri.path) {
+            if (obm_) {
+                std::string rawSym;
+                splitLegSymbol(leg, rawSym);
+                obm_->start(rawSym);
+            }
         }
+
+        topo_.addTriangle(tri);
     }
+    syncRouteEdges();
 
-    // resize lastProfits_ to match new triangles
-    lastProfits_.resize(triangles_.size(), -999.0);
+    // one heap slot + one guard entry per triangle id
+    {
+        std::lock_guard<std::mutex> lk(bestTriMutex_);
+        bestTriangles_.resize(topo_.size());
+    }
+    resetRouteGuards();
+    routeGuards_.reserve(topo_.size());
 
-    std::cout << "[FILE] Loaded " << triangles_.size() << " triangle(s)\n";
+    std::cout << "[FILE] Loaded " << topo_.size() << " triangle(s)\n";
 }
 
 /**
@@ -82,273 +103,259 @@ bool TriangleScanner::loadTrianglesFromBinanceExchangeInfo() {
         return false;
     }
 
-    std::string url = "https://api.binance.com/api/v3/exchangeInfo";
-    CURL* curl = curl_easy_init();
-    if(!curl) {
-        std::cerr << "[DYNAMIC] curl init failed\n";
-        return false;
+    // warm start from the binary cache; only downloads when stale/missing
+    if (!exchangeInfo_) {
+        exchangeInfo_.reset(new ExchangeInfoCache());
     }
-    std::string response;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        std::cerr << "[DYNAMIC] exchangeInfo curl error: "
-                  << curl_easy_strerror(res) << "\n";
-        curl_easy_cleanup(curl);
+    ExchangeUniverse uni;
+    if (!exchangeInfo_->load(uni)) {
+        std::cerr << "[DYNAMIC] No exchangeInfo (download failed, no cache)\n";
         return false;
     }
-    curl_easy_cleanup(curl);
 
-    json j;
-    try {
-        j = json::parse(response);
-    } catch(...) {
-        std::cerr << "[DYNAMIC] parse exchangeInfo JSON failed\n";
-        return false;
+    std::vector<TopologySymbol> symbols;
+    symbols.reserve(uni.symbols.size());
+    for (const auto& us : uni.symbols) {
+        // price/qty scale + LOT_SIZE/PRICE_FILTER/NOTIONAL filters, by symbol id
+        SymbolRegistry::instance().registerSymbol(us.symbol, us.baseAsset, us.quoteAsset,
+                                                  us.info, us.filters);
+        symbols.push_back({ us.symbol, us.baseAsset, us.quoteAsset });
     }
-    if(!j.contains("symbols") || !j["symbols"].is_array()) {
-        std::cerr << "[DYNAMIC] No 'symbols' array in exchangeInfo\n";
-        return false;
-    }
-
-    // adjacency: baseAsset -> [ (quoteAsset, "SYMBOL_FWD"), ...]
-    std::unordered_map<std::string, std::vector<std::pair<std::string,std::string>>> adjacency;
-    adjacency.reserve(2000);
+    std::cout << "[DYNAMIC] Found " << symbols.size() << " trading pairs.\n";
 
-    int count=0;
-    for (auto& symObj : j["symbols"]) {
-        if (!symObj.contains("symbol") ||
-            !symObj.contains("baseAsset")||
-            !symObj.contains("quoteAsset")||
-            !symObj.contains("status")) continue;
+    if (cycleDetector_) {
+        cycleDetector_->build(symbols, topoOptions_);
+        std::cout << "[CYCLES] " << cycleDetector_->assetCount() << " assets / "
+                  << cycleDetector_->edgeCount() << " edges for 4/5-leg detection\n";
+    }
 
-        std::string status = symObj["status"].get<std::string>();
-        if (status != "TRADING") continue;
+    std::unique_lock<std::shared_mutex> topoLock(topoMutex_);
+    loadTopology(symbols);
 
-        std::string sSymbol    = symObj["symbol"].get<std::string>();
-        std::string sBaseAsset = symObj["baseAsset"].get<std::string>();
-        std::string sQuoteAsset= symObj["quoteAsset"].get<std::string>();
+    // every listed symbol gets a rate slot (the cycle detector may route through it)
+    rates_.reset();
+    routeEdges_.clear();
+    routeSymbols_.clear();
+    for (const auto& s : symbols) rates_.addSymbol(s.symbol);
+    syncRouteEdges();
 
-        // forward direction
-        std::string fwdName = sSymbol + "_FWD";
-        adjacency[sBaseAsset].push_back({ sQuoteAsset, fwdName });
-        ++count;
+    std::cout << "[DYNAMIC] Created " << topo_.aliveCount()
+              << " triangle(s) via BFS.\n";
 
-        if(USE_INVERSE_EDGES){
-            // reverse direction
-            std::string revName = sSymbol + "_INV";
-            adjacency[sQuoteAsset].push_back({ sBaseAsset, revName });
-        }
+    {
+        std::lock_guard<std::mutex> lk(bestTriMutex_);
+        bestTriangles_.clear();
+        bestTriangles_.resize(topo_.size());
     }
+    resetRouteGuards(); // ids may mean other routes now
+    routeGuards_.reserve(topo_.size());
 
-    std::cout << "[DYNAMIC] Found " << count << " trading pairs.\n";
-    if(DEBUG_BFS){
-        std::cout << "[BFS-DEBUG] # of assets (adjacency.size()) = "
-                  << adjacency.size() << "\n";
-
-        // count total edges
-        int edgeTotal=0;
-        for(const auto& kv: adjacency){
-            edgeTotal += (int)kv.second.size();
-        }
-        std::cout<<"[BFS-DEBUG] total directed edges="<< edgeTotal <<"\n";
+    // subscribe to every symbol some triangle trades
+    for (const auto& kv : topo_.symbolIndex()) {
+        obm_->start(kv.first);
     }
 
-    buildTrianglesBFS(adjacency);
-
-    std::cout << "[DYNAMIC] Created " << triangles_.size()
-              << " triangle(s) via BFS.\n";
+    return true;
+}
 
-    lastProfits_.resize(triangles_.size(), -999.0);
+/**
+ * loadTopology => the cached topology if it was built from exactly this
+ * universe; a cache from an older universe is patched with update(); no
+ * (usable) cache => full BFS. Caller holds topoMutex_ exclusively.
+ */
+void TriangleScanner::loadTopology(const std::vector<TopologySymbol>& symbols)
+{
+    uint64_t want = TriangleTopology::hashSymbols(symbols, topoOptions_);
+    bool cached = !topologyCachePath_.empty()
+               && topo_.load(topologyCachePath_)
+               && topo_.options() == topoOptions_;
+
+    if (cached && topo_.hash() == want) {
+        std::cout << "[TOPO] Loaded " << topo_.aliveCount() << " triangle(s) from "
+                  << topologyCachePath_ << "\n";
+        return;
+    }
 
-    // subscribe to each path
-    for (auto& tri : triangles_) {
-        for (auto& sym : tri.path) {
-            obm_->start(sym);
-        }
+    auto t0 = std::chrono::steady_clock::now();
+    if (cached) {
+        TopologyDelta d = topo_.update(symbols);
+        std::cout << "[TOPO] Cache is from another universe: +" << d.symbolsAdded.size()
+                  << " / -" << d.symbolsRemoved.size() << " symbols => +"
+                  << d.added.size() << " / -" << d.removed.size() << " triangles";
+    } else {
+        topo_.build(symbols, topoOptions_, DEBUG_BFS);
+        const TopologyStats& st = topo_.stats();
+        std::cout << "[TOPO] Discovered " << st.triangles << " triangle(s) over "
+                  << st.assets << " assets / " << st.edges << " edges ("
+                  << (topoOptions_.keepRotations ? "all rotations" : "canonical rotation")
+                  << ", " << st.threads << " threads)";
+    }
+    double ms = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << " in " << ms << " ms\n";
+
+    if (!topologyCachePath_.empty()) {
+        topo_.save(topologyCachePath_);
     }
+}
 
-    return true;
+void TriangleScanner::setExchangeInfoCache(const std::string& path, int ttlSec)
+{
+    exchangeInfo_.reset(new ExchangeInfoCache(path, std::chrono::seconds(ttlSec)));
+}
+
+void TriangleScanner::startExchangeInfoRefresh(int intervalSec)
+{
+    if (!exchangeInfo_ || intervalSec <= 0) return;
+    exchangeInfo_->startRefresh(std::chrono::seconds(intervalSec),
+                                [this](const ExchangeUniverse& uni){ applyUniverseRefresh(uni); });
 }
 
 /**
- * BFS approach
+ * applyUniverseRefresh => runs on the refresh thread when the cached
+ * universe changed. Filters/scale are published as new registry versions
+ * (ids are stable, readers never see a half-written one);
+ * listing changes patch the topology: triangles of delisted symbols are
+ * tombstoned, new symbols only search cycles through their own edges and
+ * get subscribed.
  */
-void TriangleScanner::buildTrianglesBFS(const std::unordered_map<std::string, 
-                                    std::vector<std::pair<std::string,std::string>>>& adjacency)
+void TriangleScanner::applyUniverseRefresh(const ExchangeUniverse& uni)
 {
-    triangles_.clear();
-    symbolToTriangles_.clear();
-
-    int cycleCount=0;
-
-    for (auto& kv : adjacency) {
-        const std::string& A = kv.first;
-        const auto& neighborsA = kv.second;
-
-        for (auto& pairAB : neighborsA) {
-            std::string B = pairAB.first;
-            std::string symAB = pairAB.second;
-
-            auto itB = adjacency.find(B);
-            if (itB == adjacency.end()) continue;
-
-            for (auto& pairBC : itB->second) {
-                std::string C = pairBC.first;
-                std::string symBC = pairBC.second;
-
-                auto itC = adjacency.find(C);
-                if (itC == adjacency.end()) continue;
-
-                for (auto& pairCA : itC->second) {
-                    if (pairCA.first == A) {
-                        std::string symCA = pairCA.second;
-                        ++cycleCount;
-
-                        if(DEBUG_BFS){
-                            std::cout<<"[BFS-DEBUG] cycle#"<< cycleCount <<" => "
-                                     << A <<"->"<< B <<"->"<< C <<"->"<< A
-                                     << "  symbols: "
-                                     << symAB <<", "<< symBC <<", "<< symCA <<"\n";
-                        }
-
-                        Triangle tri;
-                        tri.base = A; 
-                        tri.path.push_back(symAB);
-                        tri.path.push_back(symBC);
-                        tri.path.push_back(symCA);
-
-                        int idx = (int)triangles_.size();
-                        triangles_.push_back(tri);
-
-                        symbolToTriangles_[symAB].push_back(idx);
-                        symbolToTriangles_[symBC].push_back(idx);
-                        symbolToTriangles_[symCA].push_back(idx);
-                    }
-                }
+    std::vector<TopologySymbol> symbols;
+    symbols.reserve(uni.symbols.size());
+    for (const auto& us : uni.symbols) {
+        SymbolRegistry::instance().registerSymbol(us.symbol, us.baseAsset, us.quoteAsset,
+                                                  us.info, us.filters);
+        symbols.push_back({ us.symbol, us.baseAsset, us.quoteAsset });
+    }
+
+    if (cycleDetector_) {
+        cycleDetector_->build(symbols, topoOptions_);
+    }
+
+    TopologyDelta d;
+    std::vector<std::string> newStreams;
+    {
+        std::unique_lock<std::shared_mutex> topoLock(topoMutex_);
+        auto t0 = std::chrono::steady_clock::now();
+        d = topo_.update(symbols);
+        double ms = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - t0).count();
+        for (const auto& sym : d.symbolsAdded) rates_.addSymbol(sym);
+        syncRouteEdges();
+
+        {
+            std::lock_guard<std::mutex> lk(bestTriMutex_);
+            bestTriangles_.resize(topo_.size());
+            for (int id : d.removed) bestTriangles_.remove(id);
+        }
+        routeGuards_.reserve(topo_.size());
+
+        // legs of new triangles (may include old symbols nothing traded before)
+        for (int id : d.added) {
+            for (const auto& leg : topo_.triangle(id).path) {
+                std::string rawSym;
+                splitLegSymbol(leg, rawSym);
+                newStreams.push_back(rawSym);
             }
         }
+        if (!d.symbolsAdded.empty() || !d.symbolsRemoved.empty()) {
+            if (!topologyCachePath_.empty()) topo_.save(topologyCachePath_);
+            std::cout << "[TOPO] Incremental update: +" << d.added.size()
+                      << " / -" << d.removed.size() << " triangles in " << ms
+                      << " ms (" << topo_.aliveCount() << " live)\n";
+        }
     }
 
-    if(DEBUG_BFS){
-        std::cout<<"[BFS-DEBUG] total cycles found="<< cycleCount <<"\n";
+    if (obm_ && !newStreams.empty()) {
+        for (const auto& sym : newStreams) obm_->start(sym);
+        obm_->startCombinedWebSocket();
     }
-}
 
-static const int TOP_TRIANGLE_LIMIT = 50;
+    std::cout << "[DYNAMIC] exchangeInfo refresh: filters updated for "
+              << uni.symbols.size() << " symbols, +" << d.symbolsAdded.size()
+              << " / -" << d.symbolsRemoved.size() << " listings.\n";
+}
 
 void TriangleScanner::scanTrianglesForSymbol(const std::string& symbol) {
     auto t0 = std::chrono::steady_clock::now();
     if (!obm_) return;
 
-    auto it = symbolToTriangles_.find(symbol);
-    if (it == symbolToTriangles_.end()) {
-        return;
+    double bid = 0.0, ask = 0.0;
+    if (!obm_->getTopOfBook(symbol, bid, ask)) {
+        bid = ask = 0.0; // one-sided/empty => both directions unpriced
     }
-    const auto& allTris = it->second;
+    UsdtValuation::instance().onTopOfBook(SymbolRegistry::instance().find(symbol), bid, ask);
 
-    int limit = std::min<int>((int)allTris.size(), TOP_TRIANGLE_LIMIT);
+    std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
 
-    std::vector<std::future<double>> futs;
-    futs.reserve(limit);
-    for (int i=0; i<limit; i++){
-        int triIdx = allTris[i];
-
-        // NEW: skip blacklisted triangles altogether
-        if(isBlacklisted(triangles_[triIdx])) {  
-            // just set a dummy profit so it won't trigger
-            futs.push_back(pool_.submit([](){ return -999.0; }));
-            continue;
-        }
-
-        futs.push_back(pool_.submit([this, triIdx](){
-            return calculateProfit(triangles_[triIdx]);
-        }));
+    // one update per book message, shared by every route on this symbol;
+    // depth messages that leave the top of book alone change no route
+    double fwdLog = EdgeRateTable::UNPRICED, invLog = EdgeRateTable::UNPRICED;
+    int slot = rates_.slotOf(symbol);
+    if (slot >= 0) {
+        if (!rates_.update(slot, bid, ask)) return;
+        fwdLog = rates_.logRate(slot * 2);
+        invLog = rates_.logRate(slot * 2 + 1);
     }
 
-    std::vector<double> profits(limit);
-    int futIndex = 0;
-    for(int i=0; i<limit; i++){
-        profits[i] = futs[futIndex++].get();
+    const std::vector<int>* ids = topo_.trianglesForSymbol(symbol);
+    if (!ids) {
+        topoLock.unlock();
+        if (cycleDetector_) scanLongCyclesForSymbol(symbol, fwdLog, invLog);
+        return;
     }
+    const auto& allTris = *ids;
+    const int triCount = (int)allTris.size();
 
+    // propagate to every dependent route: each is a sum over cached edge
+    // rates (this symbol's just changed), so cost is O(affected routes)
+    static thread_local std::vector<int> scanIds;
+    static thread_local std::vector<double> profits;
+    scanIds.clear();
+    profits.clear();
     double bestProfit= -999.0;
-    int bestLocalIdx= -1;
-    for(int i=0; i<limit; i++){
-        double pf = profits[i];
+    int bestId= -1;
+    const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(t0.time_since_epoch()).count();
+    for (int i=0; i<triCount; i++){
+        int triIdx = allTris[i];
+        // parked (backing off after failures) => not scanned until its timer fires
+        if(routeGuards_.isParked(triIdx)) continue;
+
+        double pf = routeProfitPct(triIdx);
+        scanIds.push_back(triIdx);
+        profits.push_back(pf);
         if(pf> bestProfit){
+            // a would-be trigger needs every leg's book fresh (the others
+            // can't trigger, so their legs aren't looked at)
+            if(pf> minProfitThreshold_ && !routeIsFresh(triIdx, nowNs)){
+                staleSkips_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
             bestProfit= pf;
-            bestLocalIdx= i;
+            bestId= triIdx;
         }
     }
 
-    for(int i=0; i<limit; i++){
-        int triIdx = allTris[i];
-        updateTrianglePriority(triIdx, profits[i]);
+    updateTrianglePriorities(scanIds.data(), profits.data(), (int)scanIds.size());
+
+    // trade on a copy; a listing refresh may change the topology meanwhile
+    Triangle tri;
+    if(bestId>=0){
+        tri = topo_.triangle(bestId);
     }
+    topoLock.unlock();
 
-    if(bestProfit> minProfitThreshold_ && bestLocalIdx>=0){
-        int bestTriIdx = allTris[bestLocalIdx];
-        const auto& tri = triangles_[ bestTriIdx ];
+    if(bestProfit> minProfitThreshold_ && bestId>=0){
+        uint64_t opp = OpportunityTracker::instance().begin(
+            bestId, SymbolRegistry::instance().find(symbol));
         std::cout << "[BEST ROUTE for " << symbol << "] "
-                  << tri.path[0] << "->"
-                  << tri.path[1] << "->"
-                  << tri.path[2] << " => "
-                  << bestProfit << "%\n";
-
-        if(simulator_){
-            // build local OB
-            auto ob1= obm_->getOrderBook(tri.path[0]);
-            auto ob2= obm_->getOrderBook(tri.path[1]);
-            auto ob3= obm_->getOrderBook(tri.path[2]);
-
-            double estProfitUSDT= simulator_->estimateTriangleProfitUSDT(tri, ob1, ob2, ob3);
-            if(estProfitUSDT<0.0){
-                std::cout<<"[SCAN] Full-triangle => negative => skip\n";
-            } else if(estProfitUSDT<2.0){
-                std::cout<<"[SCAN] => "<< estProfitUSDT <<" < 2 USDT => skip\n";
-            } else {
-                // COOLDOWN CHECK
-                std::string triKey = makeTriangleKey(tri);
-
-                {
-                    std::lock_guard<std::mutex> cdLock(cooldownMutex_);
-                    auto now = std::chrono::steady_clock::now();
-                    auto itCd = lastAttemptMap_.find(triKey);
-                    if(itCd != lastAttemptMap_.end()){
-                        double elapsed = std::chrono::duration<double>(now - itCd->second).count();
-                        if(elapsed < triangleCooldownSeconds_){
-                            std::cout << "[COOLDOWN] Skipping triKey=" << triKey
-                                      << " => only " << elapsed << "s elapsed < "
-                                      << triangleCooldownSeconds_ << "s\n";
-                            // skip trading
-                            auto t1 = std::chrono::steady_clock::now();
-                            double ms = std::chrono::duration<double,std::milli>(t1 - t0).count();
-                            std::cout<<"[SCANNER LATENCY] symbol="<< symbol
-                                     <<" took "<< ms <<" ms\n";
-                            logScanResult(symbol, (int)allTris.size(), bestProfit, ms);
-                            return;
-                        }
-                    }
-                    // not on cooldown => we proceed
-                    lastAttemptMap_[triKey] = now;
-                }
-
-                // Now we actually do the trade
-                std::cout<<"[SIMULATE] => +"<< estProfitUSDT <<" USDT => do real trade.\n";
-
-                // NEW: capture fail reason
-                std::string failReason;
-                bool success = simulator_->simulateTradeDepthWithWallet(tri, ob1, ob2, ob3, &failReason);
-                if(!success){
-                    // record the failure in blacklisting
-                    recordFailure(tri, failReason.empty()? "unknown_fail" : failReason); // NEW
-                }
-                simulator_->printWallet();
-            }
-        }
+                  << makeTriangleKey(tri) << " => "
+                  << bestProfit << "% (opp #" << opp << ")\n";
+        tryExecuteRoute(bestId, tri);
+    }
+
+    // 4/5-leg routes through this symbol the triangle index doesn't cover
+    if(cycleDetector_){
+        scanLongCyclesForSymbol(symbol, fwdLog, invLog);
     }
 
     auto t1= std::chrono::steady_clock::now();
@@ -356,62 +363,198 @@ void TriangleScanner::scanTrianglesForSymbol(const std::string& symbol) {
     std::cout<<"[SCANNER LATENCY] symbol="<< symbol
              <<" took "<< ms <<" ms\n";
 
-    logScanResult(symbol, (int)allTris.size(), bestProfit, ms);
+    logScanResult(symbol, triCount, bestProfit, ms);
+}
+
+/**
+ * tryExecuteRoute => depth estimate, cooldown, then the (simulated or live)
+ * trade. Works for any number of legs. Closes the caller's open opportunity
+ * (OpportunityTracker) with how far it got.
+ */
+void TriangleScanner::tryExecuteRoute(int routeId, const Triangle& tri)
+{
+    auto& tracker = OpportunityTracker::instance();
+    if(!simulator_ || !obm_){
+        tracker.finish(OppOutcome::BAD_ROUTE);
+        return;
+    }
+
+    // get the legs built/signed while we still estimate
+    simulator_->prestageTriangle(tri);
+
+    // every leg's book as of one instant (books are keyed by the raw symbol):
+    // separate reads could price the route on mixed-time books
+    std::vector<std::string> rawSyms;
+    rawSyms.reserve(tri.path.size());
+    for(const auto& leg : tri.path){
+        std::string rawSym;
+        splitLegSymbol(leg, rawSym);
+        rawSyms.push_back(rawSym);
+    }
+    std::vector<OrderBookData> books;
+    if(!obm_->getOrderBooks(rawSyms, books)){
+        std::cout<<"[SCAN] Full-route => books kept moving, no consistent view => skip\n";
+        tracker.finish(OppOutcome::TORN_BOOKS);
+        return;
+    }
+
+    double estProfitUSDT= simulator_->estimateCycleProfitUSDT(tri, books);
+    if(estProfitUSDT<0.0){
+        std::cout<<"[SCAN] Full-route => negative => skip\n";
+        tracker.finish(OppOutcome::UNPROFITABLE);
+        return;
+    }
+    if(estProfitUSDT<2.0){
+        std::cout<<"[SCAN] => "<< estProfitUSDT <<" < 2 USDT => skip\n";
+        tracker.finish(OppOutcome::BELOW_MIN);
+        return;
+    }
+    tracker.stamp(OppStage::ESTIMATE);
+
+    // COOLDOWN CHECK (claims the attempt slot when it passes; a timer releases it)
+    int guardIdx = -1;
+    RouteGuardTable& guards = guardsFor(routeId, guardIdx);
+    if(!guards.tryBeginAttempt(guardIdx)){
+        std::cout << "[COOLDOWN] Skipping route #" << routeId
+                  << " => already tried within the last "
+                  << triangleCooldownSeconds_ << "s\n";
+        tracker.finish(OppOutcome::COOLDOWN);
+        return;
+    }
+    if(routeId >= 0){
+        uint64_t gen = guardGeneration_.load(std::memory_order_acquire);
+        TimerService::instance().scheduleAfter((int64_t)(triangleCooldownSeconds_ * 1e9),
+            [this, &guards, guardIdx, gen](){
+                if(gen == guardGeneration_.load(std::memory_order_acquire)) guards.endCooldown(guardIdx);
+            });
+    }
+    tracker.stamp(OppStage::COOLDOWN);
+
+    // Now we actually do the trade
+    std::cout<<"[SIMULATE] => +"<< estProfitUSDT <<" USDT => do real trade.\n";
+
+    // NEW: capture fail reason
+    std::string failReason;
+    bool success = simulator_->simulateCycleDepthWithWallet(tri, books, &failReason);
+    if(!success){
+        // record the failure => backoff
+        recordFailure(routeId, tri, failReason.empty()? "unknown_fail" : failReason);
+    } else {
+        guards.recordSuccess(guardIdx, RouteGuardTable::nowNs(), backoff_);
+    }
+    tracker.finish(success ? OppOutcome::TRADED : oppOutcomeFromFailReason(failReason));
+    simulator_->printWallet();
+}
+
+void TriangleScanner::enableCycleDetection(int minLegs, int maxLegs, int maxCycles)
+{
+    cycleDetector_.reset(new CycleDetector(minLegs, maxLegs));
+    cycles_.reset(new CycleTable(maxCycles));
 }
 
 /**
- * The big change here is interpret "XXX_INV" as reversed
+ * scanLongCyclesForSymbol => feed the new top of book to the cycle detector.
+ * The detector re-finds routes on every update, so nothing is kept for the
+ * ones that can't trigger; the best one, if above threshold, takes a slot in
+ * cycles_ (an id with its own cooldown/backoff, outside the topology) and
+ * goes through the same execution path as the best triangle.
+ */
+void TriangleScanner::scanLongCyclesForSymbol(const std::string& symbol,
+                                              double fwdLogRate, double invLogRate)
+{
+    std::vector<DetectedCycle> found =
+        cycleDetector_->onBookUpdate(symbol, fwdLogRate, invLogRate);
+    if(found.empty()) return;
+
+    const DetectedCycle& best = found.front();
+    if(best.profitPct <= minProfitThreshold_) return;
+
+    std::vector<SymbolId> syms;
+    syms.reserve(best.route.path.size());
+    for(const auto& leg : best.route.path){
+        std::string rawSym;
+        splitLegSymbol(leg, rawSym);
+        syms.push_back(SymbolRegistry::instance().find(rawSym));
+    }
+    if(!symbolsFresh(syms, TimerService::nowNs())){
+        staleSkips_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    int id = cycles_->acquire(makeTriangleKey(best.route), best.route);
+    if(id < 0 || cycles_->guards().isParked(CycleTable::slotOf(id))) return;
+
+    uint64_t opp = OpportunityTracker::instance().begin(
+        id, SymbolRegistry::instance().find(symbol));
+    std::cout << "[BEST CYCLE for " << symbol << "] "
+              << makeTriangleKey(best.route) << " (" << best.route.path.size()
+              << " legs) => " << best.profitPct << "% (opp #" << opp << ")\n";
+    tryExecuteRoute(id, best.route);
+}
+
+/**
+ * calculateProfit => product of the legs' top-of-book rates after each
+ * symbol's fee, as a sum of the cached log rates ("XXX_INV" = buy base at
+ * the ask, "XXX_FWD"/untagged = sell base at the bid).
  */
 double TriangleScanner::calculateProfit(const Triangle& tri) {
-    if(!obm_) return -999;
     if(tri.path.size()<3) return -999;
 
-    double amount = 1.0;
-    double fee = 0.001;
-
-    for(int leg=0; leg<3; leg++){
-        const std::string& sym = tri.path[leg];
-        bool isReversed = false;
-        std::string rawSym = sym;
-        if(sym.size()>=4) {
-            if(sym.compare(sym.size()-4, 4, "_INV")==0){
-                isReversed = true;
-                rawSym = sym.substr(0, sym.size()-4);
-            }
-            else if(sym.compare(sym.size()-4,4,"_FWD")==0){
-                rawSym = sym.substr(0, sym.size()-4);
-            }
-        }
+    std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
+    double logSum = 0.0;
+    for(const auto& leg : tri.path){
+        int edge = rates_.edgeFor(leg);
+        if(edge < 0) return -999;
+        logSum += rates_.logRate(edge);
+    }
+    if(!EdgeRateTable::priced(logSum)) return -999;
+    return (std::exp(logSum) - 1.0)*100.0;
+}
 
-        auto ob = obm_->getOrderBook(rawSym);
-        if(ob.bids.empty()|| ob.asks.empty()){
-            return -999; 
-        }
-        double bestBid= ob.bids[0].price;
-        double bestAsk= ob.asks[0].price;
-        if(bestBid<=0.0|| bestAsk<=0.0) return -999;
-
-        if(!isReversed){
-            // normal => "sell base" for "quote" at bestBid
-            double out = amount * bestBid;
-            out = out*(1.0 - fee); 
-            amount = out; 
-        } else {
-            // reversed => "spend quote" to "buy base" at bestAsk
-            double baseGained = (amount/bestAsk)*(1.0 - fee);
-            amount = baseGained;
-        }
+double TriangleScanner::routeProfitPct(int triIdx) const {
+    const std::vector<int>& edges = routeEdges_[triIdx];
+    double logSum = rates_.routeLogRate(edges.data(), edges.size());
+    if(!EdgeRateTable::priced(logSum)) return -999;
+    return (std::exp(logSum) - 1.0)*100.0;
+}
+
+bool TriangleScanner::routeIsFresh(int triIdx, int64_t nowNs) const {
+    return symbolsFresh(routeSymbols_[triIdx], nowNs);
+}
+
+bool TriangleScanner::symbolsFresh(const std::vector<SymbolId>& syms, int64_t nowNs) const {
+    if(maxBookAgeNs_ <= 0 || !obm_) return true;
+    for(SymbolId sym : syms){
+        int64_t t = obm_->lastUpdateNs(sym);
+        if(t == 0 || nowNs - t > maxBookAgeNs_) return false;
     }
+    return true;
+}
 
-    double profitPct = (amount - 1.0)*100.0;
-    return profitPct;
+void TriangleScanner::syncRouteEdges() {
+    for(int id = (int)routeEdges_.size(); id < topo_.size(); id++){
+        std::vector<int> edges;
+        std::vector<SymbolId> syms;
+        for(const auto& leg : topo_.triangle(id).path){
+            std::string rawSym;
+            splitLegSymbol(leg, rawSym);
+            rates_.addSymbol(rawSym);
+            edges.push_back(rates_.edgeFor(leg));
+            syms.push_back(SymbolRegistry::instance().intern(rawSym));
+        }
+        routeEdges_.push_back(std::move(edges));
+        routeSymbols_.push_back(std::move(syms));
+    }
 }
 
 void TriangleScanner::scanAllSymbolsConcurrently() {
     std::vector<std::string> allSymbols;
-    allSymbols.reserve(symbolToTriangles_.size());
-    for(auto& kv: symbolToTriangles_){
-        allSymbols.push_back(kv.first);
+    {
+        std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
+        allSymbols.reserve(topo_.symbolIndex().size());
+        for(auto& kv: topo_.symbolIndex()){
+            allSymbols.push_back(kv.first);
+        }
     }
 
     std::vector<std::future<void>> futs;
@@ -451,78 +594,128 @@ void TriangleScanner::logScanResult(const std::string& symbol,
 }
 
 void TriangleScanner::updateTrianglePriority(int triIdx, double profit) {
+    updateTrianglePriorities(&triIdx, &profit, 1);
+}
+
+// one lock for all routes touched by an update; each route is re-keyed in place.
+// Parked routes stay out (checked under the lock parkRoute removes them with).
+void TriangleScanner::updateTrianglePriorities(const int* triIdx, const double* profit, int count) {
     std::lock_guard<std::mutex> lk(bestTriMutex_);
-    if(triIdx<0 || triIdx>=(int)triangles_.size()) return;
-    lastProfits_[triIdx] = profit;
-    TriPriority item;
-    item.profit = profit;
-    item.triIdx = triIdx;
-    bestTriangles_.push(item);
+    for(int i=0; i<count; i++){
+        if(routeGuards_.isParked(triIdx[i])) continue;
+        bestTriangles_.update(triIdx[i], profit[i]);
+    }
 }
 
 bool TriangleScanner::getBestTriangle(double& outProfit, Triangle& outTri) {
-    std::lock_guard<std::mutex> lk(bestTriMutex_);
-    while(!bestTriangles_.empty()){
-        TriPriority top = bestTriangles_.top();
-        double stored = lastProfits_[top.triIdx];
-        if(std::fabs(stored - top.profit)<1e-12){
-            outProfit = stored;
-            outTri    = triangles_[ top.triIdx ];
-            return true;
-        } else {
-            bestTriangles_.pop();
+    int id = -1;
+    if(!bestTriangles_.peekTop(id, outProfit)) return false;
+    std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
+    // removed ids leave the heap under this lock, so a miss is a race with a refresh
+    if(!topo_.isAlive(id)) return false;
+    outTri = topo_.triangle(id);
+    return true;
+}
+
+void TriangleScanner::prestageTopTriangles(int topK)
+{
+    if(!simulator_ || topK<=0) return;
+
+    std::vector<int> top;
+    std::vector<Triangle> tris;
+    {
+        std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
+        std::lock_guard<std::mutex> lk(bestTriMutex_);
+        bestTriangles_.topK(topK, top);
+        for(int id : top){
+            if(topo_.isAlive(id)) tris.push_back(topo_.triangle(id));
         }
     }
-    return false;
+
+    for(const auto& tri : tris){
+        simulator_->prestageTriangle(tri);
+    }
+}
+
+void TriangleScanner::simulateTopTriangles(int topK, std::vector<SimCandidate>& out)
+{
+    out.clear();
+    if(!simulator_ || !obm_ || topK<=0) return;
+
+    // copy the routes out, so a listing refresh isn't held up by the batch
+    std::vector<int> top;
+    std::vector<int> topoIds;
+    std::vector<Triangle> tris;
+    {
+        std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
+        std::lock_guard<std::mutex> lk(bestTriMutex_);
+        bestTriangles_.topK(topK, top);
+        for(int id : top){
+            if(!topo_.isAlive(id)) continue;
+            topoIds.push_back(id);
+            tris.push_back(topo_.triangle(id));
+        }
+    }
+    if(tris.empty()) return;
+
+    auto& reg = SymbolRegistry::instance();
+    std::vector<SymbolId> symbols;
+    for(const auto& tri : tris){
+        for(const auto& leg : tri.path){
+            std::string raw;
+            splitLegSymbol(leg, raw);
+            SymbolId id = reg.find(raw);
+            if(id != INVALID_SYMBOL) symbols.push_back(id);
+        }
+    }
+    std::sort(symbols.begin(), symbols.end());
+    symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+    BookSnapshot books;
+    if(!obm_->snapshotBooks(symbols, books)){
+        std::cout<<"[BATCH] no consistent snapshot of "<< symbols.size() <<" books => skip\n";
+        return;
+    }
+
+    std::vector<int> ids(tris.size());
+    for(size_t i=0; i< ids.size(); i++) ids[i] = (int)i;
+    out.resize(tris.size());
+    simulator_->simulateBatch(tris, ids.data(), ids.size(), books, pool_, out.data());
+    for(auto& c : out) c.triIndex = topoIds[c.triIndex];
 }
 
 /** 
- * Re-check all discovered triangles in parallel, store results in bestTriangles_, 
+ * Re-score all discovered triangles from the edge rates, re-key them in bestTriangles_, 
  * optionally also return a sorted list of triangles above minProfitPct.
  */
 void TriangleScanner::rescoreAllTrianglesConcurrently(
     double minProfitPct,
     std::vector<ScoredTriangle>* outSorted)
 {
-    if(triangles_.empty()) return;
-
-    std::vector<std::future<double>> futs;
-    futs.reserve(triangles_.size());
+    std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
+    const size_t n = (size_t)topo_.size();
+    if(n == 0) return;
 
-    for(size_t i=0; i< triangles_.size(); i++){
-        futs.push_back(pool_.submit([this, i](){
-            return calculateProfit(triangles_[i]);
-        }));
-    }
-
-    std::vector<double> profits(triangles_.size());
-
-    // gather
-    for(size_t i=0; i< futs.size(); i++){
-        profits[i] = futs[i].get();
+    // every route is a sum over already-maintained edge rates
+    std::vector<double> profits(n);
+    for(size_t i=0; i< n; i++){
+        profits[i] = topo_.isAlive((int)i) ? routeProfitPct((int)i) : -999.0;
     }
 
     {
         std::lock_guard<std::mutex> lk(bestTriMutex_);
-        while(!bestTriangles_.empty()) bestTriangles_.pop();
         for(size_t i=0; i< profits.size(); i++){
-            double pf = profits[i];
-            lastProfits_[i] = pf;
-            if(pf >= minProfitPct){
-                TriPriority item;
-                item.profit = pf;
-                item.triIdx = (int)i;
-                bestTriangles_.push(item);
-            }
+            if(topo_.isAlive((int)i) && !routeGuards_.isParked((int)i)) bestTriangles_.update((int)i, profits[i]);
+            else bestTriangles_.remove((int)i);
         }
     }
 
     if(outSorted){
         outSorted->clear();
-        outSorted->reserve(triangles_.size());
+        outSorted->reserve(n);
         for(size_t i=0; i< profits.size(); i++){
             double pf = profits[i];
-            if(pf >= minProfitPct){
+            if(pf >= minProfitPct && topo_.isAlive((int)i)){
                 ScoredTriangle sc;
                 sc.triIdx  = (int)i;
                 sc.profit  = pf;
@@ -534,13 +727,13 @@ void TriangleScanner::rescoreAllTrianglesConcurrently(
                   [](auto&a,auto&b){return a.profit> b.profit;});
     }
 
-    std::cout << "[RESCORE] updated all " << triangles_.size()
-              << " triangles. top queue size=" << bestTriangles_.size()
+    std::cout << "[RESCORE] updated all " << topo_.aliveCount()
+              << " triangles. heap size=" << bestTriangles_.size()
               << ", minProfit=" << minProfitPct << "\n";
 }
 
 /**
- * Export top triangles from bestTriangles_
+ * Export top triangles from bestTriangles_ (topN largest, then minProfit cut)
  */
 void TriangleScanner::exportTopTrianglesCSV(const std::string& filename,
                                             int topN,
@@ -549,23 +742,18 @@ void TriangleScanner::exportTopTrianglesCSV(const std::string& filename,
     std::vector<ScoredTriangle> results;
     {
         std::lock_guard<std::mutex> lk(bestTriMutex_);
-        std::priority_queue<TriPriority> tmp = bestTriangles_;
-        while(!tmp.empty()){
-            TriPriority top = tmp.top();
-            tmp.pop();
-            if(top.profit< minProfitPct) break;
+        std::vector<int> top;
+        bestTriangles_.topK(topN, top);
+        for(int id : top){
+            double pf = bestTriangles_.key(id);
+            if(pf < minProfitPct) break;
             ScoredTriangle sc;
-            sc.triIdx  = top.triIdx;
-            sc.profit  = top.profit;
+            sc.triIdx  = id;
+            sc.profit  = pf;
             sc.netUSDT = 0.0;
             results.push_back(sc);
         }
     }
-    std::sort(results.begin(), results.end(),
-              [](auto&a, auto&b){return a.profit> b.profit;});
-    if((int)results.size()> topN){
-        results.resize(topN);
-    }
 
     std::ofstream fs(filename, std::ios::app);
     if(!fs.is_open()){
@@ -582,10 +770,11 @@ void TriangleScanner::exportTopTrianglesCSV(const std::string& filename,
     std::string nowStr = std::string(std::ctime(&now_c));
     if(!nowStr.empty() && nowStr.back()=='\n') nowStr.pop_back();
 
+    std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
     int rank=1;
     for(auto& sc: results){
-        if(sc.triIdx<0 || sc.triIdx>=(int)triangles_.size()) continue;
-        auto& tri = triangles_[ sc.triIdx ];
+        if(!topo_.isAlive(sc.triIdx)) continue;
+        auto& tri = topo_.triangle(sc.triIdx);
         std::stringstream pathStr;
         for(size_t i=0; i< tri.path.size(); i++){
             if(i>0) pathStr<<"->";
@@ -613,39 +802,88 @@ std::string TriangleScanner::makeTriangleKey(const Triangle& tri) const {
 }
 
 // --------------------------------------------------------------------------
-// NEW: record a failure => push a timestamp, prune old fails, log reason
+// NEW: record a failure => raise the route's backoff, log reason
 // --------------------------------------------------------------------------
-void TriangleScanner::recordFailure(const Triangle& tri, const std::string& reason)
+void TriangleScanner::recordFailure(int routeId, const Triangle& tri, const std::string& reason)
 {
     // log to fail_log.csv
     logFailure(tri, reason);
 
-    // store time
-    auto now = std::chrono::steady_clock::now();
-    std::string key = makeTriangleKey(tri);
+    int guardIdx = -1;
+    RouteGuardTable& guards = guardsFor(routeId, guardIdx);
+    int64_t backoffNs = guards.recordFailure(guardIdx, RouteGuardTable::nowNs(), backoff_);
+    if(backoffNs > 0){
+        std::cout << "[BACKOFF] route #" << routeId << " " << makeTriangleKey(tri)
+                  << " => level " << guards.level(guardIdx) << ", parked for "
+                  << backoffNs / 1e9 << "s\n";
+        parkRoute(routeId, backoffNs);
+    }
+}
+
+void TriangleScanner::setFailureBackoff(int freeFails, double baseSec, double maxSec, double decaySec)
+{
+    backoff_.freeFails = std::max(0, freeFails);
+    backoff_.baseNs    = (int64_t)(std::max(0.0, baseSec) * 1e9);
+    backoff_.maxNs     = std::max(backoff_.baseNs, (int64_t)(maxSec * 1e9));
+    backoff_.decayNs   = (int64_t)(std::max(0.0, decaySec) * 1e9);
+}
 
-    std::lock_guard<std::mutex> g(failMutex_);
-    auto& times = failTimestamps_[key];
-    times.push_back(now);
+void TriangleScanner::parkRoute(int routeId, int64_t backoffNs)
+{
+    // already parked => its timer re-checks blockedUntil and waits out the extension
+    int guardIdx = -1;
+    if(!guardsFor(routeId, guardIdx).park(guardIdx)) return;
+    parkedCount_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lk(bestTriMutex_);
+        bestTriangles_.remove(routeId);
+    }
+    uint64_t gen = guardGeneration_.load(std::memory_order_acquire);
+    TimerService::instance().scheduleAfter(backoffNs, [this, routeId, gen](){ reinstateRoute(routeId, gen); });
+}
 
-    // prune old
-    times.erase(std::remove_if(times.begin(), times.end(),
-                               [&](auto& tstamp){
-                                   double sec = std::chrono::duration<double>(now - tstamp).count();
-                                   return (sec > failWindowSec_);
-                               }),
-                times.end());
+void TriangleScanner::reinstateRoute(int routeId, uint64_t generation)
+{
+    if(generation != guardGeneration_.load(std::memory_order_acquire)) return;
+
+    // a failure while it was parked (a trade in flight) pushed the end out
+    int64_t now = RouteGuardTable::nowNs();
+    int guardIdx = -1;
+    RouteGuardTable& guards = guardsFor(routeId, guardIdx);
+    int64_t until = guards.blockedUntil(guardIdx);
+    if(until > now){
+        TimerService::instance().scheduleAt(until, [this, routeId, generation](){ reinstateRoute(routeId, generation); });
+        return;
+    }
+    if(!guards.unpark(guardIdx)) return;
+    parkedCount_.fetch_sub(1, std::memory_order_relaxed);
+    if(CycleTable::isCycleId(routeId)) return; // re-detected from the next update
+
+    // back in the scan set, keyed from the current edge rates
+    std::shared_lock<std::shared_mutex> topoLock(topoMutex_);
+    if(!topo_.isAlive(routeId)) return;
+    double pf = routeProfitPct(routeId);
+    updateTrianglePriority(routeId, pf);
+    std::cout << "[BACKOFF] route #" << routeId << " back in the scan set ("
+              << pf << "%)\n";
 }
 
-bool TriangleScanner::isBlacklisted(const Triangle& tri)
+void TriangleScanner::resetRouteGuards()
 {
-    std::string key = makeTriangleKey(tri);
-    std::lock_guard<std::mutex> g(failMutex_);
-    if(!failTimestamps_.count(key)) return false;
+    guardGeneration_.fetch_add(1, std::memory_order_acq_rel);
+    routeGuards_.clear();
+    if(cycles_) cycles_->guards().clear(); // their timers are no-ops now too
+    parkedCount_.store(0, std::memory_order_relaxed);
+}
 
-    auto& times = failTimestamps_[key];
-    // times already pruned on each fail, so if we exceed maxFailsInWindow_, it's blacklisted
-    return (int)times.size() >= maxFailsInWindow_;
+RouteGuardTable& TriangleScanner::guardsFor(int routeId, int& idx)
+{
+    if(cycles_ && CycleTable::isCycleId(routeId)){
+        idx = CycleTable::slotOf(routeId);
+        return cycles_->guards();
+    }
+    idx = routeId;
+    return routeGuards_;
 }
 
 void TriangleScanner::logFailure(const Triangle& tri, const std::string& reason)
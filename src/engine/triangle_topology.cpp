@@ -0,0 +1,629 @@
+#include "engine/triangle_topology.hpp"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <array>
+#include <chrono>
+
+/*
+ * File layout (sequential, little-endian):
+ *   u32 magic | u32 version | u64 universeHash
+ *   u8 inverseEdges | u8 keepRotations
+ *   u32 n | n x str baseAsset   (whitelist)
+ *   u32 n | n x str quoteAsset  (whitelist)
+ *   u32 symCount   | symCount x (str symbol, str base, str quote)
+ *   u32 triCount   | triCount x (str base, u8 legs, legs x str)
+ *   u32 indexCount | indexCount x (str rawSymbol, u32 n, n x u32 triId)
+ *   u64 fnv1a64(everything before)
+ * str = u8 length + bytes. Tombstones are dropped on save (ids compacted).
+ */
+
+static constexpr uint32_t TOPO_MAGIC   = 0x4F504F54; // "TOPO"
+static constexpr uint32_t TOPO_VERSION = 3; // 3: detected 4/5-leg cycles no longer saved
+
+static uint64_t fnv1a64(const char* data, size_t len) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+template <typename T>
+static void put(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+static void putStr(std::string& out, const std::string& s) {
+    uint8_t n = (uint8_t)std::min<size_t>(s.size(), 255);
+    put(out, n);
+    out.append(s.data(), n);
+}
+
+template <typename T>
+static bool get(const char*& p, const char* end, T& v) {
+    if ((size_t)(end - p) < sizeof(T)) return false;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+static bool getStr(const char*& p, const char* end, std::string& s) {
+    uint8_t n = 0;
+    if (!get(p, end, n) || (size_t)(end - p) < n) return false;
+    s.assign(p, n);
+    p += n;
+    return true;
+}
+
+static std::string cycleKey(const std::string& l1, const std::string& l2, const std::string& l3) {
+    std::string k;
+    k.reserve(l1.size() + l2.size() + l3.size() + 4);
+    k += l1; k += "->"; k += l2; k += "->"; k += l3;
+    return k;
+}
+
+static std::string triangleKey(const Triangle& tri) {
+    std::string k;
+    for (size_t i = 0; i < tri.path.size(); i++) {
+        if (i > 0) k += "->";
+        k += tri.path[i];
+    }
+    return k;
+}
+
+uint64_t TriangleTopology::hashSymbols(const std::vector<TopologySymbol>& symbols,
+                                       const TopologyOptions& options)
+{
+    std::vector<const TopologySymbol*> sorted;
+    sorted.reserve(symbols.size());
+    for (const auto& s : symbols) sorted.push_back(&s);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const TopologySymbol* a, const TopologySymbol* b){ return a->symbol < b->symbol; });
+
+    std::string buf;
+    buf += (options.inverseEdges ? 'I' : 'F');
+    buf += (options.keepRotations ? 'R' : 'C');
+    for (const auto& a : options.baseAssets)  { buf += a; buf += ','; }
+    buf += '|';
+    for (const auto& a : options.quoteAssets) { buf += a; buf += ','; }
+    buf += '\n';
+    for (const auto* s : sorted) {
+        buf += s->symbol;     buf += '|';
+        buf += s->baseAsset;  buf += '|';
+        buf += s->quoteAsset; buf += '\n';
+    }
+    return fnv1a64(buf.data(), buf.size());
+}
+
+void TriangleTopology::rehash()
+{
+    std::vector<TopologySymbol> list;
+    list.reserve(symbols_.size());
+    for (const auto& kv : symbols_) list.push_back(kv.second);
+    hash_ = hashSymbols(list, options_);
+}
+
+void TriangleTopology::clear()
+{
+    triangles_.clear();
+    alive_.clear();
+    aliveCount_ = 0;
+    bySymbol_.clear();
+    byKey_.clear();
+    adjacency_.clear();
+    symbols_.clear();
+    hash_ = 0;
+}
+
+void TriangleTopology::applyOptions(const TopologyOptions& options)
+{
+    options_ = options;
+    baseRank_.clear();
+    quoteAllowed_.clear();
+    for (size_t i = 0; i < options.baseAssets.size(); i++) {
+        baseRank_.emplace(options.baseAssets[i], (int)i);
+    }
+    quoteAllowed_.insert(options.quoteAssets.begin(), options.quoteAssets.end());
+}
+
+bool TriangleTopology::usesSymbol(const TopologySymbol& s) const
+{
+    return quoteAllowed_.empty() || quoteAllowed_.count(s.quoteAsset);
+}
+
+// -1 => may not start a triangle; otherwise lower is preferred
+int TriangleTopology::baseRank(const std::string& asset) const
+{
+    if (baseRank_.empty()) return 0;
+    auto it = baseRank_.find(asset);
+    return it == baseRank_.end() ? -1 : it->second;
+}
+
+const std::vector<int>* TriangleTopology::trianglesForSymbol(const std::string& rawSymbol) const
+{
+    auto it = bySymbol_.find(rawSymbol);
+    return (it == bySymbol_.end() || it->second.empty()) ? nullptr : &it->second;
+}
+
+void TriangleTopology::addEdges(const TopologySymbol& s)
+{
+    if (!usesSymbol(s)) return;
+    // forward: sell base for quote; inverse: spend quote for base
+    adjacency_[s.baseAsset].push_back({ s.quoteAsset, s.symbol + "_FWD" });
+    if (options_.inverseEdges) {
+        adjacency_[s.quoteAsset].push_back({ s.baseAsset, s.symbol + "_INV" });
+    }
+}
+
+void TriangleTopology::removeEdges(const TopologySymbol& s)
+{
+    auto drop = [this](const std::string& from, const std::string& leg) {
+        auto it = adjacency_.find(from);
+        if (it == adjacency_.end()) return;
+        auto& edges = it->second;
+        edges.erase(std::remove_if(edges.begin(), edges.end(),
+                                   [&](const Edge& e){ return e.second == leg; }),
+                    edges.end());
+        if (edges.empty()) adjacency_.erase(it);
+    };
+    drop(s.baseAsset,  s.symbol + "_FWD");
+    drop(s.quoteAsset, s.symbol + "_INV");
+}
+
+// assets / edges / triangles from the string adjacency (after update or load)
+void TriangleTopology::refreshStats()
+{
+    std::unordered_set<std::string> assets;
+    int edges = 0;
+    for (const auto& kv : adjacency_) {
+        assets.insert(kv.first);
+        for (const auto& e : kv.second) assets.insert(e.first);
+        edges += (int)kv.second.size();
+    }
+    stats_.assets = (int)assets.size();
+    stats_.edges = edges;
+    stats_.triangles = aliveCount_;
+}
+
+int TriangleTopology::addCycle(const std::string& base, const std::string& l1,
+                               const std::string& l2, const std::string& l3)
+{
+    std::string key = cycleKey(l1, l2, l3);
+    if (byKey_.count(key)) return -1;
+
+    Triangle tri;
+    tri.base = base;
+    tri.path = { l1, l2, l3 };
+    return addTriangle(tri);
+}
+
+void TriangleTopology::addRotations(const std::string& A, const std::string& B, const std::string& C,
+                                    const std::string& ab, const std::string& bc, const std::string& ca,
+                                    std::vector<int>* added)
+{
+    const std::string* start[3] = { &A, &B, &C };
+    int rank[3] = { baseRank(A), baseRank(B), baseRank(C) };
+
+    // canonical start: lowest rank, ties (no whitelist) broken by name
+    int best = -1;
+    for (int i = 0; i < 3; i++) {
+        if (rank[i] < 0) continue;
+        if (best < 0 || rank[i] < rank[best] ||
+            (rank[i] == rank[best] && *start[i] < *start[best])) {
+            best = i;
+        }
+    }
+
+    const std::string* legs[3] = { &ab, &bc, &ca };
+    for (int i = 0; i < 3; i++) {
+        if (rank[i] < 0) continue;
+        if (!options_.keepRotations && i != best) continue;
+        int id = addCycle(*start[i], *legs[i], *legs[(i + 1) % 3], *legs[(i + 2) % 3]);
+        if (id >= 0 && added) added->push_back(id);
+    }
+}
+
+int TriangleTopology::addTriangle(const Triangle& tri)
+{
+    std::string key = triangleKey(tri);
+    if (byKey_.count(key)) return -1;
+
+    int idx = (int)triangles_.size();
+    triangles_.push_back(tri);
+    alive_.push_back(1);
+    aliveCount_++;
+    byKey_[key] = idx;
+
+    // index by raw exchange symbol (what the depth stream reports)
+    for (const auto& leg : tri.path) {
+        std::string raw;
+        splitLegSymbol(leg, raw);
+        auto& ids = bySymbol_[raw];
+        if (ids.empty() || ids.back() != idx) ids.push_back(idx);
+    }
+
+    if (debug_) {
+        std::cout << "[BFS-DEBUG] cycle#" << aliveCount_ << " => " << tri.base
+                  << "  symbols: " << key << "\n";
+    }
+    return idx;
+}
+
+int TriangleTopology::idOf(const Triangle& tri) const
+{
+    auto it = byKey_.find(triangleKey(tri));
+    return it == byKey_.end() ? -1 : it->second;
+}
+
+void TriangleTopology::removeTriangle(int idx)
+{
+    if (!isAlive(idx)) return;
+    alive_[idx] = 0;
+    aliveCount_--;
+
+    const Triangle& tri = triangles_[idx];
+    byKey_.erase(triangleKey(tri));
+    for (const auto& leg : tri.path) {
+        std::string raw;
+        splitLegSymbol(leg, raw);
+        auto it = bySymbol_.find(raw);
+        if (it == bySymbol_.end()) continue;
+        auto& ids = it->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), idx), ids.end());
+        if (ids.empty()) bySymbol_.erase(it);
+    }
+}
+
+/**
+ * discoverThroughEdge => every 3-cycle that uses from->to, emitted with the
+ * same rotation rules as build() so an update matches a full rebuild.
+ */
+void TriangleTopology::discoverThroughEdge(const std::string& from, const std::string& to,
+                                           const std::string& leg, std::vector<int>& added)
+{
+    auto itB = adjacency_.find(to);
+    if (itB == adjacency_.end()) return;
+
+    for (const auto& bc : itB->second) {
+        const std::string& C = bc.first;
+        auto itC = adjacency_.find(C);
+        if (itC == adjacency_.end()) continue;
+
+        for (const auto& ca : itC->second) {
+            if (ca.first != from) continue;
+            addRotations(from, to, C, leg, bc.second, ca.second, &added);
+        }
+    }
+}
+
+/**
+ * build => integer CSR graph (assets sorted by name), each worker takes the
+ * next starting asset and walks A->B->C->A over edge indices only. Cycles are
+ * collected per starting asset and materialized in asset order, so the
+ * result (and triangle ids) don't depend on the thread count.
+ */
+void TriangleTopology::build(const std::vector<TopologySymbol>& symbols,
+                             const TopologyOptions& options, bool debug)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    clear();
+    applyOptions(options);
+    debug_ = debug;
+
+    std::vector<const TopologySymbol*> used;
+    used.reserve(symbols.size());
+    for (const auto& s : symbols) {
+        symbols_[s.symbol] = s;
+        addEdges(s); // string adjacency kept for update()
+        if (usesSymbol(s)) used.push_back(&s);
+    }
+
+    // asset ids
+    std::vector<std::string> assets;
+    assets.reserve(used.size() * 2);
+    for (const auto* s : used) {
+        assets.push_back(s->baseAsset);
+        assets.push_back(s->quoteAsset);
+    }
+    std::sort(assets.begin(), assets.end());
+    assets.erase(std::unique(assets.begin(), assets.end()), assets.end());
+    const int n = (int)assets.size();
+    auto assetId = [&](const std::string& a) {
+        return (int)(std::lower_bound(assets.begin(), assets.end(), a) - assets.begin());
+    };
+
+    // edges (from, to, leg name), then CSR
+    std::vector<int> edgeFrom, edgeTo;
+    std::vector<std::string> legName;
+    for (const auto* s : used) {
+        int b = assetId(s->baseAsset), q = assetId(s->quoteAsset);
+        edgeFrom.push_back(b); edgeTo.push_back(q); legName.push_back(s->symbol + "_FWD");
+        if (options_.inverseEdges) {
+            edgeFrom.push_back(q); edgeTo.push_back(b); legName.push_back(s->symbol + "_INV");
+        }
+    }
+    const int m = (int)edgeFrom.size();
+    std::vector<int> offsets(n + 1, 0), csrTo(m), csrEdge(m);
+    for (int e = 0; e < m; e++) offsets[edgeFrom[e] + 1]++;
+    for (int i = 0; i < n; i++) offsets[i + 1] += offsets[i];
+    {
+        std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+        for (int e = 0; e < m; e++) {
+            int pos = fill[edgeFrom[e]]++;
+            csrTo[pos] = edgeTo[e];
+            csrEdge[pos] = e;
+        }
+    }
+
+    // start key: INT_MAX => not allowed as base; lower => preferred
+    std::vector<int> key(n);
+    for (int i = 0; i < n; i++) {
+        int r = baseRank(assets[i]);
+        key[i] = (r < 0) ? INT_MAX : (baseRank_.empty() ? i : r);
+    }
+
+    using Cycle = std::array<int, 3>; // edge indices
+    std::vector<std::vector<Cycle>> found(n);
+    std::atomic<int> next{0};
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, n));
+
+    auto worker = [&]() {
+        for (int A = next++; A < n; A = next++) {
+            if (key[A] == INT_MAX) continue;
+            auto& out = found[A];
+            for (int i = offsets[A]; i < offsets[A + 1]; i++) {
+                int B = csrTo[i];
+                if (!options_.keepRotations && key[B] < key[A]) continue;
+                for (int j = offsets[B]; j < offsets[B + 1]; j++) {
+                    int C = csrTo[j];
+                    if (C == A) continue;
+                    if (!options_.keepRotations && key[C] < key[A]) continue;
+                    for (int k = offsets[C]; k < offsets[C + 1]; k++) {
+                        if (csrTo[k] == A) out.push_back({ csrEdge[i], csrEdge[j], csrEdge[k] });
+                    }
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    size_t total = 0;
+    for (const auto& f : found) total += f.size();
+    triangles_.reserve(total);
+    alive_.reserve(total);
+    byKey_.reserve(total);
+    for (int A = 0; A < n; A++) {
+        for (const auto& c : found[A]) {
+            addCycle(assets[A], legName[c[0]], legName[c[1]], legName[c[2]]);
+        }
+    }
+
+    debug_ = false;
+    rehash();
+
+    stats_.assets = n;
+    stats_.edges = m;
+    stats_.triangles = aliveCount_;
+    stats_.threads = threads;
+    stats_.discoveryMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+/**
+ * update => diff against the symbols we were built from.
+ * Removed (or re-based) symbols tombstone their triangles; new symbols add
+ * their edges and search only the cycles running through them.
+ */
+TopologyDelta TriangleTopology::update(const std::vector<TopologySymbol>& symbols)
+{
+    TopologyDelta delta;
+
+    std::map<std::string, const TopologySymbol*> next;
+    for (const auto& s : symbols) next[s.symbol] = &s;
+
+    // removals first (a symbol whose assets changed counts as remove + add)
+    std::vector<std::string> gone;
+    for (const auto& kv : symbols_) {
+        auto it = next.find(kv.first);
+        if (it == next.end() || it->second->baseAsset != kv.second.baseAsset
+                             || it->second->quoteAsset != kv.second.quoteAsset) {
+            gone.push_back(kv.first);
+        }
+    }
+    for (const auto& sym : gone) {
+        auto it = bySymbol_.find(sym);
+        if (it != bySymbol_.end()) {
+            std::vector<int> ids = it->second;
+            for (int id : ids) {
+                removeTriangle(id);
+                delta.removed.push_back(id);
+            }
+        }
+        removeEdges(symbols_[sym]);
+        symbols_.erase(sym);
+        delta.symbolsRemoved.push_back(sym);
+    }
+
+    // additions: all edges in first, then search (new-new-new cycles too)
+    std::vector<TopologySymbol> fresh;
+    for (const auto& kv : next) {
+        if (symbols_.count(kv.first)) continue;
+        symbols_[kv.first] = *kv.second;
+        addEdges(*kv.second);
+        fresh.push_back(*kv.second);
+        delta.symbolsAdded.push_back(kv.first);
+    }
+    for (const auto& s : fresh) {
+        if (!usesSymbol(s)) continue;
+        discoverThroughEdge(s.baseAsset, s.quoteAsset, s.symbol + "_FWD", delta.added);
+        if (options_.inverseEdges) {
+            discoverThroughEdge(s.quoteAsset, s.baseAsset, s.symbol + "_INV", delta.added);
+        }
+    }
+
+    refreshStats();
+    rehash();
+    return delta;
+}
+
+bool TriangleTopology::save(const std::string& path) const
+{
+    // compact ids: alive triangles only, renumbered in order
+    std::vector<int> newId(triangles_.size(), -1);
+    uint32_t triCount = 0;
+    for (size_t i = 0; i < triangles_.size(); i++) {
+        if (alive_[i]) newId[i] = (int)triCount++;
+    }
+
+    std::string out;
+    put(out, TOPO_MAGIC);
+    put(out, TOPO_VERSION);
+    put(out, hash_);
+    put(out, (uint8_t)(options_.inverseEdges ? 1 : 0));
+    put(out, (uint8_t)(options_.keepRotations ? 1 : 0));
+    put(out, (uint32_t)options_.baseAssets.size());
+    for (const auto& a : options_.baseAssets) putStr(out, a);
+    put(out, (uint32_t)options_.quoteAssets.size());
+    for (const auto& a : options_.quoteAssets) putStr(out, a);
+
+    put(out, (uint32_t)symbols_.size());
+    for (const auto& kv : symbols_) {
+        putStr(out, kv.second.symbol);
+        putStr(out, kv.second.baseAsset);
+        putStr(out, kv.second.quoteAsset);
+    }
+
+    put(out, triCount);
+    for (size_t i = 0; i < triangles_.size(); i++) {
+        if (!alive_[i]) continue;
+        putStr(out, triangles_[i].base);
+        put(out, (uint8_t)triangles_[i].path.size());
+        for (const auto& leg : triangles_[i].path) putStr(out, leg);
+    }
+
+    put(out, (uint32_t)bySymbol_.size());
+    for (const auto& kv : bySymbol_) {
+        putStr(out, kv.first);
+        put(out, (uint32_t)kv.second.size());
+        for (int id : kv.second) put(out, (uint32_t)newId[id]);
+    }
+    put(out, fnv1a64(out.data(), out.size()));
+
+    std::string tmp = path + ".tmp";
+    std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        std::cerr << "[TOPO] Could not write " << tmp << "\n";
+        return false;
+    }
+    ofs.write(out.data(), (std::streamsize)out.size());
+    ofs.close();
+    if (!ofs || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "[TOPO] Could not save " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool TriangleTopology::load(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) return false;
+    std::string buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    if (buf.size() < 8) return false;
+
+    uint64_t sum = 0;
+    std::memcpy(&sum, buf.data() + buf.size() - 8, 8);
+    if (fnv1a64(buf.data(), buf.size() - 8) != sum) {
+        std::cerr << "[TOPO] " << path << " is corrupt, ignoring it.\n";
+        return false;
+    }
+
+    const char* p   = buf.data();
+    const char* end = buf.data() + buf.size() - 8;
+    uint32_t magic = 0, version = 0, n = 0;
+    uint64_t hash = 0;
+    uint8_t inverse = 0, rotations = 0;
+    if (!get(p, end, magic) || magic != TOPO_MAGIC ||
+        !get(p, end, version) || version != TOPO_VERSION ||
+        !get(p, end, hash) || !get(p, end, inverse) || !get(p, end, rotations)) {
+        return false;
+    }
+
+    TopologyOptions opts;
+    opts.inverseEdges = (inverse != 0);
+    opts.keepRotations = (rotations != 0);
+    bool ok = get(p, end, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        opts.baseAssets.emplace_back();
+        ok = getStr(p, end, opts.baseAssets.back());
+    }
+    ok = ok && get(p, end, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        opts.quoteAssets.emplace_back();
+        ok = getStr(p, end, opts.quoteAssets.back());
+    }
+    if (!ok) return false;
+
+    clear();
+    applyOptions(opts);
+    ok = get(p, end, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        TopologySymbol s;
+        ok = getStr(p, end, s.symbol) && getStr(p, end, s.baseAsset) && getStr(p, end, s.quoteAsset);
+        if (ok) {
+            symbols_[s.symbol] = s;
+            addEdges(s);
+        }
+    }
+
+    ok = ok && get(p, end, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        Triangle tri;
+        uint8_t legs = 0;
+        ok = getStr(p, end, tri.base) && get(p, end, legs);
+        tri.path.resize(legs);
+        for (uint8_t l = 0; ok && l < legs; l++) ok = getStr(p, end, tri.path[l]);
+        if (ok) {
+            byKey_[triangleKey(tri)] = (int)triangles_.size();
+            triangles_.push_back(std::move(tri));
+            alive_.push_back(1);
+            aliveCount_++;
+        }
+    }
+
+    // reverse index straight from disk (no re-derivation)
+    ok = ok && get(p, end, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        std::string sym;
+        uint32_t cnt = 0;
+        ok = getStr(p, end, sym) && get(p, end, cnt);
+        auto& ids = bySymbol_[sym];
+        ids.reserve(cnt);
+        for (uint32_t k = 0; ok && k < cnt; k++) {
+            uint32_t id = 0;
+            ok = get(p, end, id) && id < triangles_.size();
+            if (ok) ids.push_back((int)id);
+        }
+    }
+
+    if (!ok) {
+        std::cerr << "[TOPO] " << path << " is truncated, ignoring it.\n";
+        clear();
+        return false;
+    }
+    refreshStats();
+    hash_ = hash;
+    return true;
+}
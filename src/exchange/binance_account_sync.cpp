@@ -1,4 +1,5 @@
 #include "exchange/binance_account_sync.hpp"
+#include "exchange/rate_limiter.hpp"
 #include <chrono>
 #include <iostream>
 #include <sstream>
@@ -28,12 +29,18 @@ static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::stri
     return totalSize;
 }
 
+static size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userp) {
+    static_cast<RateLimiter*>(userp)->onResponseHeader(buffer, size * nitems);
+    return size * nitems;
+}
+
 void startWalletSyncThread(Wallet* wallet,
                            const std::string& apiKey,
                            const std::string& secretKey,
                            const std::string& baseUrl,
                            std::atomic<bool>* keepRunning,
-                           std::thread& syncThread)
+                           std::thread& syncThread,
+                           int intervalSec)
 {
     syncThread = std::thread([=]() {
         CURL* curl = curl_easy_init();
@@ -44,6 +51,8 @@ void startWalletSyncThread(Wallet* wallet,
 
         while (keepRunning->load()) {
             try {
+                RateLimiter::shared().acquire(RequestWeight::ACCOUNT);
+
                 long nowMs = (long)std::chrono::duration_cast<std::chrono::milliseconds>(
                     std::chrono::system_clock::now().time_since_epoch()
                 ).count();
@@ -64,6 +73,8 @@ void startWalletSyncThread(Wallet* wallet,
                 curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
                 curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
                 curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+                curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+                curl_easy_setopt(curl, CURLOPT_HEADERDATA, &RateLimiter::shared());
                 curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
 
                 CURLcode res = curl_easy_perform(curl);
@@ -77,11 +88,11 @@ void startWalletSyncThread(Wallet* wallet,
                             double free = std::stod(b["free"].get<std::string>());
                             double locked = std::stod(b["locked"].get<std::string>());
                             double total = free + locked;
-                            if (total > 0.0) {
-                                wallet->setBalance(asset, total);
+                            if (total > 0.0 || wallet->getTotalBalance(asset) > 0.0) {
+                                wallet->setBalances(asset, free, locked);
                             }
                         }
-                        std::cout << "[SYNC] Wallet balances updated.\n";
+                        std::cout << "[SYNC] Wallet balances reconciled.\n";
                     }
                 }
 
@@ -90,7 +101,10 @@ void startWalletSyncThread(Wallet* wallet,
                 std::cerr << "[SYNC] Exception during wallet sync\n";
             }
 
-            std::this_thread::sleep_for(std::chrono::seconds(5));
+            // sleep in 1s steps so shutdown isn't held up by a long interval
+            for (int i = 0; i < intervalSec && keepRunning->load(); ++i) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
         }
 
         curl_easy_cleanup(curl);
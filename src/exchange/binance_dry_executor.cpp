@@ -6,9 +6,6 @@
 #include <random> // for random_device, mt19937, uniform_real_distribution
 #include "core/orderbook.hpp" // so we can return OrderBookData
 
-// initialize static
-std::mutex BinanceDryExecutor::throttleMutex_{};
-
 BinanceDryExecutor::BinanceDryExecutor(double fillRatio,
                                        int baseLatencyMs,
                                        double mockPrice,
@@ -19,13 +16,8 @@ BinanceDryExecutor::BinanceDryExecutor(double fillRatio,
   , mockPrice_(mockPrice)
   , slippageBps_(slippageBps)
   , obm_(obm)
+  , limiter_(&RateLimiter::shared())
 {
-    // Initialize rate limit state
-    requestTokens_         = (double)maxRequestsPerMinute_;
-    lastRefillRequests_    = std::chrono::steady_clock::now();
-
-    currentSecStart_       = std::chrono::steady_clock::now();
-    orderCountInCurrentSec_= 0;
 }
 
 OrderResult BinanceDryExecutor::placeMarketOrder(const std::string& symbol,
@@ -33,7 +25,7 @@ OrderResult BinanceDryExecutor::placeMarketOrder(const std::string& symbol,
                                                  double quantityBase)
 {
     // Rate-limit this call as an "order"
-    throttleRequest(/*isOrder=*/true);
+    limiter_->acquire(RequestWeight::ORDER, /*isOrder=*/true);
 
     // Simulate network + engine latency
     std::this_thread::sleep_for(std::chrono::milliseconds(baseLatencyMs_));
@@ -90,7 +82,7 @@ OrderResult BinanceDryExecutor::placeMarketOrder(const std::string& symbol,
 OrderBookData BinanceDryExecutor::getOrderBookSnapshot(const std::string& symbol)
 {
     // Rate-limit as a normal request (not an "order")
-    throttleRequest(/*isOrder=*/false);
+    limiter_->acquire(RequestWeight::LOCAL_SNAPSHOT);
 
     if (!obm_) {
         std::cerr << "[DRY] No OrderBookManager provided => returning empty OB\n";
@@ -99,63 +91,21 @@ OrderBookData BinanceDryExecutor::getOrderBookSnapshot(const std::string& symbol
     return obm_->getOrderBook(symbol);
 }
 
-// existing helper
-void BinanceDryExecutor::setMockPrice(double px) {
-    mockPrice_ = px;
-}
-
-/**
- * Implement the same approach as real executor:
- * a simple token-bucket for requests + short-burst limit for orders.
- */
-void BinanceDryExecutor::throttleRequest(bool isOrder)
+// one consistent multi-book read, charged as one request
+bool BinanceDryExecutor::getOrderBookSnapshots(const std::vector<std::string>& symbols,
+                                               std::vector<OrderBookData>& out)
 {
-    std::lock_guard<std::mutex> lg(throttleMutex_);
-
-    // refill request tokens
-    refillRequestTokens();
-
-    // if it's an order, check short-burst
-    if(isOrder){
-        resetOrderCounterIfNewSecond();
-        while(orderCountInCurrentSec_ >= maxOrdersPerSec_){
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            resetOrderCounterIfNewSecond();
-        }
-        orderCountInCurrentSec_++;
-    }
+    limiter_->acquire(RequestWeight::LOCAL_SNAPSHOT);
 
-    // consume 1 request token
-    while(requestTokens_ < 1.0){
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        refillRequestTokens();
-    }
-    requestTokens_ -= 1.0;
-}
-
-void BinanceDryExecutor::refillRequestTokens()
-{
-    auto now = std::chrono::steady_clock::now();
-    double secondsElapsed = std::chrono::duration<double>(now - lastRefillRequests_).count();
-
-    double tokensPerSecond = (double)maxRequestsPerMinute_ / 60.0;
-    double tokensToAdd     = tokensPerSecond * secondsElapsed;
-
-    if(tokensToAdd >= 1.0){
-        requestTokens_ = std::min(
-            (double)maxRequestsPerMinute_,
-            requestTokens_ + tokensToAdd
-        );
-        lastRefillRequests_ = now;
+    if (!obm_) {
+        std::cerr << "[DRY] No OrderBookManager provided => returning empty OBs\n";
+        out.assign(symbols.size(), OrderBookData{});
+        return false;
     }
+    return obm_->getOrderBooks(symbols, out);
 }
 
-void BinanceDryExecutor::resetOrderCounterIfNewSecond()
-{
-    auto now = std::chrono::steady_clock::now();
-    double msElapsed = std::chrono::duration<double,std::milli>(now - currentSecStart_).count();
-    if(msElapsed >= 1000.0){
-        currentSecStart_ = now;
-        orderCountInCurrentSec_ = 0;
-    }
+// existing helper
+void BinanceDryExecutor::setMockPrice(double px) {
+    mockPrice_ = px;
 }
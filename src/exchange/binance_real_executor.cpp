@@ -1,7 +1,11 @@
 #include "exchange/binance_real_executor.hpp"
 #include <openssl/hmac.h>   // for HMAC_SHA256
 #include <openssl/evp.h>
+#include <openssl/sha.h>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <sstream>
 #include <iomanip>
@@ -9,6 +13,8 @@
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 #include "core/orderbook.hpp"
+#include "core/symbol_registry.hpp"
+#include "core/fixed_point.hpp"
 #include <iostream>
 #include <thread>
 
@@ -19,8 +25,31 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* use
     return size * nmemb;
 }
 
-// static throttle lock
-std::mutex BinanceRealExecutor::throttleMutex_{};
+// feed every response header line to the limiter (X-MBX-USED-WEIGHT-1M)
+static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, void* userp) {
+    static_cast<RateLimiter*>(userp)->onResponseHeader(buffer, size * nitems);
+    return size * nitems;
+}
+
+static std::shared_ptr<EVP_MD_CTX> makeDigestCtx() {
+    return std::shared_ptr<EVP_MD_CTX>(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+}
+
+static std::string templateKey(const std::string& symbol, OrderSide side) {
+    return symbol + (side == OrderSide::BUY ? "|B" : "|S");
+}
+
+/**
+ * Format qty with exactly `decimals` places, truncated down to a multiple of
+ * the lot step (never rounding up, so we can't ask for more than we hold).
+ * Done in integer units so the string is exact.
+ */
+static std::string formatQuantity(double qty, int decimals, int64_t stepRaw) {
+    int64_t raw = FixedPoint::floorToStep(FixedPoint::fromDoubleFloor(qty, decimals), stepRaw);
+    char buf[32];
+    size_t n = FixedPoint::format(raw, decimals, buf);
+    return std::string(buf, n);
+}
 
 // constructor
 BinanceRealExecutor::BinanceRealExecutor(const std::string& apiKey,
@@ -31,16 +60,12 @@ BinanceRealExecutor::BinanceRealExecutor(const std::string& apiKey,
   , secretKey_(secretKey)
   , baseUrl_(baseUrl)
   , obm_(obm)
+  , limiter_(&RateLimiter::shared())
 {
     // Optionally init curl globally
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
-    // Initialize times, token bucket to full
-    lastRefillRequests_ = std::chrono::steady_clock::now();
-    requestTokens_      = (double)maxRequestsPerMinute_;
-
-    currentSecStart_ = std::chrono::steady_clock::now();
-    orderCountInCurrentSec_ = 0;
+    initHmacKeyState();
 }
 
 /**
@@ -51,7 +76,7 @@ OrderResult BinanceRealExecutor::placeMarketOrder(const std::string& symbol,
                                                   double quantityBase)
 {
     // Throttle
-    throttleRequest(/*isOrder=*/true);
+    limiter_->acquire(RequestWeight::ORDER, /*isOrder=*/true);
 
     OrderResult res;
     res.success = false;
@@ -60,25 +85,43 @@ OrderResult BinanceRealExecutor::placeMarketOrder(const std::string& symbol,
     res.costOrProceeds = 0.0;
     res.message = "";
 
-    std::string sideStr = (side == OrderSide::BUY) ? "BUY" : "SELL";
-    std::ostringstream qtySs;
-    qtySs << std::fixed << std::setprecision(8) << quantityBase;
+    // Use the pre-staged template if the scanner already asked for one,
+    // otherwise build it now (and keep it for the next time).
+    auto& reg = SymbolRegistry::instance();
+    const SymbolEntry& entry = reg.entry(reg.find(symbol));
+    std::shared_ptr<const OrderTemplate> tpl = findTemplate(symbol, side);
+    if (!tpl) {
+        prestageOrder(symbol, side, entry.info.qtyDecimals);
+        tpl = findTemplate(symbol, side);
+    }
+    if (!tpl || !tpl->innerCtx) {
+        res.message = "Could not build order template";
+        return res;
+    }
+
+    // a MARKET order is held to MARKET_LOT_SIZE, LOT_SIZE only if that's absent
+    int64_t stepRaw = tpl->stepRaw;
+    if (entry.info.qtyDecimals == tpl->qtyDecimals && entry.filters.marketStepRaw > 0) {
+        stepRaw = entry.filters.marketStepRaw;
+    }
 
     long nowMs = (long)std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()
     ).count();
 
-    std::ostringstream qs;
-    qs << "symbol=" << symbol
-       << "&side=" << sideStr
-       << "&type=MARKET"
-       << "&quantity=" << qtySs.str()
-       << "&recvWindow=5000"
-       << "&timestamp=" << nowMs;
+    // only the tail changes per order
+    std::string tail = formatQuantity(quantityBase, tpl->qtyDecimals, stepRaw);
+    tail += "&recvWindow=5000&timestamp=";
+    tail += std::to_string(nowMs);
+
+    std::string signature = finishSignature(tpl->innerCtx.get(), tail);
 
-    std::string queryString = qs.str();
-    std::string signature   = signQueryString(queryString);
-    queryString += "&signature=" + signature;
+    std::string queryString;
+    queryString.reserve(tpl->prefix.size() + tail.size() + 11 + signature.size());
+    queryString += tpl->prefix;
+    queryString += tail;
+    queryString += "&signature=";
+    queryString += signature;
 
     // do POST
     std::string endpoint = "/api/v3/order";
@@ -126,10 +169,10 @@ OrderResult BinanceRealExecutor::placeMarketOrder(const std::string& symbol,
  */
 OrderBookData BinanceRealExecutor::getOrderBookSnapshot(const std::string& symbol)
 {
-    // if we had a real REST call, we'd do throttleRequest(false) here
+    // if we had a real REST call, we'd charge RequestWeight::DEPTH_100 here
     // but you're using an internal OrderBookManager, so let's do minimal
-    // still we can treat it as 1 request for safety:
-    throttleRequest(/*isOrder=*/false);
+    // still we can treat it as 1 weight for safety:
+    limiter_->acquire(RequestWeight::LOCAL_SNAPSHOT);
 
     if (!obm_) {
         std::cerr << "[REAL] No OrderBookManager => returning empty OB\n";
@@ -139,35 +182,166 @@ OrderBookData BinanceRealExecutor::getOrderBookSnapshot(const std::string& symbo
 }
 
 /**
- * signQueryString => HMAC-SHA256
+ * getOrderBookSnapshots => all legs' books as of one instant, one weight
  */
-std::string BinanceRealExecutor::signQueryString(const std::string& query) const {
-    unsigned char* hmac_result = nullptr;
-    hmac_result = HMAC(EVP_sha256(),
-                       secretKey_.c_str(), secretKey_.size(),
-                       (unsigned char*)query.c_str(), query.size(),
-                       NULL, NULL);
+bool BinanceRealExecutor::getOrderBookSnapshots(const std::vector<std::string>& symbols,
+                                                std::vector<OrderBookData>& out)
+{
+    limiter_->acquire(RequestWeight::LOCAL_SNAPSHOT);
+
+    if (!obm_) {
+        std::cerr << "[REAL] No OrderBookManager => returning empty OBs\n";
+        out.assign(symbols.size(), OrderBookData{});
+        return false;
+    }
+    return obm_->getOrderBooks(symbols, out);
+}
+
+/**
+ * prestageOrder => build the query prefix for symbol/side and absorb it into a
+ * copy of the keyed HMAC inner state. Cheap to call repeatedly: an existing
+ * template with the same precision is left alone.
+ */
+void BinanceRealExecutor::prestageOrder(const std::string& symbol,
+                                        OrderSide side,
+                                        int qtyDecimals)
+{
+    std::string key = templateKey(symbol, side);
+    {
+        std::lock_guard<std::mutex> lk(templateMutex_);
+        auto it = templates_.find(key);
+        if (it != templates_.end() && it->second->qtyDecimals == qtyDecimals) {
+            return;
+        }
+    }
+
+    // build outside the lock, hashing the prefix is the expensive part
+    auto tpl = buildTemplate(symbol, side, qtyDecimals);
+    if (!tpl) return;
+
+    std::lock_guard<std::mutex> lk(templateMutex_);
+    auto it = templates_.find(key);
+    if (it == templates_.end()) {
+        templateOrder_.push_back(key);
+        while (templateOrder_.size() > maxTemplates_) {
+            templates_.erase(templateOrder_.front());
+            templateOrder_.pop_front();
+        }
+    }
+    templates_[key] = tpl;
+}
 
-    std::ostringstream hex_stream;
+std::shared_ptr<const OrderTemplate> BinanceRealExecutor::buildTemplate(const std::string& symbol,
+                                                                        OrderSide side,
+                                                                        int qtyDecimals) const
+{
+    auto tpl = std::make_shared<OrderTemplate>();
+    tpl->symbol      = symbol;
+    tpl->side        = side;
+    tpl->qtyDecimals = qtyDecimals;
+
+    // lot step only applies if the caller asked for the symbol's own scale
+    const SymbolInfo& si = SymbolRegistry::instance().infoOrDefault(
+        SymbolRegistry::instance().find(symbol));
+    if (si.qtyDecimals == qtyDecimals) {
+        tpl->stepRaw = si.stepRaw;
+    }
+    tpl->prefix      = "symbol=" + symbol
+                     + "&side=" + (side == OrderSide::BUY ? "BUY" : "SELL")
+                     + "&type=MARKET&quantity=";
+
+    tpl->innerCtx = makeDigestCtx();
+    if (!tpl->innerCtx
+        || EVP_MD_CTX_copy_ex(tpl->innerCtx.get(), hmacInner_.get()) != 1
+        || EVP_DigestUpdate(tpl->innerCtx.get(), tpl->prefix.data(), tpl->prefix.size()) != 1) {
+        std::cerr << "[REAL] Failed to pre-sign template for " << symbol << "\n";
+        return nullptr;
+    }
+    return tpl;
+}
+
+std::shared_ptr<const OrderTemplate> BinanceRealExecutor::findTemplate(const std::string& symbol,
+                                                                       OrderSide side)
+{
+    std::lock_guard<std::mutex> lk(templateMutex_);
+    auto it = templates_.find(templateKey(symbol, side));
+    if (it == templates_.end()) return nullptr;
+    return it->second;
+}
+
+/**
+ * initHmacKeyState => precompute SHA256(key^ipad || ...) and SHA256(key^opad || ...)
+ * starting states (RFC 2104), so the key is only processed once.
+ */
+void BinanceRealExecutor::initHmacKeyState()
+{
+    unsigned char key[64] = {0};
+    if (secretKey_.size() > sizeof(key)) {
+        SHA256((const unsigned char*)secretKey_.data(), secretKey_.size(), key);
+    } else {
+        std::memcpy(key, secretKey_.data(), secretKey_.size());
+    }
+
+    unsigned char ipad[64], opad[64];
+    for (int i = 0; i < 64; i++) {
+        ipad[i] = key[i] ^ 0x36;
+        opad[i] = key[i] ^ 0x5c;
+    }
+
+    hmacInner_ = makeDigestCtx();
+    hmacOuter_ = makeDigestCtx();
+    EVP_DigestInit_ex(hmacInner_.get(), EVP_sha256(), nullptr);
+    EVP_DigestUpdate(hmacInner_.get(), ipad, sizeof(ipad));
+    EVP_DigestInit_ex(hmacOuter_.get(), EVP_sha256(), nullptr);
+    EVP_DigestUpdate(hmacOuter_.get(), opad, sizeof(opad));
+}
+
+/**
+ * finishSignature => continue from innerState with `tail`, then wrap with the
+ * outer state. Returns lowercase hex like the old HMAC() path did.
+ */
+std::string BinanceRealExecutor::finishSignature(const EVP_MD_CTX* innerState,
+                                                 const std::string& tail) const
+{
+    static thread_local std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)>
+        scratch(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+
+    unsigned char innerDigest[32];
+    unsigned char digest[32];
+    unsigned int len = 0;
+
+    EVP_MD_CTX_copy_ex(scratch.get(), innerState);
+    EVP_DigestUpdate(scratch.get(), tail.data(), tail.size());
+    EVP_DigestFinal_ex(scratch.get(), innerDigest, &len);
+
+    EVP_MD_CTX_copy_ex(scratch.get(), hmacOuter_.get());
+    EVP_DigestUpdate(scratch.get(), innerDigest, sizeof(innerDigest));
+    EVP_DigestFinal_ex(scratch.get(), digest, &len);
+
+    static const char* HEX = "0123456789abcdef";
+    std::string out(64, '0');
     for (int i = 0; i < 32; i++) {
-        hex_stream << std::hex << std::setw(2) << std::setfill('0')
-                   << (int)hmac_result[i];
+        out[2*i]   = HEX[digest[i] >> 4];
+        out[2*i+1] = HEX[digest[i] & 0x0f];
     }
-    return hex_stream.str();
+    return out;
+}
+
+/**
+ * signQueryString => HMAC-SHA256 of a full query (no template)
+ */
+std::string BinanceRealExecutor::signQueryString(const std::string& query) const {
+    return finishSignature(hmacInner_.get(), query);
 }
 
 /**
- * Minimal http request with libcurl, now calling throttleRequest if we want
- * every HTTP call to be throttled. (We'll do that externally for clarity.)
+ * Minimal http request with libcurl. Callers acquire() from the limiter;
+ * here we only feed the response headers back so it can self-correct.
  */
 std::string BinanceRealExecutor::httpRequest(const std::string& method,
                                              const std::string& endpoint,
                                              const std::string& queryString)
 {
-    // We'll assume placeMarketOrder and getOB calls the throttleRequest
-    // so we won't double throttle here. If you prefer, you can do a general
-    // throttleRequest(false) in here as well.
-
     std::string url = baseUrl_ + endpoint;
     if (method == "GET" && !queryString.empty()) {
         url += "?" + queryString;
@@ -187,6 +361,8 @@ std::string BinanceRealExecutor::httpRequest(const std::string& method,
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, limiter_);
 
     if (method == "POST") {
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
@@ -203,74 +379,3 @@ std::string BinanceRealExecutor::httpRequest(const std::string& method,
     curl_easy_cleanup(curl);
     return readBuffer;
 }
-
-/**
- * throttleRequest => main rate-limiting logic:
- *  - Token bucket approach for requests 
- *  - Check short-burst orders per second
- */
-void BinanceRealExecutor::throttleRequest(bool isOrder)
-{
-    std::lock_guard<std::mutex> lg(throttleMutex_);
-
-    // 1) Refill requestTokens_ if needed
-    refillRequestTokens();
-
-    // 2) If it's an order, check ordersPerSec limit
-    if(isOrder){
-        resetOrderCounterIfNewSecond();
-        // if we already have e.g. 10 orders in this second => wait
-        while(orderCountInCurrentSec_ >= maxOrdersPerSec_){
-            // wait 100 ms, or until next second
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            resetOrderCounterIfNewSecond();
-        }
-        // now we can increment orderCount
-        orderCountInCurrentSec_ += 1;
-    }
-
-    // 3) For general requests or orders, consume 1 token from requestTokens_
-    while(requestTokens_ < 1.0){
-        // we have 0 tokens => wait for next refill
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        refillRequestTokens();
-    }
-    requestTokens_ -= 1.0;
-}
-
-/**
- * refillRequestTokens => each minute we restore up to maxRequestsPerMinute_ tokens
- * Implementation uses real time to measure how many tokens to add back
- */
-void BinanceRealExecutor::refillRequestTokens()
-{
-    auto now = std::chrono::steady_clock::now();
-    double secondsElapsed = std::chrono::duration<double>(now - lastRefillRequests_).count();
-
-    // each minute we get maxRequestsPerMinute_ new tokens
-    // so each second => maxRequestsPerMinute_ / 60 tokens
-    double tokensPerSecond = (double)maxRequestsPerMinute_ / 60.0;
-    double tokensToAdd     = tokensPerSecond * secondsElapsed;
-
-    if(tokensToAdd >= 1.0){
-        requestTokens_ = std::min(
-            (double)maxRequestsPerMinute_,
-            requestTokens_ + tokensToAdd
-        );
-        lastRefillRequests_ = now;
-    }
-}
-
-/**
- * resetOrderCounterIfNewSecond => if a new second has begun, reset 
- */
-void BinanceRealExecutor::resetOrderCounterIfNewSecond()
-{
-    auto now = std::chrono::steady_clock::now();
-    double msElapsed = std::chrono::duration<double, std::milli>(now - currentSecStart_).count();
-    if(msElapsed >= 1000.0){
-        // new second
-        currentSecStart_ = now;
-        orderCountInCurrentSec_ = 0;
-    }
-}
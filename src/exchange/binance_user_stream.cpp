@@ -0,0 +1,325 @@
+#include "exchange/binance_user_stream.hpp"
+#include "exchange/rate_limiter.hpp"
+#include <websocketpp/client.hpp>
+#include <websocketpp/config/asio_client.hpp>
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+using json = nlohmann::json;
+using TlsClient   = websocketpp::client<websocketpp::config::asio_tls_client>;
+using PlainClient = websocketpp::client<websocketpp::config::asio_client>;
+
+static void initTls(TlsClient& client) {
+    client.set_tls_init_handler([](websocketpp::connection_hdl){
+        return websocketpp::lib::make_shared<boost::asio::ssl::context>(
+            boost::asio::ssl::context::tlsv12_client
+        );
+    });
+}
+
+static void initTls(PlainClient&) {}
+
+static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* out) {
+    size_t totalSize = size * nmemb;
+    out->append((char*)contents, totalSize);
+    return totalSize;
+}
+
+static size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userp) {
+    static_cast<RateLimiter*>(userp)->onResponseHeader(buffer, size * nitems);
+    return size * nitems;
+}
+
+BinanceUserStream::BinanceUserStream(Wallet* wallet,
+                                     const std::string& apiKey,
+                                     const std::string& restBaseUrl,
+                                     const std::string& wsBaseUrl)
+    : wallet_(wallet)
+    , apiKey_(apiKey)
+    , restBaseUrl_(restBaseUrl)
+    , wsBaseUrl_(wsBaseUrl)
+{
+}
+
+BinanceUserStream::~BinanceUserStream() {
+    stop();
+}
+
+bool BinanceUserStream::start() {
+    if (running_.exchange(true)) return true;
+
+    std::string key = createListenKey();
+    if (key.empty()) {
+        std::cerr << "[USER-STREAM] Could not create listenKey.\n";
+        running_ = false;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lk(keyMutex_);
+        listenKey_ = key;
+    }
+
+    socketThread_    = std::thread([this](){ runSocket(); });
+    keepaliveThread_ = std::thread([this](){ runKeepalive(); });
+    std::cout << "[USER-STREAM] Started.\n";
+    return true;
+}
+
+void BinanceUserStream::stop() {
+    if (!running_.exchange(false)) return;
+
+    waitCv_.notify_all();
+    {
+        std::lock_guard<std::mutex> lk(socketMutex_);
+        if (closeSocket_) closeSocket_();
+    }
+    if (socketThread_.joinable())    socketThread_.join();
+    if (keepaliveThread_.joinable()) keepaliveThread_.join();
+
+    closeListenKey();
+    std::cout << "[USER-STREAM] Stopped.\n";
+}
+
+bool BinanceUserStream::waitFor(std::chrono::milliseconds d) {
+    std::unique_lock<std::mutex> lk(waitMutex_);
+    waitCv_.wait_for(lk, d, [this]{ return !running_.load(); });
+    return running_.load();
+}
+
+/**
+ * listenKey endpoints only need the API key header, no signature.
+ */
+std::string BinanceUserStream::restCall(const std::string& method, const std::string& query) {
+    RateLimiter::shared().acquire(RequestWeight::USER_STREAM);
+
+    std::string url = restBaseUrl_ + "/api/v3/userDataStream";
+    if (!query.empty()) url += "?" + query;
+
+    CURL* curl = curl_easy_init();
+    if (!curl) return "";
+
+    std::string response;
+    struct curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, ("X-MBX-APIKEY: " + apiKey_).c_str());
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &RateLimiter::shared());
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+
+    CURLcode res = curl_easy_perform(curl);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+
+    if (res != CURLE_OK) {
+        std::cerr << "[USER-STREAM] " << method << " error: " << curl_easy_strerror(res) << "\n";
+        return "";
+    }
+    return response;
+}
+
+std::string BinanceUserStream::createListenKey() {
+    std::string resp = restCall("POST", "");
+    try {
+        auto j = json::parse(resp);
+        if (j.contains("listenKey")) {
+            return j["listenKey"].get<std::string>();
+        }
+        std::cerr << "[USER-STREAM] listenKey error: " << resp << "\n";
+    } catch (...) {
+        std::cerr << "[USER-STREAM] listenKey parse error: " << resp << "\n";
+    }
+    return "";
+}
+
+bool BinanceUserStream::keepAliveListenKey() {
+    std::string key;
+    {
+        std::lock_guard<std::mutex> lk(keyMutex_);
+        key = listenKey_;
+    }
+    if (key.empty()) return false;
+
+    std::string resp = restCall("PUT", "listenKey=" + key);
+    // success is an empty JSON object "{}"
+    return resp.find("\"code\"") == std::string::npos && !resp.empty();
+}
+
+void BinanceUserStream::closeListenKey() {
+    std::string key;
+    {
+        std::lock_guard<std::mutex> lk(keyMutex_);
+        key.swap(listenKey_);
+    }
+    if (!key.empty()) {
+        restCall("DELETE", "listenKey=" + key);
+    }
+}
+
+void BinanceUserStream::runKeepalive() {
+    while (waitFor(std::chrono::duration_cast<std::chrono::milliseconds>(keepaliveInterval_))) {
+        if (keepAliveListenKey()) {
+            std::cout << "[USER-STREAM] listenKey keepalive OK\n";
+        } else {
+            // let the socket loop pick up a fresh key
+            std::cerr << "[USER-STREAM] keepalive failed => renewing listenKey\n";
+            {
+                std::lock_guard<std::mutex> lk(keyMutex_);
+                listenKey_.clear();
+            }
+            std::lock_guard<std::mutex> lk(socketMutex_);
+            if (closeSocket_) closeSocket_();
+        }
+    }
+}
+
+/**
+ * One connection per iteration; on close/fail we fall out of run() and loop
+ * with exponential backoff instead of recursing.
+ */
+void BinanceUserStream::runSocket() {
+    int backoffSec = 1;
+    while (running_.load()) {
+        std::string key;
+        {
+            std::lock_guard<std::mutex> lk(keyMutex_);
+            key = listenKey_;
+        }
+        if (key.empty()) {
+            key = createListenKey();
+            if (key.empty()) {
+                if (!waitFor(std::chrono::seconds(backoffSec))) break;
+                backoffSec = std::min(backoffSec * 2, 60);
+                continue;
+            }
+            std::lock_guard<std::mutex> lk(keyMutex_);
+            listenKey_ = key;
+        }
+
+        std::string url = wsBaseUrl_ + "/" + key;
+        if (url.compare(0, 5, "ws://") == 0) {
+            runConnection<PlainClient>(url, backoffSec);
+        } else {
+            runConnection<TlsClient>(url, backoffSec);
+        }
+        connected_ = false;
+
+        if (!waitFor(std::chrono::seconds(backoffSec))) break;
+        backoffSec = std::min(backoffSec * 2, 60);
+    }
+}
+
+template <class Client>
+void BinanceUserStream::runConnection(const std::string& url, int& backoffSec) {
+    Client client;
+    client.init_asio();
+    initTls(client);
+    client.set_open_handler([this, &backoffSec](websocketpp::connection_hdl){
+        connected_ = true;
+        backoffSec = 1;
+        std::cout << "[USER-STREAM] Connected.\n";
+    });
+    client.set_message_handler([this](websocketpp::connection_hdl, typename Client::message_ptr msg){
+        applyEvent(msg->get_payload());
+    });
+    client.set_fail_handler([this](websocketpp::connection_hdl){
+        connected_ = false;
+        std::cerr << "[USER-STREAM] Connection failed.\n";
+    });
+    client.set_close_handler([this](websocketpp::connection_hdl){
+        connected_ = false;
+        std::cerr << "[USER-STREAM] Connection closed.\n";
+    });
+
+    websocketpp::lib::error_code ec;
+    auto con = client.get_connection(url, ec);
+    if (ec) {
+        std::cerr << "[USER-STREAM] connect error: " << ec.message() << "\n";
+        return;
+    }
+    client.connect(con);
+    {
+        std::lock_guard<std::mutex> lk(socketMutex_);
+        closeSocket_ = [&client](){ client.stop(); };
+    }
+    if (running_.load()) {
+        client.run(); // blocking until close/fail/stop
+    }
+    std::lock_guard<std::mutex> lk(socketMutex_);
+    closeSocket_ = nullptr;
+}
+
+/**
+ * Event shapes (only the fields we use):
+ *   outboundAccountPosition: { "e":..., "B":[{"a":"BTC","f":"0.1","l":"0.0"}, ...] }
+ *   balanceUpdate:           { "e":..., "a":"BTC", "d":"-0.01" }
+ *   executionReport:         { "e":..., "s":"BTCUSDT", "S":"BUY", "x":"TRADE",
+ *                              "X":"FILLED", "l":"0.001", "L":"30000.0" }
+ *   listenKeyExpired:        { "e":... }
+ */
+bool BinanceUserStream::applyEvent(const std::string& payload) {
+    json j;
+    try {
+        j = json::parse(payload);
+    } catch (const std::exception& e) {
+        std::cerr << "[USER-STREAM] parse error: " << e.what() << "\n";
+        return false;
+    }
+    if (!j.is_object() || !j.contains("e") || !j["e"].is_string()) return false;
+    std::string type = j["e"].get<std::string>();
+
+    try {
+        if (type == "outboundAccountPosition") {
+            // only the assets that changed are included => incremental update;
+            // parsed in full first so a bad entry doesn't apply half the event
+            if (!j.contains("B") || !j["B"].is_array()) return false;
+            struct Position { std::string asset; double free; double locked; };
+            std::vector<Position> positions;
+            for (const auto& b : j["B"]) {
+                positions.push_back({ b.at("a").get<std::string>(),
+                                      std::stod(b.at("f").get<std::string>()),
+                                      std::stod(b.at("l").get<std::string>()) });
+            }
+            for (const auto& p : positions) {
+                wallet_->setBalances(p.asset, p.free, p.locked);
+            }
+        } else if (type == "balanceUpdate") {
+            wallet_->adjustBalance(j.at("a").get<std::string>(),
+                                   std::stod(j.at("d").get<std::string>()));
+        } else if (type == "executionReport") {
+            // balances come with the outboundAccountPosition that follows a
+            // fill; this is only the trade record
+            if (j.value("x", "") == "TRADE") {
+                ++fillsSeen_;
+                std::cout << "[USER-STREAM] fill " << j.value("s", "")
+                          << " " << j.value("S", "")
+                          << " qty=" << j.value("l", "0")
+                          << " px=" << j.value("L", "0")
+                          << " status=" << j.value("X", "") << "\n";
+            }
+        } else if (type == "listenKeyExpired") {
+            std::cerr << "[USER-STREAM] listenKey expired => reconnecting\n";
+            {
+                std::lock_guard<std::mutex> lk(keyMutex_);
+                listenKey_.clear();
+            }
+            std::lock_guard<std::mutex> lk(socketMutex_);
+            if (closeSocket_) closeSocket_();
+        } else {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[USER-STREAM] bad " << type << " event: " << e.what() << "\n";
+        return false;
+    }
+
+    ++eventsApplied_;
+    return true;
+}
@@ -0,0 +1,369 @@
+#include "exchange/exchange_info_cache.hpp"
+#include "exchange/rate_limiter.hpp"
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using json = nlohmann::json;
+
+/*
+ * File layout:
+ *   CacheHeader | symbolCount x CachedSymbol | string blob
+ * Strings are referenced by (offset, length) into the blob, so loading is
+ * one mmap + a linear walk, no parsing.
+ */
+
+static constexpr uint32_t CACHE_MAGIC   = 0x43495845; // "EXIC"
+static constexpr uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    int64_t  fetchedAt;
+    uint64_t contentHash;   // fnv1a64 over records + blob (also the checksum)
+    uint32_t symbolCount;
+    uint32_t stringBytes;
+};
+
+struct CachedSymbol {
+    uint32_t nameOff, baseOff, quoteOff;
+    uint8_t  nameLen, baseLen, quoteLen;
+    uint8_t  flags;          // bit0 minNotionalMarket, bit1 maxNotionalMarket
+    int32_t  priceDecimals, qtyDecimals;
+    int64_t  tickRaw, stepRaw;
+    int64_t  minQtyRaw, maxQtyRaw;
+    int64_t  marketMinQtyRaw, marketMaxQtyRaw, marketStepRaw;
+    int64_t  minPriceRaw, maxPriceRaw;
+    double   minNotional, maxNotional;
+};
+
+static_assert(sizeof(CacheHeader) == 32, "cache header layout changed");
+static_assert(sizeof(CachedSymbol) == 112, "cache record layout changed");
+
+static uint64_t fnv1a64(const char* data, size_t len, uint64_t h = 1469598103934665603ULL) {
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* out) {
+    size_t totalSize = size * nmemb;
+    out->append((char*)contents, totalSize);
+    return totalSize;
+}
+
+static size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userp) {
+    static_cast<RateLimiter*>(userp)->onResponseHeader(buffer, size * nitems);
+    return size * nitems;
+}
+
+static int64_t nowSec() {
+    return (int64_t)std::time(nullptr);
+}
+
+static void encode(const std::vector<UniverseSymbol>& symbols,
+                   std::string& records, std::string& blob)
+{
+    records.assign(symbols.size() * sizeof(CachedSymbol), '\0');
+    blob.clear();
+
+    auto addStr = [&blob](const std::string& s, uint32_t& off, uint8_t& len) {
+        off = (uint32_t)blob.size();
+        len = (uint8_t)std::min<size_t>(s.size(), 255);
+        blob.append(s.data(), len);
+    };
+
+    for (size_t i = 0; i < symbols.size(); i++) {
+        const UniverseSymbol& u = symbols[i];
+        CachedSymbol c;
+        std::memset(&c, 0, sizeof(c)); // deterministic padding => stable hash
+        addStr(u.symbol,     c.nameOff,  c.nameLen);
+        addStr(u.baseAsset,  c.baseOff,  c.baseLen);
+        addStr(u.quoteAsset, c.quoteOff, c.quoteLen);
+        c.flags = (u.filters.minNotionalMarket ? 1 : 0) | (u.filters.maxNotionalMarket ? 2 : 0);
+        c.priceDecimals   = u.info.priceDecimals;
+        c.qtyDecimals     = u.info.qtyDecimals;
+        c.tickRaw         = u.info.tickRaw;
+        c.stepRaw         = u.info.stepRaw;
+        c.minQtyRaw       = u.filters.minQtyRaw;
+        c.maxQtyRaw       = u.filters.maxQtyRaw;
+        c.marketMinQtyRaw = u.filters.marketMinQtyRaw;
+        c.marketMaxQtyRaw = u.filters.marketMaxQtyRaw;
+        c.marketStepRaw   = u.filters.marketStepRaw;
+        c.minPriceRaw     = u.filters.minPriceRaw;
+        c.maxPriceRaw     = u.filters.maxPriceRaw;
+        c.minNotional     = u.filters.minNotional;
+        c.maxNotional     = u.filters.maxNotional;
+        std::memcpy(&records[i * sizeof(CachedSymbol)], &c, sizeof(c));
+    }
+}
+
+uint64_t ExchangeInfoCache::hashUniverse(const std::vector<UniverseSymbol>& symbols)
+{
+    std::string records, blob;
+    encode(symbols, records, blob);
+    return fnv1a64(blob.data(), blob.size(), fnv1a64(records.data(), records.size()));
+}
+
+ExchangeInfoCache::ExchangeInfoCache(const std::string& path,
+                                     std::chrono::seconds ttl,
+                                     const std::string& url)
+    : path_(path)
+    , ttl_(ttl)
+    , url_(url)
+{
+}
+
+ExchangeInfoCache::~ExchangeInfoCache() {
+    stop();
+}
+
+bool ExchangeInfoCache::isFresh(const ExchangeUniverse& uni) const {
+    return uni.fetchedAt > 0 && (nowSec() - uni.fetchedAt) < (int64_t)ttl_.count();
+}
+
+/**
+ * load => fresh cache, else download (and cache), else whatever stale cache
+ * we have so the bot can still start offline.
+ */
+bool ExchangeInfoCache::load(ExchangeUniverse& out)
+{
+    ExchangeUniverse cached;
+    bool haveCache = loadFromDisk(cached);
+    if (haveCache && isFresh(cached)) {
+        std::cout << "[EXINFO] Using cache " << path_ << " ("
+                  << cached.symbols.size() << " symbols, age "
+                  << (nowSec() - cached.fetchedAt) << "s)\n";
+        out = std::move(cached);
+        currentHash_ = out.hash;
+        return true;
+    }
+
+    ExchangeUniverse fetched;
+    if (fetch(fetched)) {
+        save(fetched);
+        out = std::move(fetched);
+        currentHash_ = out.hash;
+        return true;
+    }
+
+    if (haveCache) {
+        std::cerr << "[EXINFO] Download failed => using stale cache (age "
+                  << (nowSec() - cached.fetchedAt) << "s)\n";
+        out = std::move(cached);
+        currentHash_ = out.hash;
+        return true;
+    }
+    return false;
+}
+
+bool ExchangeInfoCache::loadFromDisk(ExchangeUniverse& out) const
+{
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CacheHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    const char* base = static_cast<const char*>(map);
+    CacheHeader h;
+    std::memcpy(&h, base, sizeof(h));
+
+    size_t recBytes = (size_t)h.symbolCount * sizeof(CachedSymbol);
+    bool ok = h.magic == CACHE_MAGIC && h.version == CACHE_VERSION
+           && size == sizeof(CacheHeader) + recBytes + h.stringBytes;
+    const char* recs = base + sizeof(CacheHeader);
+    const char* blob = recs + recBytes;
+    if (ok) {
+        uint64_t sum = fnv1a64(blob, h.stringBytes, fnv1a64(recs, recBytes));
+        ok = (sum == h.contentHash);
+    }
+    if (!ok) {
+        std::cerr << "[EXINFO] Cache " << path_ << " is invalid, ignoring it.\n";
+        ::munmap(map, size);
+        return false;
+    }
+
+    out.symbols.clear();
+    out.symbols.resize(h.symbolCount);
+    for (uint32_t i = 0; i < h.symbolCount; i++) {
+        CachedSymbol c;
+        std::memcpy(&c, recs + i * sizeof(CachedSymbol), sizeof(c));
+        if ((size_t)c.nameOff + c.nameLen > h.stringBytes ||
+            (size_t)c.baseOff + c.baseLen > h.stringBytes ||
+            (size_t)c.quoteOff + c.quoteLen > h.stringBytes) {
+            ::munmap(map, size);
+            return false;
+        }
+        UniverseSymbol& u = out.symbols[i];
+        u.symbol.assign(blob + c.nameOff, c.nameLen);
+        u.baseAsset.assign(blob + c.baseOff, c.baseLen);
+        u.quoteAsset.assign(blob + c.quoteOff, c.quoteLen);
+        u.info.priceDecimals = c.priceDecimals;
+        u.info.qtyDecimals   = c.qtyDecimals;
+        u.info.tickRaw       = c.tickRaw;
+        u.info.stepRaw       = c.stepRaw;
+        u.filters.minQtyRaw       = c.minQtyRaw;
+        u.filters.maxQtyRaw       = c.maxQtyRaw;
+        u.filters.marketMinQtyRaw = c.marketMinQtyRaw;
+        u.filters.marketMaxQtyRaw = c.marketMaxQtyRaw;
+        u.filters.marketStepRaw   = c.marketStepRaw;
+        u.filters.minPriceRaw     = c.minPriceRaw;
+        u.filters.maxPriceRaw     = c.maxPriceRaw;
+        u.filters.minNotional     = c.minNotional;
+        u.filters.maxNotional     = c.maxNotional;
+        u.filters.minNotionalMarket = (c.flags & 1) != 0;
+        u.filters.maxNotionalMarket = (c.flags & 2) != 0;
+    }
+    out.hash      = h.contentHash;
+    out.fetchedAt = h.fetchedAt;
+    ::munmap(map, size);
+    return true;
+}
+
+/**
+ * fetch => GET exchangeInfo, keep TRADING symbols only, reduce to
+ * UniverseSymbol (sorted so the hash doesn't depend on response order).
+ */
+bool ExchangeInfoCache::fetch(ExchangeUniverse& out) const
+{
+    RateLimiter& limiter = RateLimiter::shared();
+    limiter.acquire(RequestWeight::EXCHANGE_INFO);
+
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        std::cerr << "[EXINFO] curl init failed\n";
+        return false;
+    }
+    std::string response;
+    curl_easy_setopt(curl, CURLOPT_URL, url_.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &limiter);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+    CURLcode res = curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+    if (res != CURLE_OK) {
+        std::cerr << "[EXINFO] exchangeInfo curl error: " << curl_easy_strerror(res) << "\n";
+        return false;
+    }
+
+    json j;
+    try {
+        j = json::parse(response);
+    } catch (...) {
+        std::cerr << "[EXINFO] parse exchangeInfo JSON failed\n";
+        return false;
+    }
+    if (!j.contains("symbols") || !j["symbols"].is_array()) {
+        std::cerr << "[EXINFO] No 'symbols' array in exchangeInfo\n";
+        return false;
+    }
+
+    out.symbols.clear();
+    out.symbols.reserve(j["symbols"].size());
+    for (auto& symObj : j["symbols"]) {
+        if (symObj.value("status", "") != "TRADING") continue;
+        UniverseSymbol u;
+        if (!SymbolRegistry::parseExchangeInfo(symObj, u.symbol, u.baseAsset, u.quoteAsset,
+                                               u.info, u.filters)) {
+            continue;
+        }
+        out.symbols.push_back(std::move(u));
+    }
+    std::sort(out.symbols.begin(), out.symbols.end(),
+              [](const UniverseSymbol& a, const UniverseSymbol& b){ return a.symbol < b.symbol; });
+
+    out.hash      = hashUniverse(out.symbols);
+    out.fetchedAt = nowSec();
+    std::cout << "[EXINFO] Downloaded exchangeInfo: " << out.symbols.size()
+              << " trading symbols.\n";
+    return true;
+}
+
+bool ExchangeInfoCache::save(const ExchangeUniverse& uni) const
+{
+    std::string records, blob;
+    encode(uni.symbols, records, blob);
+
+    CacheHeader h;
+    std::memset(&h, 0, sizeof(h));
+    h.magic       = CACHE_MAGIC;
+    h.version     = CACHE_VERSION;
+    h.fetchedAt   = uni.fetchedAt;
+    h.contentHash = fnv1a64(blob.data(), blob.size(), fnv1a64(records.data(), records.size()));
+    h.symbolCount = (uint32_t)uni.symbols.size();
+    h.stringBytes = (uint32_t)blob.size();
+
+    std::string tmp = path_ + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        std::cerr << "[EXINFO] Could not write " << tmp << "\n";
+        return false;
+    }
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1
+           && std::fwrite(records.data(), 1, records.size(), f) == records.size()
+           && std::fwrite(blob.data(), 1, blob.size(), f) == blob.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+        std::cerr << "[EXINFO] Could not save cache " << path_ << "\n";
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void ExchangeInfoCache::startRefresh(std::chrono::seconds interval,
+                                     std::function<void(const ExchangeUniverse&)> onChange)
+{
+    if (running_.exchange(true)) return;
+    refreshInterval_ = interval;
+    onChange_ = std::move(onChange);
+    refreshThread_ = std::thread([this](){ runRefresh(); });
+}
+
+void ExchangeInfoCache::stop()
+{
+    if (!running_.exchange(false)) return;
+    waitCv_.notify_all();
+    if (refreshThread_.joinable()) refreshThread_.join();
+}
+
+void ExchangeInfoCache::runRefresh()
+{
+    while (running_.load()) {
+        {
+            std::unique_lock<std::mutex> lk(waitMutex_);
+            waitCv_.wait_for(lk, refreshInterval_, [this]{ return !running_.load(); });
+        }
+        if (!running_.load()) break;
+
+        ExchangeUniverse fresh;
+        if (!fetch(fresh)) continue; // keep what we have, try next time
+
+        save(fresh); // also refreshes the timestamp when nothing changed
+        if (fresh.hash == currentHash_.load()) continue;
+
+        std::cout << "[EXINFO] Universe changed => applying refresh.\n";
+        currentHash_ = fresh.hash;
+        if (onChange_) onChange_(fresh);
+    }
+}
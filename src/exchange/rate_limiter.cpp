@@ -0,0 +1,114 @@
+#include "exchange/rate_limiter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+RateLimiter::RateLimiter(int weightPerMinute, int ordersPerSecond)
+{
+    setWeightPerMinute(weightPerMinute);
+    setOrdersPerSecond(ordersPerSecond);
+}
+
+RateLimiter& RateLimiter::shared() {
+    static RateLimiter instance;
+    return instance;
+}
+
+int64_t RateLimiter::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * perPeriod units per periodNs => one unit every periodNs/perPeriod, and we
+ * allow a full period's worth of burst (same as the old "bucket starts full").
+ */
+void RateLimiter::configure(Bucket& b, int perPeriod, int64_t periodNs) {
+    if (perPeriod < 1) perPeriod = 1;
+    int64_t interval = periodNs / perPeriod;
+    b.intervalNs.store(interval, std::memory_order_relaxed);
+    b.burstNs.store(interval * perPeriod, std::memory_order_relaxed);
+}
+
+void RateLimiter::setWeightPerMinute(int weightPerMinute) {
+    configure(weight_, weightPerMinute, 60LL * 1000000000LL);
+}
+
+void RateLimiter::setOrdersPerSecond(int ordersPerSecond) {
+    configure(orders_, ordersPerSecond, 1000000000LL);
+}
+
+int64_t RateLimiter::reserve(Bucket& b, int cost, int64_t now) {
+    int64_t interval = b.intervalNs.load(std::memory_order_relaxed);
+    int64_t burst    = b.burstNs.load(std::memory_order_relaxed);
+    int64_t tat      = b.tatNs.load(std::memory_order_relaxed);
+    int64_t newTat   = 0;
+    do {
+        newTat = std::max(tat, now) + (int64_t)cost * interval;
+    } while (!b.tatNs.compare_exchange_weak(tat, newTat,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed));
+    int64_t allowAt = newTat - burst;
+    return std::max<int64_t>(0, allowAt - now);
+}
+
+void RateLimiter::acquire(int weight, bool isOrder) {
+    int64_t now  = nowNs();
+    int64_t wait = reserve(weight_, weight, now);
+    if (isOrder) {
+        wait = std::max(wait, reserve(orders_, 1, now));
+    }
+
+    acquired_.fetch_add(1, std::memory_order_relaxed);
+    if (wait <= 0) return;
+
+    throttled_.fetch_add(1, std::memory_order_relaxed);
+    throttledNs_.fetch_add(wait, std::memory_order_relaxed);
+    int64_t prevMax = maxWaitNs_.load(std::memory_order_relaxed);
+    while (wait > prevMax &&
+           !maxWaitNs_.compare_exchange_weak(prevMax, wait, std::memory_order_relaxed)) {
+    }
+
+    std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+}
+
+void RateLimiter::updateUsedWeight(int usedWeight1m) {
+    if (usedWeight1m < 0) return;
+    serverUsedWeight_.store(usedWeight1m, std::memory_order_relaxed);
+
+    // Server says `usedWeight1m` is spent => our tat must be at least
+    // now + used*interval. Never move it backwards (we may know of requests
+    // the server hasn't counted yet).
+    int64_t interval = weight_.intervalNs.load(std::memory_order_relaxed);
+    int64_t floorTat = nowNs() + (int64_t)usedWeight1m * interval;
+    int64_t tat = weight_.tatNs.load(std::memory_order_relaxed);
+    while (tat < floorTat &&
+           !weight_.tatNs.compare_exchange_weak(tat, floorTat,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+    }
+}
+
+void RateLimiter::onResponseHeader(const char* line, size_t len) {
+    static const char KEY[] = "x-mbx-used-weight-1m:";
+    const size_t keyLen = sizeof(KEY) - 1;
+    if (len <= keyLen) return;
+    for (size_t i = 0; i < keyLen; i++) {
+        if (std::tolower((unsigned char)line[i]) != KEY[i]) return;
+    }
+    std::string value(line + keyLen, len - keyLen);
+    updateUsedWeight(std::atoi(value.c_str()));
+}
+
+RateLimiterMetrics RateLimiter::metrics() const {
+    RateLimiterMetrics m;
+    m.acquired         = acquired_.load(std::memory_order_relaxed);
+    m.throttled        = throttled_.load(std::memory_order_relaxed);
+    m.throttledMs      = throttledNs_.load(std::memory_order_relaxed) / 1e6;
+    m.maxWaitMs        = maxWaitNs_.load(std::memory_order_relaxed) / 1e6;
+    m.serverUsedWeight = serverUsedWeight_.load(std::memory_order_relaxed);
+    return m;
+}
@@ -2,18 +2,25 @@
 #include <thread>
 #include <atomic>
 #include <fstream>
+#include <memory>
 #include <nlohmann/json.hpp>
 
 #include "core/wallet.hpp"
+#include "core/wallet_journal.hpp"
 #include "exchange/i_exchange_executor.hpp"
 #include "exchange/binance_dry_executor.hpp"
 #include "exchange/binance_real_executor.hpp"
 #include "exchange/binance_account_sync.hpp"
+#include "exchange/binance_user_stream.hpp"
+#include "exchange/rate_limiter.hpp"
 #include "exchange/key_encryptor.hpp"
 
 #include "engine/simulator.hpp"
 #include "engine/triangle_scanner.hpp"
+#include "engine/opportunity_tracker.hpp"
 #include "core/orderbook.hpp"
+#include "core/timer_service.hpp"
+#include "core/thread_pool.hpp"
 
 // A small helper to load JSON config safely
 static nlohmann::json loadConfig(const std::string& path) {
@@ -34,10 +41,39 @@ static nlohmann::json loadConfig(const std::string& path) {
 }
 
 // Simple TUI function: prints a “dashboard” with trades so far
-static void printDashboard(const Simulator& sim) {
+static void printDashboard(const Simulator& sim, const TriangleScanner& scanner,
+                           const OrderBookManager& obm) {
     std::cout << "\n======== DASHBOARD ========\n";
     std::cout << " Total trades so far:   " << sim.getTotalTrades() << "\n";
     std::cout << " Cumulative profit (USDT est): " << sim.getCumulativeProfit() << "\n";
+
+    RateLimiterMetrics rl = RateLimiter::shared().metrics();
+    std::cout << " Requests: " << rl.acquired
+              << " throttled=" << rl.throttled
+              << " waitTotal=" << rl.throttledMs << "ms"
+              << " waitMax=" << rl.maxWaitMs << "ms"
+              << " serverWeight1m=" << rl.serverUsedWeight << "\n";
+
+    std::cout << " Filter rejects:";
+    for (int r = 1; r < (int)FilterReject::COUNT; r++) {
+        std::cout << " " << filterRejectName((FilterReject)r)
+                  << "=" << sim.getFilterRejects((FilterReject)r);
+    }
+    std::cout << "\n";
+    OpportunityTracker::instance().printSummary(std::cout);
+    std::cout << " Routes backing off: " << scanner.parkedRouteCount()
+              << "  Stale books: " << obm.getStaleBooks()
+              << "  Stale-leg skips: " << scanner.getStaleSkips()
+              << "  Torn reads: " << obm.getTornReads() << "\n";
+
+    FeedStats fs = obm.getFeedStats();
+    std::cout << " Feeds: " << fs.linksUp << "/" << fs.links << " links up ("
+              << fs.chunks << " chunks)"
+              << " msgs=" << fs.messages
+              << " dup=" << obm.getDuplicateMessages()
+              << " reconnects=" << fs.reconnects
+              << " silentDrops=" << fs.gapDrops
+              << " pongDrops=" << fs.pongDrops << "\n";
     std::cout << "==========================\n";
 }
 
@@ -61,13 +97,63 @@ int main(int argc, char** argv) {
     bool useTestnet     = cfg.value("useTestnet", false);
     double minProfit    = cfg.value("minProfitUSDT", 0.5);
     std::string pairsFile = cfg.value("pairsFile", "config/pairs.json");
+    int prestageTopK    = cfg.value("prestageTopK", 10);
+    int batchSimTopK    = cfg.value("batchSimTopK", 256);
+    std::string oppStatsFile = cfg.value("opportunityStatsFile", "opportunity_stats.csv");
+    bool parallelLegs   = cfg.value("parallelLegs", false);
+    bool useUserStream  = cfg.value("userDataStream", true);
+    int reconcileSec    = cfg.value("reconcileIntervalSec", 300);
+    std::string restBaseUrl   = cfg.value("restBaseUrl", "https://testnet.binance.vision");
+    std::string userStreamUrl = cfg.value("userStreamUrl", "wss://testnet.binance.vision/ws");
+    std::string journalPath = cfg.value("walletJournal", "wallet");
+    std::string exInfoCache = cfg.value("exchangeInfoCache", "config/exchange_info.cache");
+    int exInfoTtlSec     = cfg.value("exchangeInfoTtlSec", 6 * 3600);
+    int exInfoRefreshSec = cfg.value("exchangeInfoRefreshSec", 3600);
+    std::string topoCache = cfg.value("topologyCache", "config/topology.cache");
+    // defaults = the shipped config: one rotation per triangle, preferring
+    // these bases (a missing key must not change the topology cache hash)
+    TopologyOptions topoOpts;
+    topoOpts.keepRotations = cfg.value("topologyKeepRotations", false);
+    topoOpts.baseAssets    = cfg.value("topologyBaseAssets",
+                                       std::vector<std::string>{ "USDT", "BTC", "ETH", "BNB" });
+    topoOpts.quoteAssets   = cfg.value("topologyQuoteAssets", std::vector<std::string>{});
+    FeeSchedule fees;
+    fees.defaultFee  = fee;
+    fees.perSymbol   = cfg.value("symbolFees", std::unordered_map<std::string, double>{});
+    fees.bnbDiscount = cfg.value("bnbFeeDiscount", false);
+    bool cycleDetection = cfg.value("cycleDetection", true);
+    int cycleMinLegs    = cfg.value("cycleMinLegs", 4);
+    int cycleMaxLegs    = cfg.value("cycleMaxLegs", 5);
+    int cycleMaxTracked = cfg.value("cycleMaxTracked", 1024);
+    int freeFails       = cfg.value("failFreeAttempts", 2);
+    double backoffBaseSec  = cfg.value("failBackoffBaseSec", 30.0);
+    double backoffMaxSec   = cfg.value("failBackoffMaxSec", 1800.0);
+    double backoffDecaySec = cfg.value("failBackoffDecaySec", 60.0);
+    int dashboardSec    = cfg.value("dashboardIntervalSec", 30);
+    int rescoreSec      = cfg.value("rescoreIntervalSec", 30);
+    int statsExportSec  = cfg.value("opportunityStatsExportSec", 30);
+    double staleBookMs  = cfg.value("staleBookMs", 500.0);
+    double maxBookAgeMs = cfg.value("maxBookAgeMs", 1000.0);
+    FeedOptions feedOpts;
+    feedOpts.hotStandby     = cfg.value("feedHotStandby", true);
+    feedOpts.gapNs          = (int64_t)(cfg.value("feedGapMs", 5000.0) * 1e6);
+    feedOpts.pingIntervalNs = (int64_t)(cfg.value("feedPingIntervalMs", 5000.0) * 1e6);
+    feedOpts.pongTimeoutNs  = (int64_t)(cfg.value("feedPongTimeoutMs", 15000.0) * 1e6);
+    feedOpts.backoffBaseNs  = (int64_t)(cfg.value("feedBackoffBaseMs", 250.0) * 1e6);
+    feedOpts.backoffMaxNs   = (int64_t)(cfg.value("feedBackoffMaxMs", 30000.0) * 1e6);
+    feedOpts.stableUpNs     = (int64_t)(cfg.value("feedStableUpMs", 10000.0) * 1e6);
 
     // 1b) Create wallet object
     Wallet wallet;
 
-    // NEW: Attempt to load existing wallet data from disk
-    bool loadedFromDisk = wallet.loadFromFile("wallet.json");
-    if(loadedFromDisk) {
+    // Recover from the journal (snapshot + log); wallet.json is only the
+    // legacy fallback for installs that never ran with the journal.
+    WalletJournal journal(journalPath);
+    bool loadedFromDisk = journal.recover(wallet);
+    if (loadedFromDisk) {
+        std::cout << "[MAIN] Recovered wallet from journal " << journalPath << ".*\n";
+    } else if (wallet.loadFromFile("wallet.json")) {
+        loadedFromDisk = true;
         std::cout << "[MAIN] Loaded wallet from wallet.json successfully! Skipping config-based init.\n";
     } else {
         std::cout << "[MAIN] No wallet.json found (or load failed). Using config-based init.\n";
@@ -87,6 +173,9 @@ int main(int argc, char** argv) {
         }
     }
 
+    // from here on every committed trade / balance set is journaled
+    journal.start(&wallet);
+
     std::cout << "[CONFIG] fee=" << fee
               << " slip=" << slippage
               << " maxFraction=" << maxFraction
@@ -99,6 +188,7 @@ int main(int argc, char** argv) {
     IExchangeExecutor* executor = nullptr;
     std::atomic<bool> keepSyncing(true);
     std::thread syncThread;
+    std::unique_ptr<BinanceUserStream> userStream;
 
     if (!useTestnet) {
         // DRY mode => no real trades
@@ -162,7 +252,7 @@ int main(int argc, char** argv) {
         std::string apiKey = keyJson["apiKey"].get<std::string>();
         std::string secretKey = keyJson["secretKey"].get<std::string>();
 
-        std::string baseUrl = "https://testnet.binance.vision";
+        std::string baseUrl = restBaseUrl;
         auto* realExec = new BinanceRealExecutor(apiKey, secretKey, baseUrl);
 
         // Set throttler limits for testnet
@@ -171,8 +261,20 @@ int main(int argc, char** argv) {
 
         executor = realExec;
 
-        // spawn a wallet sync thread
-        startWalletSyncThread(&wallet, apiKey, secretKey, baseUrl, &keepSyncing, syncThread);
+        // live balances/fills via the user data stream; REST polling stays
+        // as a slow reconciliation pass (or the only source if the stream is off)
+        int syncIntervalSec = 5;
+        if (useUserStream) {
+            userStream.reset(new BinanceUserStream(&wallet, apiKey, baseUrl, userStreamUrl));
+            if (userStream->start()) {
+                syncIntervalSec = reconcileSec;
+            } else {
+                std::cerr << "[EXECUTOR] User data stream unavailable => REST polling only.\n";
+                userStream.reset();
+            }
+        }
+        startWalletSyncThread(&wallet, apiKey, secretKey, baseUrl, &keepSyncing, syncThread,
+                              syncIntervalSec);
         std::cout << "[EXECUTOR] Using REAL BINANCE TESTNET mode (encrypted keys).\n";
     }
 
@@ -189,6 +291,7 @@ int main(int argc, char** argv) {
     } else {
         std::cout << "[MAIN] Live execution mode is OFF (simulation only).\n";
     }
+    sim.setParallelLegs(parallelLegs);
 
     // 4) Create scanner + orderbook
     TriangleScanner scanner;
@@ -200,14 +303,27 @@ int main(int argc, char** argv) {
 
     // (NEW) let's also configure a 10s cooldown:
     scanner.setTriangleCooldownSeconds(10.0);
+    // failing routes back off 30s, 60s, 120s... and leave the scan set meanwhile
+    scanner.setFailureBackoff(freeFails, backoffBaseSec, backoffMaxSec, backoffDecaySec);
 
-    // 6) dynamic load from /exchangeInfo => BFS-based cycle detection
+    // 6) dynamic load from /exchangeInfo (or its local cache) => BFS-based cycle detection
     // If that fails, fallback to file
+    scanner.setExchangeInfoCache(exInfoCache, exInfoTtlSec);
+    scanner.setTopologyCache(topoCache);
+    scanner.setTopologyOptions(topoOpts);
+    scanner.setFeeSchedule(fees);
+    if (cycleDetection) {
+        scanner.enableCycleDetection(cycleMinLegs, cycleMaxLegs, cycleMaxTracked);
+    }
     if (!scanner.loadTrianglesFromBinanceExchangeInfo()) {
         std::cerr << "[MAIN] Could not load dynamic triangles => fallback to file: " << pairsFile << "\n";
         scanner.loadTrianglesFromFile(pairsFile);
+    } else {
+        scanner.startExchangeInfoRefresh(exInfoRefreshSec);
     }
     scanner.setMinProfitThreshold(threshold);
+    scanner.setMaxBookAgeMs(maxBookAgeMs);
+    obm.setFeedOptions(feedOpts);
 
     // Now that all symbols are known (from BFS or file),
     // we open a single combined WebSocket for them:
@@ -215,24 +331,79 @@ int main(int argc, char** argv) {
 
     std::cout << "[MAIN] Bot running. Press Ctrl+C to quit.\n";
 
-    // 7) main loop
-    // Optionally: we could re-score all triangles here every 30s, then trade top N
-    // For now, we just do a TUI print:
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::seconds(30));
-        wallet.printAll();
-        printDashboard(sim);
-
-        // Example of re-scoring:
-        //   1) scanner.rescoreAllTrianglesConcurrently(...);
-        //   2) pick top X from scanner, or do an external approach
+    // 7) periodic jobs, triggered by the timer service (which also ends
+    // cooldowns, brings backed-off routes back, sweeps for stale books and
+    // supervises the feeds). The timer thread only posts them to a pool; a
+    // job still running when it comes due again skips that round.
+    auto& timers = TimerService::instance();
+    obm.startStaleSweep(staleBookMs);
+
+    std::atomic<bool> dashboardBusy{false}, exportBusy{false}, rescoreBusy{false};
+    ThreadPool jobs(2);
+    auto post = [&jobs](std::atomic<bool>& busy, std::function<void()> job) {
+        if (busy.exchange(true)) return;
+        jobs.submit([&busy, job]() {
+            try {
+                job();
+            } catch (const std::exception& e) {
+                std::cerr << "[MAIN] Periodic job failed: " << e.what() << "\n";
+            }
+            busy.store(false);
+        });
+    };
+
+    timers.schedulePeriodic((int64_t)dashboardSec * 1000000000LL, [&]() {
+        post(dashboardBusy, [&]() {
+            wallet.printAll();
+            printDashboard(sim, scanner, obm);
+        });
+    });
+
+    if (!oppStatsFile.empty()) {
+        timers.schedulePeriodic((int64_t)statsExportSec * 1000000000LL, [&, oppStatsFile]() {
+            post(exportBusy, [oppStatsFile]() {
+                OpportunityTracker::instance().exportCSV(oppStatsFile);
+            });
+        });
     }
 
+    timers.schedulePeriodic((int64_t)rescoreSec * 1000000000LL, [&, prestageTopK, batchSimTopK]() {
+        post(rescoreBusy, [&, prestageTopK, batchSimTopK]() {
+            // re-key every route from the current edge rates
+            scanner.rescoreAllTrianglesConcurrently();
+
+            // keep signed order templates warm for the current top-K triangles
+            scanner.prestageTopTriangles(prestageTopK);
+
+            // depth-check the current top-K against one consistent book snapshot
+            std::vector<SimCandidate> batch;
+            scanner.simulateTopTriangles(batchSimTopK, batch);
+            if (!batch.empty()) {
+                int profitable = 0;
+                const SimCandidate* best = nullptr;
+                for (const auto& c : batch) {
+                    if (c.estimatedProfit > 0.0) profitable++;
+                    if (!best || c.estimatedProfit > best->estimatedProfit) best = &c;
+                }
+                std::cout << "[BATCH] " << profitable << "/" << batch.size()
+                          << " top routes profitable at depth, best=" << best->estimatedProfit
+                          << " USDT (tri " << best->triIndex << ")\n";
+            }
+        });
+    });
+
+    // blocks until timers.stop()
+    timers.run();
+
     // cleanup on exit
+    if (userStream) {
+        userStream->stop();
+    }
     keepSyncing.store(false);
     if (syncThread.joinable()) {
         syncThread.join();
     }
+    journal.stop();
     delete executor;
 
     return 0;
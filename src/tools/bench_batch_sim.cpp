@@ -0,0 +1,139 @@
+#include "engine/simulator.hpp"
+#include "core/usdt_valuation.hpp"
+#include "core/thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Batch route evaluation on a synthetic universe: USDT -> A -> B -> USDT
+// over N assets with depth-20 books, evaluated three ways for 1k..100k
+// candidates: one std::async per candidate with its own book copies (the
+// old simulateMultipleTrianglesConcurrently), simulateBatch inline on one
+// thread, and simulateBatch chunked on a bounded pool.
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static OrderBookData makeBook(double mid, double spread, std::mt19937& rng) {
+    std::uniform_real_distribution<double> qty(0.5, 5.0);
+    OrderBookData ob;
+    for (int i = 0; i < 20; i++) {
+        double step = mid * 0.0002 * i;
+        ob.bids.push_back({ mid * (1.0 - spread) - step, qty(rng) });
+        ob.asks.push_back({ mid * (1.0 + spread) + step, qty(rng) });
+    }
+    return ob;
+}
+
+int main(int argc, char** argv) {
+    int assets  = (argc > 1 ? std::atoi(argv[1]) : 40);
+    int workers = (argc > 2 ? std::atoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency()));
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> usdPx(0.5, 500.0);
+    std::uniform_real_distribution<double> skew(-0.015, 0.015);
+
+    auto& reg = SymbolRegistry::instance();
+    SymbolFilters filters;
+    filters.minNotional = 0.0;
+
+    // XUSDT books + one AB cross per pair (A < B), all in one snapshot
+    std::vector<std::string> names;
+    std::vector<double> px;
+    std::vector<OrderBookData> books;
+    std::vector<SymbolId> ids;
+    for (int a = 0; a < assets; a++) {
+        names.push_back("A" + std::to_string(a));
+        px.push_back(usdPx(rng));
+        ids.push_back(reg.registerSymbol(names[a] + "USDT", names[a], "USDT", SymbolInfo{}, filters));
+        books.push_back(makeBook(px[a], 0.0005, rng));
+        UsdtValuation::instance().onTopOfBook(ids.back(), books.back().bids[0].price, books.back().asks[0].price);
+    }
+    std::vector<Triangle> routes;
+    for (int a = 0; a < assets; a++) {
+        for (int b = a + 1; b < assets; b++) {
+            std::string cross = names[a] + names[b];
+            ids.push_back(reg.registerSymbol(cross, names[a], names[b], SymbolInfo{}, filters));
+            books.push_back(makeBook(px[a] / px[b] * (1.0 + skew(rng)), 0.0005, rng));
+
+            Triangle fwd, inv;
+            fwd.base = inv.base = "USDT";
+            fwd.path = { names[a] + "USDT_INV", cross + "_FWD", names[b] + "USDT_FWD" };
+            inv.path = { names[b] + "USDT_INV", cross + "_INV", names[a] + "USDT_FWD" };
+            routes.push_back(fwd);
+            routes.push_back(inv);
+        }
+    }
+
+    BookSnapshot snap;
+    snap.slot.assign(reg.size(), -1);
+    for (size_t k = 0; k < ids.size(); k++) {
+        snap.slot[ids[k]] = (int)k;
+    }
+    snap.books = books;
+    snap.count = books.size();
+
+    Wallet wallet;
+    wallet.setBalance("USDT", 100000.0);
+    Simulator sim("bench_batch_sim.csv", 0.001, 0.01, 0.5, 0.2, &wallet, nullptr, 0.0);
+    ThreadPool pool(workers);
+
+    std::cout << "[BENCH] assets=" << assets << " routes=" << routes.size()
+              << " symbols=" << ids.size() << " workers=" << workers << "\n";
+
+    for (size_t count : { (size_t)1000, (size_t)10000, (size_t)100000 }) {
+        std::vector<int> cand(count);
+        for (size_t k = 0; k < count; k++) cand[k] = (int)(k % routes.size());
+        std::vector<SimCandidate> out(count);
+
+        // old way: a thread per candidate, each copying its three books
+        double asyncMs = -1.0;
+        if (count <= 10000) {
+            auto t0 = Clock::now();
+            std::vector<std::future<double>> futs;
+            futs.reserve(count);
+            for (size_t k = 0; k < count; k++) {
+                futs.push_back(std::async(std::launch::async, [&, k]() {
+                    const Triangle& tri = routes[cand[k]];
+                    std::vector<OrderBookData> legBooks;
+                    for (const auto& leg : tri.path) {
+                        std::string raw;
+                        splitLegSymbol(leg, raw);
+                        legBooks.push_back(*snap.find(reg.find(raw)));
+                    }
+                    return sim.estimateCycleProfitUSDT(tri, legBooks);
+                }));
+            }
+            for (auto& f : futs) f.get();
+            asyncMs = msSince(t0);
+        }
+
+        auto t0 = Clock::now();
+        sim.simulateBatch(routes, cand.data(), count, snap, pool, out.data(), count);
+        double inlineMs = msSince(t0);
+
+        t0 = Clock::now();
+        sim.simulateBatch(routes, cand.data(), count, snap, pool, out.data());
+        double pooledMs = msSince(t0);
+
+        int profitable = 0;
+        for (const auto& c : out) profitable += (c.estimatedProfit > 0.0);
+
+        std::cout << "  candidates=" << count
+                  << "  async=" << (asyncMs < 0 ? std::string("skipped") : std::to_string(asyncMs) + "ms")
+                  << "  inline=" << inlineMs << "ms"
+                  << "  pooled=" << pooledMs << "ms"
+                  << "  (" << (pooledMs > 0 ? 1000.0 * count / pooledMs : 0.0) << "/s, "
+                  << profitable << " profitable)\n";
+    }
+    return 0;
+}
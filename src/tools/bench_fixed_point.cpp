@@ -0,0 +1,86 @@
+#include "core/fixed_point.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Compares the old double path (stod / setprecision(8)) with FixedPoint
+// on depth-style strings, and shows wallet drift from repeated fills.
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    int iterations = (argc > 1 ? std::atoi(argv[1]) : 200000);
+
+    // what a depth20 message looks like: price at 2dp, qty at 5dp, padded to 8
+    std::vector<std::string> samples;
+    for (int i = 0; i < 1000; i++) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.8f", 30000.0 + i * 0.01);
+        samples.push_back(buf);
+        std::snprintf(buf, sizeof(buf), "%.8f", 0.00001 * (i + 1));
+        samples.push_back(buf);
+    }
+
+    // ---- parse ----
+    volatile double dsink = 0.0;
+    auto t0 = Clock::now();
+    for (int it = 0; it < iterations; it++) {
+        dsink = dsink + std::stod(samples[it % samples.size()]);
+    }
+    double stodMs = msSince(t0);
+
+    volatile int64_t isink = 0;
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; it++) {
+        const std::string& s = samples[it % samples.size()];
+        int64_t v = 0;
+        FixedPoint::parse(s.data(), s.size(), 8, v);
+        isink = isink + v;
+    }
+    double fixedParseMs = msSince(t0);
+
+    // ---- format ----
+    t0 = Clock::now();
+    size_t totalLen = 0;
+    for (int it = 0; it < iterations; it++) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(8) << (0.00001 * (it % 1000 + 1));
+        totalLen += oss.str().size();
+    }
+    double ossMs = msSince(t0);
+
+    t0 = Clock::now();
+    char buf[32];
+    for (int it = 0; it < iterations; it++) {
+        totalLen += FixedPoint::format((int64_t)(it % 1000 + 1) * 1000, 8, buf);
+    }
+    double fixedFmtMs = msSince(t0);
+
+    // ---- drift: credit the same fill many times, compare to the exact total ----
+    const int fills = 1000000;
+    double dBal = 1000.0;
+    int64_t iBal = FixedPoint::fromDouble(1000.0, 8);
+    int64_t fillRaw = FixedPoint::parse("0.00012345", 8);
+    double fill = 0.00012345;
+    for (int i = 0; i < fills; i++) { dBal += fill; iBal += fillRaw; }
+    int64_t expected = FixedPoint::fromDouble(1000.0, 8) + fillRaw * fills;
+
+    std::cout << "[BENCH] iterations=" << iterations << "\n"
+              << "  parse  stod=" << stodMs << "ms  fixed=" << fixedParseMs << "ms\n"
+              << "  format ostringstream=" << ossMs << "ms  fixed=" << fixedFmtMs << "ms\n"
+              << "  drift after " << fills << " fills: double="
+              << std::setprecision(17) << (dBal - FixedPoint::toDouble(expected, 8))
+              << "  fixed=" << FixedPoint::toString(iBal - expected, 8)
+              << "\n";
+    (void)totalLen;
+    return 0;
+}
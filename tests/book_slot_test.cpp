@@ -0,0 +1,60 @@
+#include "core/orderbook.hpp"
+#include <iostream>
+#include <thread>
+#include <future>
+#include <chrono>
+
+// BookSlot: a duplicate / older update id must leave the slot readable and writable
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { std::cerr << "FAIL " << __LINE__ << ": " #cond "\n"; failures++; } \
+} while (0)
+
+static OrderBookLevel level(int64_t pxRaw, int64_t qtyRaw) {
+    OrderBookLevel l;
+    l.priceRaw = pxRaw;
+    l.qtyRaw   = qtyRaw;
+    l.price    = FixedPoint::toDouble(pxRaw, 2);
+    l.quantity = FixedPoint::toDouble(qtyRaw, 3);
+    return l;
+}
+
+int main() {
+    static BookSlot slot;
+    OrderBookLevel bid = level(10000, 1000), ask = level(10100, 2000);
+
+    CHECK(slot.write(&bid, 1, &ask, 1, 2, 3, 1, 1));
+    uint64_t v = slot.version();
+    CHECK(!slot.write(&bid, 1, &ask, 1, 2, 3, 2, 1));   // duplicate
+    CHECK(slot.version() == v);
+    CHECK(slot.updatedNs() == 1);
+
+    // the read must not spin on a slot left "writer inside"
+    auto top = std::async(std::launch::async, [](){
+        double b = 0.0, a = 0.0;
+        bool ok = slot.top(b, a);
+        return ok && b == 100.0 && a == 101.0;
+    });
+    CHECK(top.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    if (top.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        std::cerr << "FAIL: top() hangs after a duplicate write\n";
+        std::_Exit(1);
+    }
+    CHECK(top.get());
+
+    OrderBookLevel newer = level(10050, 500);
+    CHECK(slot.write(&newer, 1, &ask, 1, 2, 3, 4, 2));   // newer id still gets the lock
+    CHECK(slot.updateId() == 2);
+
+    OrderBookData out;
+    uint64_t s = slot.beginRead();
+    slot.copyTo(out);
+    CHECK(slot.validate(s));
+    CHECK(out.bids.size() == 1 && out.bids[0].priceRaw == 10050);
+
+    if (failures) return 1;
+    std::cout << "book_slot_test ok\n";
+    return 0;
+}
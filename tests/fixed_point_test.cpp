@@ -0,0 +1,36 @@
+#include "core/fixed_point.hpp"
+#include <iostream>
+#include <cstring>
+
+// FixedPoint::parse: exact in range, saturates (no signed overflow) past it
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { std::cerr << "FAIL " << __LINE__ << ": " #cond "\n"; failures++; } \
+} while (0)
+
+static bool parse(const char* s, int decimals, int64_t& out) {
+    return FixedPoint::parse(s, std::strlen(s), decimals, out);
+}
+
+int main() {
+    int64_t v = 0;
+    CHECK(parse("12345.678", 2, v) && v == 1234567);
+    CHECK(parse("-0.00000001", 8, v) && v == -1);
+    CHECK(parse("92141578.00000000", 8, v) && v == 9214157800000000LL);
+    CHECK(parse("92233720368.54775807", 8, v) && v == INT64_MAX);   // exactly fits
+    CHECK(!parse("1.2x", 8, v));
+    CHECK(!parse(".", 8, v));
+
+    // exchangeInfo "no limit" values past int64 at 8 decimals
+    CHECK(parse("92233720368.54775808", 8, v) && v == INT64_MAX);
+    CHECK(parse("900000000000.00000000", 8, v) && v == INT64_MAX);
+    CHECK(parse("99999999999999999999999", 0, v) && v == INT64_MAX);
+    CHECK(parse("-900000000000", 8, v) && v == -INT64_MAX);
+    CHECK(FixedPoint::parse(std::string("1000000000000.0"), 8) == INT64_MAX);
+
+    if (failures) return 1;
+    std::cout << "fixed_point_test ok\n";
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "engine/inventory_rebalancer.hpp"
+#include <iostream>
+#include <cmath>
+
+// InventoryRebalancer: intermediate assets go back to their pre-trade levels,
+// each correction settled on the next leg, the start asset absorbs the rest
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { std::cerr << "FAIL " << __LINE__ << ": " #cond "\n"; failures++; } \
+} while (0)
+
+static const double FEE = 0.001;
+
+static LegPlan leg(const char* sym, const char* base, const char* quote, bool isSell, double px) {
+    LegPlan p;
+    p.symbol     = sym;
+    p.baseAsset  = base;
+    p.quoteAsset = quote;
+    p.isSell     = isSell;
+    p.bestPx     = px;
+    return p;
+}
+
+// 0.0001 step, 0.001 min qty
+static bool check(const LegPlan&, double& qty) {
+    qty = std::floor(qty * 10000.0 + 1e-9) / 10000.0;
+    return qty >= 0.001;
+}
+
+static bool near(double a, double b) { return std::fabs(a - b) < 1e-9; }
+
+int main() {
+    // USDT -> BTC -> ETH -> USDT
+    std::vector<LegPlan> route = {
+        leg("BTCUSDT", "BTC", "USDT", false, 50000.0),
+        leg("ETHBTC",  "ETH", "BTC",  false, 0.05),
+        leg("ETHUSDT", "ETH", "USDT", true,  2500.0),
+    };
+    std::vector<RebalanceOrder> out;
+
+    // BTC surplus => spent forward on ETHBTC, the ETH that buys sold on ETHUSDT
+    InventoryRebalancer::plan(route, {{"BTC", 0.001}, {"USDT", 1.5}}, FEE, check, out);
+    CHECK(out.size() == 2);
+    if (out.size() == 2) {
+        CHECK(out[0].leg == 1 && out[0].symbol == "ETHBTC" && !out[0].isSell);
+        CHECK(near(out[0].qtyBase, 0.0199));
+        CHECK(out[1].leg == 2 && out[1].symbol == "ETHUSDT" && out[1].isSell);
+        CHECK(near(out[1].qtyBase, 0.0199));
+        double btcLeft = 0.001 - out[0].qtyBase * 0.05 * (1.0 + FEE);
+        CHECK(btcLeft >= 0.0 && btcLeft < 0.0001 * 0.05 * (1.0 + FEE));
+    }
+
+    // BTC shortfall => bought back with ETH, the ETH bought back with USDT
+    InventoryRebalancer::plan(route, {{"BTC", -0.001}}, FEE, check, out);
+    CHECK(out.size() == 2);
+    if (out.size() == 2) {
+        CHECK(out[0].leg == 1 && out[0].isSell);
+        CHECK(near(out[0].qtyBase, 0.02));
+        CHECK(out[1].leg == 2 && !out[1].isSell);
+        CHECK(near(out[1].qtyBase, 0.02));
+    }
+
+    // ETH drift on its own => one order on the last leg
+    InventoryRebalancer::plan(route, {{"ETH", -0.05}}, FEE, check, out);
+    CHECK(out.size() == 1);
+    if (out.size() == 1) {
+        CHECK(out[0].leg == 2 && !out[0].isSell && near(out[0].qtyBase, 0.05));
+    }
+
+    // below the filters / no drift / start asset only => nothing to place
+    InventoryRebalancer::plan(route, {{"ETH", 0.0005}}, FEE, check, out);
+    CHECK(out.empty());
+    InventoryRebalancer::plan(route, {{"USDT", 3.0}}, FEE, check, out);
+    CHECK(out.empty());
+    InventoryRebalancer::plan(route, {}, FEE, check, out);
+    CHECK(out.empty());
+
+    if (failures) return 1;
+    std::cout << "inventory_rebalancer_test ok\n";
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "core/timer_wheel.hpp"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+// TimerWheel: deadlines across level boundaries fire in order and never
+// early; ids die with the timer (fire, cancel, clear)
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { std::cerr << "FAIL " << __LINE__ << ": " #cond "\n"; failures++; } \
+} while (0)
+
+// 1ns ticks from 0: deadline == tick
+static std::vector<int64_t> fired;
+
+static TimerWheel::TimerId at(TimerWheel& w, int64_t tick) {
+    return w.schedule(tick, [tick](){ fired.push_back(tick); });
+}
+
+static void runDue(TimerWheel& w, int64_t now) {
+    std::vector<TimerWheel::Callback> due;
+    w.advance(now, due);
+    for (auto& cb : due) cb();
+}
+
+int main() {
+    {
+        TimerWheel w(1, 0);
+        // level 0/1/2/3 edges, scheduled out of order
+        std::vector<int64_t> ticks = { 65536, 1, 256, 16777216, 255, 65535, 257,
+                                       16777215, 511, 65537, 512, 16777217, 513, 70000 };
+        for (int64_t t : ticks) at(w, t);
+        CHECK(w.size() == ticks.size());
+
+        std::sort(ticks.begin(), ticks.end());
+        std::vector<int64_t> expect;
+        for (int64_t t : ticks) {
+            runDue(w, t - 1);
+            CHECK(fired == expect);          // nothing early
+            expect.push_back(t);
+            runDue(w, t);
+            CHECK(fired == expect);          // due exactly at its tick
+        }
+        CHECK(w.size() == 0);
+
+        // scheduled mid-wheel: the digits above no longer line up with 0
+        fired.clear();
+        int64_t now = 16777217 + 300;
+        runDue(w, now);
+        at(w, now + 65536);
+        at(w, now + 1);
+        at(w, now + 256 - 45);
+        runDue(w, now + 65535);
+        CHECK((fired == std::vector<int64_t>{ now + 1, now + 211 }));
+        runDue(w, now + 65536);
+        CHECK(fired.size() == 3 && fired.back() == now + 65536);
+
+        // a deadline already past fires on the next advance
+        fired.clear();
+        at(w, 5);
+        runDue(w, now + 65537);
+        CHECK(fired.size() == 1);
+    }
+
+    {
+        TimerWheel w(1, 0);
+        fired.clear();
+        TimerWheel::TimerId a = at(w, 10);
+        TimerWheel::TimerId b = at(w, 300);
+        TimerWheel::TimerId c = at(w, 70000);
+        runDue(w, 10);
+        CHECK(!w.cancel(a));                 // already fired
+        CHECK(w.cancel(c));                  // pending on level 2
+        CHECK(!w.cancel(c));                 // already cancelled
+        at(w, 20);                           // reuses c's node...
+        CHECK(!w.cancel(c));                 // ...but not c's id
+        CHECK(!w.cancel(a));
+        runDue(w, 100000);
+        CHECK((fired == std::vector<int64_t>{ 10, 20, 300 }));
+        CHECK(!w.cancel(b));
+        CHECK(w.size() == 0);
+    }
+
+    {
+        TimerWheel w(1, 0);
+        fired.clear();
+        TimerWheel::TimerId a = at(w, 5);
+        TimerWheel::TimerId b = at(w, 1000);
+        w.clear();
+        CHECK(w.size() == 0);
+        CHECK(!w.cancel(a));
+        CHECK(!w.cancel(b));
+        TimerWheel::TimerId d = at(w, 7);    // lands on a cleared node
+        CHECK(!w.cancel(a) && !w.cancel(b));
+        runDue(w, 2000);
+        CHECK((fired == std::vector<int64_t>{ 7 }));
+        CHECK(!w.cancel(d));
+    }
+
+    {
+        // ticks coarser than ns: deadlines round up, never fire early
+        TimerWheel w(1000000, 0);
+        fired.clear();
+        w.schedule(1500000, [](){ fired.push_back(2); });
+        runDue(w, 1999999);
+        CHECK(fired.empty());
+        runDue(w, 2000000);
+        CHECK(fired.size() == 1);
+    }
+
+    if (failures) return 1;
+    std::cout << "timer_wheel_test ok\n";
+    return 0;
+}
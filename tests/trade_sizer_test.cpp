@@ -0,0 +1,117 @@
+#include "engine/trade_sizer.hpp"
+#include <iostream>
+#include <cmath>
+
+// TradeSizer::optimize on hand-computed 3-leg ladders
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { std::cerr << "FAIL " << __LINE__ << ": " #cond "\n"; failures++; } \
+} while (0)
+
+static bool near(double a, double b) { return std::fabs(a - b) < 1e-9 * std::max(1.0, std::fabs(b)); }
+
+static OrderBookData book(std::vector<std::pair<double,double>> bids,
+                          std::vector<std::pair<double,double>> asks = {}) {
+    OrderBookData ob;
+    for (auto& l : bids) ob.bids.push_back({ l.first, l.second });
+    for (auto& l : asks) ob.asks.push_back({ l.first, l.second });
+    return ob;
+}
+
+static SizerLeg sell(const OrderBookData& ob, double fee = 0.0, double maxSlip = 1.0) {
+    SizerLeg l; l.book = &ob; l.isSell = true; l.fee = fee; l.maxSlip = maxSlip;
+    return l;
+}
+
+static SizerLeg buy(const OrderBookData& ob, double fee = 0.0) {
+    SizerLeg l; l.book = &ob; l.isSell = false; l.fee = fee;
+    return l;
+}
+
+int main() {
+    SizedRoute r;
+
+    {
+        // leg 1's first level pays 2*1*0.6 = 1.2, its second 1*1*0.6 = 0.6:
+        // the optimum is exactly leg 1's level boundary
+        OrderBookData a = book({{2.0, 10.0}, {1.0, 100.0}});
+        OrderBookData b = book({{1.0, 1000.0}});
+        OrderBookData c = book({{0.6, 1000.0}});
+        SizerLeg legs[] = { sell(a), sell(b), sell(c) };
+        CHECK(TradeSizer::optimize(legs, 3, 0.0, r));
+        CHECK(r.ok && r.legs == 3);
+        CHECK(near(r.input, 10.0) && near(r.output, 12.0) && near(r.profit, 2.0));
+        CHECK(near(r.legQtyBase[0], 10.0) && near(r.legQtyBase[1], 20.0) && near(r.legQtyBase[2], 20.0));
+        CHECK(near(TradeSizer::walk(legs, 3, 10.0), 12.0));
+
+        // maxInput below the boundary caps leg 1
+        CHECK(TradeSizer::optimize(legs, 3, 6.0, r));
+        CHECK(near(r.input, 6.0) && near(r.output, 7.2));
+        CHECK(near(r.legInput[0], 6.0) && near(r.legOutput[0], 12.0));
+    }
+
+    {
+        // the boundary sits in leg 2: its first level takes 8 units = 4 route
+        // units at 2*1*0.6, the rest pays 2*0.5*0.6 = 0.6
+        OrderBookData a = book({{2.0, 100.0}});
+        OrderBookData b = book({{1.0, 8.0}, {0.5, 1000.0}});
+        OrderBookData c = book({{0.6, 1000.0}});
+        SizerLeg legs[] = { sell(a), sell(b), sell(c) };
+        CHECK(TradeSizer::optimize(legs, 3, 0.0, r));
+        CHECK(near(r.input, 4.0) && near(r.output, 4.8));
+        CHECK(near(r.legQtyBase[0], 4.0) && near(r.legQtyBase[1], 8.0) && near(r.legQtyBase[2], 8.0));
+    }
+
+    {
+        // leg 1's second level still pays (1.9*0.6 = 1.14) unless it's past maxSlip
+        OrderBookData a = book({{2.0, 10.0}, {1.9, 10.0}});
+        OrderBookData b = book({{1.0, 1000.0}});
+        OrderBookData c = book({{0.6, 1000.0}});
+        SizerLeg wide[] = { sell(a), sell(b), sell(c) };
+        CHECK(TradeSizer::optimize(wide, 3, 0.0, r));
+        CHECK(near(r.input, 20.0) && near(r.output, 23.4));
+
+        SizerLeg tight[] = { sell(a, 0.0, 0.01), sell(b), sell(c) };   // 5% away > 1%
+        CHECK(TradeSizer::optimize(tight, 3, 0.0, r));
+        CHECK(near(r.input, 10.0) && near(r.output, 12.0));
+    }
+
+    {
+        // USDT -buy-> BTC -buy-> ETH -sell-> USDT with fees:
+        // (1/(100*1.001)) * (1/(0.05*1.001)) * 6*0.999 per USDT, 1 BTC of depth on leg 1
+        const double fee = 0.001;
+        OrderBookData btc = book({}, {{100.0, 1.0}});
+        OrderBookData eth = book({}, {{0.05, 100.0}});
+        OrderBookData usd = book({{6.0, 100.0}});
+        SizerLeg legs[] = { buy(btc, fee), buy(eth, fee), sell(usd, fee) };
+        CHECK(TradeSizer::optimize(legs, 3, 0.0, r));
+        double input = 100.0 * (1.0 + fee);
+        double ethQty = 1.0 / (0.05 * (1.0 + fee));
+        CHECK(near(r.input, input));
+        CHECK(near(r.legQtyBase[0], 1.0));
+        CHECK(near(r.legQtyBase[1], ethQty));
+        CHECK(near(r.legQtyBase[2], ethQty));
+        CHECK(near(r.output, ethQty * 6.0 * (1.0 - fee)));
+    }
+
+    {
+        // top of book only breaks even (2*1*0.5 = 1) => nothing to trade
+        OrderBookData a = book({{2.0, 10.0}});
+        OrderBookData b = book({{1.0, 1000.0}});
+        OrderBookData c = book({{0.5, 1000.0}});
+        SizerLeg legs[] = { sell(a), sell(b), sell(c) };
+        CHECK(!TradeSizer::optimize(legs, 3, 0.0, r));
+        CHECK(!r.ok && r.input == 0.0);
+
+        // ... and a leg without a book side never sizes
+        OrderBookData empty;
+        SizerLeg missing[] = { sell(a), sell(empty), sell(c) };
+        CHECK(!TradeSizer::optimize(missing, 3, 0.0, r));
+    }
+
+    if (failures) return 1;
+    std::cout << "trade_sizer_test ok\n";
+    return 0;
+}
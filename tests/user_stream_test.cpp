@@ -0,0 +1,91 @@
+#include "exchange/binance_user_stream.hpp"
+#include <iostream>
+#include <cmath>
+
+// BinanceUserStream::applyEvent: recorded user-data payloads against a
+// wallet, no socket (the stream is never started)
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { std::cerr << "FAIL " << __LINE__ << ": " #cond "\n"; failures++; } \
+} while (0)
+
+static bool near(double a, double b) { return std::fabs(a - b) < 1e-9; }
+
+int main() {
+    Wallet wallet;
+    wallet.setBalance("USDT", 100.0);
+    BinanceUserStream stream(&wallet, "test-key", "http://127.0.0.1:9", "ws://127.0.0.1:9");
+
+    // outboundAccountPosition => absolute positions, only the assets listed
+    CHECK(stream.applyEvent(R"({"e":"outboundAccountPosition","E":1,"u":1,
+        "B":[{"a":"BTC","f":"0.50000000","l":"0.10000000"},
+             {"a":"ETH","f":"2.00000000","l":"0.00000000"}]})"));
+    CHECK(near(wallet.getTotalBalance("BTC"), 0.6));
+    CHECK(near(wallet.getFreeBalance("BTC"), 0.5));
+    CHECK(near(wallet.getTotalBalance("ETH"), 2.0));
+    CHECK(near(wallet.getTotalBalance("USDT"), 100.0));
+
+    // balanceUpdate => delta on total
+    CHECK(stream.applyEvent(R"({"e":"balanceUpdate","E":2,"a":"USDT","d":"25.50000000","T":2})"));
+    CHECK(near(wallet.getTotalBalance("USDT"), 125.5));
+    CHECK(stream.applyEvent(R"({"e":"balanceUpdate","E":3,"a":"USDT","d":"-5.5","T":3})"));
+    CHECK(near(wallet.getTotalBalance("USDT"), 120.0));
+
+    // executionReport => counted only, balances come with the position push
+    CHECK(stream.applyEvent(R"({"e":"executionReport","E":4,"s":"BTCUSDT","S":"BUY",
+        "x":"TRADE","X":"FILLED","l":"0.001","L":"30000.0","i":42})"));
+    CHECK(stream.applyEvent(R"({"e":"executionReport","E":5,"s":"BTCUSDT","S":"BUY",
+        "x":"NEW","X":"NEW","l":"0","L":"0","i":43})"));
+    CHECK(stream.fillsSeen() == 1);
+    CHECK(near(wallet.getTotalBalance("BTC"), 0.6));
+    CHECK(near(wallet.getTotalBalance("USDT"), 120.0));
+
+    // listenKeyExpired => recognised (drops the key; nothing connected here)
+    CHECK(stream.applyEvent(R"({"e":"listenKeyExpired","E":6})"));
+    CHECK(stream.eventsApplied() == 6);
+
+    // malformed / unknown => rejected, wallet untouched
+    CHECK(!stream.applyEvent("not json"));
+    CHECK(!stream.applyEvent(R"({"e":"outboundAccountPosition","E":7})"));
+    CHECK(!stream.applyEvent(R"({"e":"outboundAccountPosition","B":{"a":"BTC"}})"));
+    CHECK(!stream.applyEvent(R"({"e":"outboundAccountPosition",
+        "B":[{"a":"BTC","f":"9.0","l":"0.0"},{"a":"ETH","f":"abc","l":"0.0"}]})"));
+    CHECK(!stream.applyEvent(R"({"e":"outboundAccountPosition","B":[{"a":"BTC","f":1.0,"l":"0"}]})"));
+    CHECK(!stream.applyEvent(R"({"e":"balanceUpdate","a":"USDT"})"));
+    CHECK(!stream.applyEvent(R"({"e":"balanceUpdate","a":"USDT","d":"x"})"));
+    CHECK(!stream.applyEvent(R"({"e":"somethingElse"})"));
+    CHECK(!stream.applyEvent(R"([1,2,3])"));
+    CHECK(!stream.applyEvent(R"({"e":5,"a":"USDT","d":"1"})"));
+    CHECK(near(wallet.getTotalBalance("BTC"), 0.6));
+    CHECK(near(wallet.getTotalBalance("ETH"), 2.0));
+    CHECK(near(wallet.getTotalBalance("USDT"), 120.0));
+    CHECK(stream.eventsApplied() == 6);
+
+    // a push for an asset an open trade holds waits for the trade to end:
+    // the fill is booked once (by the trade), then the exchange's position wins
+    AssetId ids[] = { AssetRegistry::instance().find("BTC"), AssetRegistry::instance().find("USDT") };
+    WalletTransaction tx = wallet.beginTransaction(ids, 2);
+    CHECK(stream.applyEvent(R"({"e":"outboundAccountPosition",
+        "B":[{"a":"BTC","f":"0.51","l":"0.1"},{"a":"USDT","f":"109.9","l":"0"}]})"));
+    CHECK(near(wallet.getTotalBalance("BTC"), 0.6));
+    CHECK(wallet.applyChange(tx, "USDT", -10.0, 0.0));
+    CHECK(wallet.applyChange(tx, "BTC", 0.01, 0.0));
+    CHECK(near(wallet.getTotalBalance("BTC"), 0.61));
+    CHECK(wallet.commitTransaction(tx));
+    CHECK(near(wallet.getTotalBalance("BTC"), 0.61));
+    CHECK(near(wallet.getTotalBalance("USDT"), 109.9));
+
+    // ... and after a rollback
+    tx = wallet.beginTransaction(ids, 2);
+    CHECK(wallet.applyChange(tx, "USDT", -50.0, 0.0));
+    CHECK(stream.applyEvent(R"({"e":"balanceUpdate","a":"USDT","d":"1.1"})"));
+    CHECK(near(wallet.getTotalBalance("USDT"), 59.9));
+    wallet.rollbackTransaction(tx);
+    CHECK(near(wallet.getTotalBalance("USDT"), 111.0));
+
+    if (failures) return 1;
+    std::cout << "user_stream_test ok\n";
+    return 0;
+}